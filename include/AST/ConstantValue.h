@@ -0,0 +1,65 @@
+#ifndef AST_CONSTANT_VALUE_H
+#define AST_CONSTANT_VALUE_H
+
+#include <cstdint>
+#include <vector>
+
+class Type;
+
+/// A value computed at compile time. Integers, characters and booleans are
+/// stored as the bits of their value, extended to 64 bits according to the
+/// signedness of their type. Floating point numbers are stored as doubles, and
+/// arrays, tuples, structs and vectors as the list of their elements.
+class ConstantValue {
+private:
+  Type* type_ = nullptr;
+  uint64_t bits_ = 0;
+  double real_ = 0;
+  std::vector<ConstantValue> elements_;
+
+public:
+  ConstantValue() = default;
+
+  /// Return an integer, character or boolean value with the given bits, which
+  /// must already be extended to 64 bits
+  static ConstantValue getScalar(Type* type, uint64_t bits) {
+    ConstantValue value;
+    value.type_ = type;
+    value.bits_ = bits;
+    return value;
+  }
+
+  /// Return a floating point value
+  static ConstantValue getReal(Type* type, double real) {
+    ConstantValue value;
+    value.type_ = type;
+    value.real_ = real;
+    return value;
+  }
+
+  /// Return an array, tuple, struct or vector value with the given elements
+  static ConstantValue getAggregate(Type* type, std::vector<ConstantValue> elements) {
+    ConstantValue value;
+    value.type_ = type;
+    value.elements_ = std::move(elements);
+    return value;
+  }
+
+  /// Return the canonical type of the value
+  Type* getType() const { return type_; }
+
+  /// Return the bits of an integer, character or boolean value
+  uint64_t getBits() const { return bits_; }
+
+  /// Return the value of a signed integer
+  int64_t getInt() const { return static_cast<int64_t>(bits_); }
+
+  bool getBool() const { return bits_ != 0; }
+
+  double getReal() const { return real_; }
+
+  const std::vector<ConstantValue>& elements() const { return elements_; }
+  std::vector<ConstantValue>& elements() { return elements_; }
+};
+
+#endif
@@ -3,11 +3,13 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include "Basic/SourceCode.h"
 #include "Basic/Token.h"
 
 #include "AST/TreeElement.h"
+#include "AST/ConstantValue.h"
 #include "AST/DeclContext.h"
 #include "AST/Expr.h"
 #include "AST/Type.h"
@@ -223,6 +225,7 @@ private:
   Token fName;
   Type *fType;
   std::unique_ptr<Expr> fExpr;
+  bool referenced_ = false;
 public:
 
   std::vector<TreeElement*> getChildren() const override {
@@ -263,21 +266,180 @@ public:
     fParentContext = parent;
   }
 
+  /// Marks the binding as having its location taken with `&`, either of the
+  /// whole binding or of one of its members or elements.
+  void setReferenced(bool referenced) {
+    referenced_ = referenced;
+  }
+
+  /// Return true if a reference to the storage of the binding may exist, so
+  /// that the binding needs storage of its own
+  bool isReferenced() const {
+    return referenced_;
+  }
+
   LetDecl(Token n, Type* t, std::unique_ptr<Expr> e)
   : fName{n}, fType{t}, fExpr{std::move(e)} {}
 };
 
+/// Represents a constant, whose value is computed at compile time by evaluating
+/// its initializer during semantic analysis. The initializer may call
+/// functions declared before the constant, e.g.
+///
+///   const crc_table: [u32, 256] = make_crc_table()
+///
+/// Integer constants may be used as the size of array types.
+class ConstDecl : public Decl {
+private:
+  DeclContext* fParentContext;
+  Token fName;
+  Type *fType;
+  std::unique_ptr<Expr> fExpr;
+  std::unique_ptr<ConstantValue> fValue;
+public:
+
+  std::vector<TreeElement*> getChildren() const override {
+    return {fExpr.get()};
+  }
+
+  const char* location() const override {
+      return fName.location();
+  }
+
+  Decl::Kind getKind() const override {
+    return Decl::Kind::ConstDecl;
+  }
+
+  StringRef getName() const override {
+    return fName.lexeme();
+  }
+  Type* getType() const override {
+    return fType;
+  }
+
+  Expr& getExpr() const {
+    return *fExpr;
+  }
+
+  /// Return the value of the constant, or nullptr if it is not evaluated yet
+  const ConstantValue* getValue() const {
+    return fValue.get();
+  }
+
+  void setValue(ConstantValue value) {
+    fValue = std::make_unique<ConstantValue>(std::move(value));
+  }
+
+  virtual const DeclContext* getDeclContext() const override {
+    return fParentContext;
+  }
+
+  std::string name() const override {
+    return "const-declaration";
+  };
+
+  virtual DeclContext* getDeclContext() override {
+    return fParentContext;
+  }
+
+  virtual void setParentContext(DeclContext *parent) override {
+    fParentContext = parent;
+  }
+
+  ConstDecl(Token n, Type* t, std::unique_ptr<Expr> e)
+  : fName{n}, fType{t}, fExpr{std::move(e)} {}
+};
+
+/// Represents the variable of a ForLoop, which is bound to each value of the
+/// iterated range or sequence in turn. The variable is immutable, and its type
+/// is inferred from the loop during semantic analysis.
+class LoopVarDecl : public Decl {
+private:
+  DeclContext* fParentContext;
+  Token fName;
+  Type* fType = nullptr;
+public:
+
+  LoopVarDecl(Token n) : fName{n} {}
+
+  Decl::Kind getKind() const override {
+    return Decl::Kind::LoopVarDecl;
+  }
+
+  StringRef getName() const override {
+    return fName.lexeme();
+  }
+
+  const char* location() const override {
+      return fName.location();
+  }
+
+  Type* getType() const override {
+    return fType;
+  }
+
+  /// Sets the type inferred from the iterated range or sequence
+  void setType(Type* type) {
+    fType = type;
+  }
+
+  std::vector<std::pair<std::string, std::string>> getAttributes() const override {
+    if (fType) return Decl::getAttributes();
+    else return {{"name", getName().str()}};
+  }
+
+  std::string name() const override {
+    return "loop-variable-declaration";
+  };
+
+  virtual const DeclContext* getDeclContext() const override {
+    return fParentContext;
+  }
+
+  virtual DeclContext* getDeclContext() override {
+    return fParentContext;
+  }
+
+  virtual void setParentContext(DeclContext *parent) override {
+    fParentContext = parent;
+  }
+};
+
 
 class ParamDecl : public Decl {
 private:
   DeclContext* fParentContext;
   Token fName;
   Type* fType;
+  bool read_only_ = false;
+  bool no_alias_ = false;
 public:
 
   ParamDecl(Token n, Type *t)
   : fName{n}, fType{t} {}
 
+  /// Marks a reference or slice parameter as never written through and never
+  /// escaping the function.
+  void setReadOnly(bool read_only) {
+    read_only_ = read_only;
+  }
+
+  /// Return true if the referenced memory is only read by the function
+  bool isReadOnly() const {
+    return read_only_;
+  }
+
+  /// Marks a reference or slice parameter as the only way the function
+  /// accesses the referenced memory.
+  void setNoAlias(bool no_alias) {
+    no_alias_ = no_alias;
+  }
+
+  /// Return true if no other pointer is used to access the referenced memory
+  bool isNoAlias() const {
+    return no_alias_;
+  }
+
   Decl::Kind getKind() const override {
     return Decl::Kind::ParamDecl;
   }
@@ -312,7 +474,95 @@ public:
 };
 
 
-class StructDecl : public Decl {
+/// The type parameters and instances of a generic declaration D, which is a
+/// function or a struct. A generic declaration is not checked or compiled
+/// itself. Instead, its source is parsed again for each list of type arguments
+/// it is used with, with the parameters replaced by the arguments, and the
+/// resulting instance is checked and compiled like any other declaration.
+template <typename D>
+class GenericDecl {
+private:
+  std::vector<Token> type_params_;
+  std::shared_ptr<SourceFile> source_;
+  const char* start_ = nullptr;
+
+  /// The canonical type arguments of an instance
+  std::vector<Type*> type_args_;
+
+  /// The instances of a generic declaration in the order they were created
+  std::vector<std::unique_ptr<D>> instances_;
+
+public:
+  /// Marks the declaration as generic. Its instances are parsed from the
+  /// given location in the source, which is the start of the declaration.
+  void setTypeParams(std::vector<Token> params, std::shared_ptr<SourceFile> source, const char* start) {
+    type_params_ = std::move(params);
+    source_ = std::move(source);
+    start_ = start;
+  }
+
+  bool isGeneric() const {
+    return !type_params_.empty();
+  }
+
+  const std::vector<Token>& getTypeParams() const {
+    return type_params_;
+  }
+
+  const std::shared_ptr<SourceFile>& getSource() const {
+    return source_;
+  }
+
+  const char* getStart() const {
+    return start_;
+  }
+
+  void setTypeArgs(std::vector<Type*> args) {
+    type_args_ = std::move(args);
+  }
+
+  /// Return the type arguments of an instance, which are empty for any other
+  /// declaration
+  const std::vector<Type*>& getTypeArgs() const {
+    return type_args_;
+  }
+
+  bool isInstance() const {
+    return !type_args_.empty();
+  }
+
+  /// Return the instance for the given canonical type arguments, or nullptr
+  /// if it has not been created yet
+  D* getInstance(const std::vector<Type*>& args) const {
+    for (auto &instance: instances_) {
+      if (instance->getTypeArgs() == args) return instance.get();
+    }
+    return nullptr;
+  }
+
+  D* addInstance(std::unique_ptr<D> instance) {
+    instances_.push_back(std::move(instance));
+    return instances_.back().get();
+  }
+
+  const std::vector<std::unique_ptr<D>>& getInstances() const {
+    return instances_;
+  }
+
+  /// Return the type arguments of an instance as in "[i64, f64]", or an empty
+  /// string for any other declaration
+  std::string typeArgsString() const {
+    if (type_args_.empty()) return "";
+    std::string str = "[";
+    for (auto it = type_args_.begin(); it != type_args_.end(); ++it) {
+      if (it != type_args_.begin()) str += ", ";
+      str += (*it)->toString();
+    }
+    return str + "]";
+  }
+};
+
+class StructDecl : public Decl, public GenericDecl<StructDecl> {
 private:
   DeclContext* parent_context_;
   Token name_;
@@ -356,8 +606,25 @@ public:
 };
 
 
+/// The optimization hints of a function, which are written before `func`
+struct FuncAttributes {
+  /// `inline`: every call is inlined, and the function is not exported
+  bool is_inline = false;
+  /// `@noinline`: calls are never inlined
+  bool is_noinline = false;
+  /// `@hot`: the function runs often, so it is optimized for speed and placed
+  /// next to other hot functions
+  bool is_hot = false;
+  /// `@cold`: the function rarely runs, so it is optimized for size and calls
+  /// to it are treated as unlikely
+  bool is_cold = false;
+  /// `@tailcall`: recursive calls must be guaranteed tail calls, so that the
+  /// function runs in constant stack space
+  bool is_tailcall = false;
+};
+
 /// A named, explicitly typed function
-class FuncDecl : public Decl {
+class FuncDecl : public Decl, public GenericDecl<FuncDecl> {
 private:
   DeclContext fContext;
   FunctionType* fType;
@@ -365,6 +632,13 @@ private:
   std::vector<std::unique_ptr<ParamDecl>> fParams;
   Type *fReturnType;
   std::unique_ptr<CompoundStmt> fStmt;
+  FuncAttributes fAttributes;
+
+  // conservative until the function has been analyzed
+  bool reads_memory_ = true;
+  bool writes_memory_ = true;
+  bool arg_memory_only_ = false;
+  bool will_return_ = false;
 public:
 
   FuncDecl(Token n, std::vector<std::unique_ptr<ParamDecl>> p, Type *t, std::unique_ptr<CompoundStmt> s)
@@ -400,6 +674,12 @@ public:
     return fName.lexeme();
   }
 
+  /// Return the name of the function in the object file. An instance of a
+  /// generic function is named after its type arguments, e.g. "max[i64]".
+  std::string getSymbolName() const {
+    return getName().str() + typeArgsString();
+  }
+
   Type* getType() const override {
     return fType;
   }
@@ -428,6 +708,50 @@ public:
   const std::vector<std::unique_ptr<ParamDecl>>& getParams() const {
     return fParams;
   };
+
+  void setFuncAttributes(FuncAttributes attributes) {
+    fAttributes = attributes;
+  }
+
+  const FuncAttributes& getFuncAttributes() const {
+    return fAttributes;
+  }
+
+  /// Sets the memory effects of the function visible to its callers. Local
+  /// variables do not count as memory, since they are not visible outside of
+  /// the function.
+  void setMemoryEffects(bool reads, bool writes, bool arg_memory_only) {
+    reads_memory_ = reads;
+    writes_memory_ = writes;
+    arg_memory_only_ = arg_memory_only;
+  }
+
+  /// Return true if the function may read memory visible to its callers
+  bool readsMemory() const {
+    return reads_memory_;
+  }
+
+  /// Return true if the function may write memory visible to its callers
+  bool writesMemory() const {
+    return writes_memory_;
+  }
+
+  /// Return true if the function only accesses memory through its reference
+  /// and slice parameters.
+  bool accessesArgMemoryOnly() const {
+    return arg_memory_only_;
+  }
+
+  /// Marks the function as always returning, i.e. it has no loops, no calls
+  /// which might not return, and no runtime checks which might trap.
+  void setWillReturn(bool will_return) {
+    will_return_ = will_return;
+  }
+
+  /// Return true if every call to the function is known to return
+  bool willReturn() const {
+    return will_return_;
+  }
 };
 
 class BasicDecl : public Decl {
@@ -1,6 +1,7 @@
 #ifndef AST_EXPR_H
 #define AST_EXPR_H
 
+#include <cstdint>
 #include <memory>
 
 #include "Basic/Token.h"
@@ -135,6 +136,7 @@ public:
 class IntegerExpr: public Expr  {
 private:
   Token token_;
+  int64_t value_;
 
 public:
 
@@ -142,6 +144,7 @@ public:
     if (t.isNot(Token::integer_literal)) {
       throw std::domain_error("IntegerExpr requires a token of type integer_literal");
     }
+    value_ = std::stoll(token_.lexeme().str());
   }
 
   StringRef lexeme() const {
@@ -158,8 +161,10 @@ public:
 
   Expr::Kind getKind() const override { return Kind::IntegerExpr; }
 
-  int getInt() const {
-    return std::stoi(token_.lexeme().str());
+  /// Return the value of the literal. Literals are parsed as 64 bit values, so
+  /// that they may initialize integers of any width.
+  int64_t getInt() const {
+    return value_;
   }
 
   bool isLeftValue() const override {
@@ -442,12 +447,35 @@ public:
     return op_.lexeme();
   }
 
+  /// Return true if the expression assigns to its left operand, either with
+  /// '=' or with a compound assignment
+  bool isAssignment() const;
+
+  /// Return true if the expression is a compound assignment such as 'a += b',
+  /// which assigns the result of an operator applied to both operands
+  bool isCompoundAssignment() const;
+
+  /// Return the operator applied by a compound assignment, e.g. '+' for '+='
+  StringRef getCompoundOperator() const {
+    StringRef op = op_.lexeme();
+    return StringRef{op.start, op.length - 1};
+  }
+
 };
 
 class FunctionCall: public Expr {
+public:
+  /// Whether a call which is returned right away may reuse the stack frame of
+  /// the caller. A tail call is a hint to codegen, while a guaranteed tail
+  /// call is always made without a new frame, which requires the callee to
+  /// have the same type as the caller.
+  enum class TailCall { None, Tail, Guaranteed };
+
 private:
   std::unique_ptr<IdentifierExpr> name_;
   std::vector<std::unique_ptr<Expr>> arguments_;
+  const Decl* decl_ = nullptr;
+  TailCall tail_call_ = TailCall::None;
 public:
 
   FunctionCall(std::unique_ptr<IdentifierExpr> n, std::vector<std::unique_ptr<Expr>> a)
@@ -482,6 +510,26 @@ public:
     return name_->lexeme();
   }
 
+  /// Sets the declaration the call was resolved to during type checking.
+  /// Builtins such as 'len' which are checked structurally have no decl.
+  void setDecl(const Decl* decl) {
+    decl_ = decl;
+  }
+
+  /// Return the declaration the call was resolved to, or nullptr
+  const Decl* getDecl() const {
+    return decl_;
+  }
+
+  /// Marks the call as a tail call, which is set during semantic analysis
+  void setTailCall(TailCall tail_call) {
+    tail_call_ = tail_call;
+  }
+
+  TailCall getTailCall() const {
+    return tail_call_;
+  }
+
 };
 
 class ListExpr: public Expr {
@@ -558,6 +606,8 @@ private:
   std::unique_ptr<Expr> aggregate_;
   std::unique_ptr<Expr> index_;
   int member_index_;
+  bool has_member_index_ = false;
+  bool in_bounds_ = false;
 
 public:
 
@@ -575,6 +625,7 @@ public:
 
   void setMemberIndex(int i) {
     member_index_ = i;
+    has_member_index_ = true;
   }
 
   int getMemberIndex() const {
@@ -583,8 +634,23 @@ public:
     } else return member_index_;
   }
 
+  /// Return true if the index is known at compile time. This is the case for
+  /// struct properties, whose member index is set during type checking, and
+  /// for integer literal indices. An identifier used to index an array is a
+  /// runtime value.
   bool hasStaticIndex() const {
-    return index_->is<IdentifierExpr>() || index_->is<IntegerExpr>();
+    return has_member_index_ || index_->is<IntegerExpr>();
+  }
+
+  /// Marks the element access as proven to be within the bounds of the
+  /// aggregate, so that codegen may omit the runtime bounds check.
+  void setInBounds(bool in_bounds) {
+    in_bounds_ = in_bounds;
+  }
+
+  /// Return true if the access has been proven to be in bounds
+  bool isInBounds() const {
+    return in_bounds_;
   }
 
   bool isLeftValue() const override {
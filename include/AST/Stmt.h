@@ -13,7 +13,9 @@
 class Stmt;
 class Decl;
 class Expr;
+class IdentifierExpr;
 class LetDecl;
+class LoopVarDecl;
 class ReturnStmt;
 
 /// The base class for all statements in the program. A statement is a single
@@ -55,9 +57,15 @@ public:
 /// which have their own scope. Does giving a compound stmt its own scope make
 /// sense?
 class CompoundStmt : public Stmt {
+public:
+  /// The allocators which may serve the heap allocations of a block
+  enum class Allocator { Inherited, Arena, Pool };
+
 private:
   DeclContext context_;
   std::vector<std::unique_ptr<Stmt>> stmts_;
+  Allocator allocator_ = Allocator::Inherited;
+
 public:
   /// Construct a CompoundStmt with the given list of stmts.
   CompoundStmt(std::vector<std::unique_ptr<Stmt>> stmts)
@@ -87,6 +95,12 @@ public:
     return stmts_;
   };
 
+  /// Sets the allocator of a block marked `@arena` or `@pool`, which serves
+  /// all heap allocations while the block executes, including those of the
+  /// functions it calls, and releases them when the block is left.
+  void setAllocator(Allocator allocator) { allocator_ = allocator; }
+  Allocator getAllocator() const { return allocator_; }
+
   /// Return the runtime type, which is Stmt::Kind::CompoundStmt
   Stmt::Kind getKind() const override { return Kind::CompoundStmt;}
 
@@ -246,6 +260,66 @@ public:
 
 };
 
+/// An arm of a match statement, which runs its block if the scrutinee equals
+/// one of its values. The values are constant integers or characters.
+struct MatchCase {
+  std::vector<std::unique_ptr<Expr>> values;
+  std::unique_ptr<CompoundStmt> block;
+
+  /// The bits of each value, which are computed during semantic analysis
+  std::vector<uint64_t> constants;
+};
+
+/// Selects one of several blocks by the value of an integer or character,
+/// which is compared against the constant values of each case. A match runs
+/// its else block if no case matches, and must have one unless its cases
+/// cover every value of the scrutinee.
+class MatchStmt : public Stmt {
+private:
+  std::unique_ptr<Expr> scrutinee_;
+  std::vector<MatchCase> cases_;
+  std::unique_ptr<CompoundStmt> else_;
+
+public:
+  MatchStmt(
+    std::unique_ptr<Expr> scrutinee
+  , std::vector<MatchCase> cases
+  , std::unique_ptr<CompoundStmt> else_block
+  );
+
+  ~MatchStmt();
+
+  /// Return the value which is matched
+  Expr& getScrutinee() { return *scrutinee_; }
+
+  /// Return the cases in the order they were written
+  std::vector<MatchCase>& getCases() { return cases_; }
+
+  /// Return the else block... which may be nullptr
+  CompoundStmt* getElse() { return else_.get(); }
+
+  /// Return the runtime kind of the stmt.
+  Stmt::Kind getKind() const override { return Kind::MatchStmt; }
+
+  /// Return the printable name of the statement
+  std::string name() const override {
+    return "match-statement";
+  };
+
+  /// Returns true if every case returns, and the else block returns if there
+  /// is one. Semantic analysis rejects matches without an else block which do
+  /// not cover every value.
+  bool returns() const override {
+    for (auto &match_case: cases_) {
+      if (!match_case.block->returns()) return false;
+    }
+    return !else_ || else_->returns();
+  }
+
+  /// Return the child nodes for walking or serialization
+  std::vector<TreeElement*> getChildren() const override;
+};
+
 /// Represents a loop that executes as long as the condition is true, and checks
 /// the condition before each iteration. The condition can either be an
 /// expression which must evaulate to tree, or a let declaration which must be
@@ -308,6 +382,116 @@ public:
   }
 };
 
+/// Represents a counted loop. The loop either iterates over the half open
+/// range of integers 'start..end', or over the elements of an array or slice.
+/// The bounds and the sequence are evaluated once before the first iteration,
+/// and the loop variable can not be assigned, so the trip count is known when
+/// the loop is entered.
+/// A variable of a parallel loop which every thread accumulates on its own,
+/// starting from the identity of the operator. The results of the threads are
+/// combined into the variable when the loop ends.
+struct Reduction {
+  enum class Operator { Add, Multiply, Min, Max };
+
+  Operator op;
+  std::unique_ptr<IdentifierExpr> variable;
+};
+
+class ForLoop : public Stmt {
+private:
+  DeclContext context_;
+  std::unique_ptr<LoopVarDecl> decl_;
+  std::unique_ptr<Expr> start_;
+  std::unique_ptr<Expr> end_;
+  std::unique_ptr<Expr> sequence_;
+  std::unique_ptr<CompoundStmt> stmt_;
+  bool is_parallel_ = false;
+  std::vector<Reduction> reductions_;
+
+public:
+
+  /// Constructs a loop over the range 'start..end'
+  ForLoop(
+    std::unique_ptr<LoopVarDecl> decl
+  , std::unique_ptr<Expr> start
+  , std::unique_ptr<Expr> end
+  , std::unique_ptr<CompoundStmt> stmt
+  );
+
+  /// Constructs a loop over the elements of the given sequence
+  ForLoop(
+    std::unique_ptr<LoopVarDecl> decl
+  , std::unique_ptr<Expr> sequence
+  , std::unique_ptr<CompoundStmt> stmt
+  );
+
+  ~ForLoop();
+
+  /// A for loop may execute zero times... therefore it can never be
+  /// guarenteed to return.
+  bool returns() const override {
+    return false;
+  }
+
+  /// Return the runtime type of the statement
+  Stmt::Kind getKind() const override { return Kind::ForLoop;}
+
+  std::vector<TreeElement*> getChildren() const override;
+
+  std::string name() const override {
+    return "for-loop-statement";
+  };
+
+  LoopVarDecl* getDeclaration() {
+    return decl_.get();
+  }
+
+  /// Return true if the loop iterates over a range of integers
+  bool isRange() const {
+    return sequence_ == nullptr;
+  }
+
+  /// Return the inclusive start of the range, or nullptr
+  Expr* getStart() {
+    return start_.get();
+  }
+
+  /// Return the exclusive end of the range, or nullptr
+  Expr* getEnd() {
+    return end_.get();
+  }
+
+  /// Return the iterated array or slice, or nullptr
+  Expr* getSequence() {
+    return sequence_.get();
+  }
+
+  CompoundStmt* getBlock() {
+    return stmt_.get();
+  }
+
+  /// Marks the loop as parallel, so that its iterations may run on several
+  /// threads at once
+  void setParallel(std::vector<Reduction> reductions);
+
+  /// Return true if the iterations may run on several threads at once
+  bool isParallel() const {
+    return is_parallel_;
+  }
+
+  std::vector<Reduction>& getReductions() {
+    return reductions_;
+  }
+
+  DeclContext* getDeclContext() {
+    return &context_;
+  }
+
+  void setParentContext(DeclContext *parent) {
+    context_.setParentContext(parent);
+  }
+};
+
 /// Represents an Statement that when run, exits the current function with
 /// the given expression. If the ReturnStmt contains a nullptr expression, then
 /// the function returns with a void value.
@@ -1,6 +1,7 @@
 #ifndef AST_TYPE_DECL
 #define AST_TYPE_DECL
 
+#include <cstdint>
 #include <iostream>
 #include <list>
 #include <map>
@@ -91,27 +92,48 @@ public:
 
   bool isBooleanType() const;
 
+  /// Return the builtin scalar type spelled as name, e.g. "i64", "u8", "f32",
+  /// "bool" or "char", or nullptr if name does not spell a builtin type.
+  static Type* getBuiltinType(StringRef name);
+
   virtual std::string toString() const = 0;
 };
 
-/// A type which represents an integer
+/// A type which represents a signed or unsigned integer of 8, 16, 32 or 64
+/// bits. The default integer type is the signed 64 bit 'i64'.
 class IntegerType: public Type {
-  /// Singleton instance of IntegerType
-  static IntegerType singleton;
+  /// Singleton instances of each width and signedness
+  static IntegerType instances[8];
+
+  const int bits_;
+  const bool is_signed_;
 
   /// Construct IntegerType type
-  IntegerType() = default;
+  constexpr IntegerType(int bits, bool is_signed): bits_{bits}, is_signed_{is_signed} {}
 public:
 
-  /// Return the singleton instance of IntegerType. Type equality can be done
-  /// by pointer comparison becase all IntegerType have the same pointer.
+  /// Return the singleton instance of 'i64'. Type equality can be done by
+  /// pointer comparison becase all IntegerType of the same width and
+  /// signedness have the same pointer.
   static IntegerType* getInstance();
 
+  /// Return the singleton instance with the given width and signedness, or
+  /// nullptr if there is no integer type of that width.
+  static IntegerType* getInstance(int bits, bool is_signed);
+
   /// Return runtime type, which is Type::Kind::IntegerType
   Type::Kind getKind() const override { return Type::Kind::IntegerType; }
 
-  /// Return a string representation of the IntegerType as "Int"
-  std::string toString() const override { return "i64"; }
+  /// Return the number of bits of the integer
+  int bits() const { return bits_; }
+
+  /// Return true if the integer is signed, i.e. in two's complement
+  bool isSigned() const { return is_signed_; }
+
+  /// Return a string representation of the IntegerType, e.g. "i64" or "u8"
+  std::string toString() const override {
+    return (is_signed_ ? "i" : "u") + std::to_string(bits_);
+  }
 };
 
 
@@ -159,25 +181,37 @@ public:
   std::string toString() const override { return "bool"; }
 };
 
-/// A type which represents a double
+/// A type which represents an IEEE binary floating point number of 32 or 64
+/// bits. The default floating point type is the 64 bit 'f64'.
 class DoubleType: public Type {
 private:
-  /// Singleton instance of DoubleType
+  /// Singleton instances of 'f32' and 'f64'
+  static DoubleType single;
   static DoubleType singleton;
 
+  const int bits_;
+
   /// Construct Double type
-  DoubleType() = default;
+  constexpr DoubleType(int bits): bits_{bits} {}
 public:
 
-  /// Return the singleton instance of DoubleType. Type equality can be done
-  /// by pointer comparison becase all DoubleType have the same pointer.
+  /// Return the singleton instance of 'f64'. Type equality can be done by
+  /// pointer comparison becase all DoubleType of the same width have the same
+  /// pointer.
   static DoubleType* getInstance();
 
+  /// Return the singleton instance with the given width, or nullptr if there
+  /// is no floating point type of that width.
+  static DoubleType* getInstance(int bits);
+
   /// Return runtime type, which is Type::Kind::DoubleType
   Type::Kind getKind() const override { return Kind::DoubleType; }
 
-  /// Return a string representation of the DoubleType as "Double"
-  std::string toString() const override { return "f64"; }
+  /// Return the number of bits of the floating point number
+  int bits() const { return bits_; }
+
+  /// Return a string representation of the DoubleType, "f32" or "f64"
+  std::string toString() const override { return "f" + std::to_string(bits_); }
 
 };
 
@@ -280,19 +314,24 @@ class TypeIdentifier : public Type {
 private:
   std::string name_;
 
+  /// The type arguments of an instance of a generic struct, e.g. the i64 in
+  /// `Box[i64]`, which is empty for any other named type
+  std::vector<Type*> args_;
+
   /// Singleton instances of active TypeIdentifier types
   static std::vector<std::unique_ptr<TypeIdentifier>> instances;
 
 public:
   /// Construct TypeIdentifier type with given reference name
-  TypeIdentifier(std::string n) : name_{n} {}
+  TypeIdentifier(std::string n, std::vector<Type*> args = {})
+  : name_{n}, args_{std::move(args)} {}
 
   /// Return a pointer to a TypeIdentifier instance with the given key and value
   /// types. It is guarenteed that all TypeIdentifier with the same key and value
   /// types will have the same address, so that TypeIdentifier can be compared by
   /// pointer for equality.
-  static TypeIdentifier* getInstance(std::string n) {
-    TypeIdentifier type_id{n};
+  static TypeIdentifier* getInstance(std::string n, std::vector<Type*> args = {}) {
+    TypeIdentifier type_id{n, std::move(args)};
     instances.push_back(std::make_unique<TypeIdentifier>(std::move(type_id)));
     return instances.back().get();
   }
@@ -302,16 +341,28 @@ public:
 
   /// Return runtime type, which is Type::Kind::TypeIdentifier
   bool operator==(TypeIdentifier &type) const {
-    return name_ == type.name_;
+    return name_ == type.name_ && args_ == type.args_;
   };
 
 
   std::string name() const {
     return name_;
   }
-  /// Return a string representation of the TypeIdentifier as "<name>"
+
+  const std::vector<Type*>& getTypeArgs() const {
+    return args_;
+  }
+
+  /// Return a string representation of the TypeIdentifier as "<name>", which
+  /// is followed by the type arguments of a generic struct as in "Box[i64]"
   std::string toString() const override {
-    return name_ ;
+    if (args_.empty()) return name_;
+    std::string str = name_ + "[";
+    for (auto it = args_.begin(); it != args_.end(); ++it) {
+      if (it != args_.begin()) str += ", ";
+      str += (*it)->toString();
+    }
+    return str + "]";
   }
 
 };
@@ -504,6 +555,22 @@ public:
   }
 };
 
+/// The memory layout of a struct, which is written as attributes before
+/// `struct`. By default fields are stored in declaration order with their
+/// natural alignment.
+struct StructLayout {
+  /// `@packed`: fields are stored without padding, so they may be misaligned
+  bool is_packed = false;
+  /// `@reorder`: fields are stored by decreasing alignment, which minimizes
+  /// padding
+  bool is_reordered = false;
+  /// `@soa`: arrays of the struct store each field in an array of its own
+  bool is_soa = false;
+  /// `@align(N)`: the minimum alignment of the struct in bytes, or zero for
+  /// its natural alignment
+  uint64_t align = 0;
+};
+
 /*
  * A type which represents a structured data with named fields and methods.
  * A struct type with a given list of fields is considered different from an
@@ -513,6 +580,7 @@ public:
 class StructType: public Type {
 private:
   std::vector<std::pair<std::string, Type*>> members_;
+  StructLayout layout_;
 
   /// Singleton instances of active List types
   static std::vector<std::unique_ptr<StructType>> instances;
@@ -565,6 +633,14 @@ public:
     return members_[index].second;
   }
 
+  void setLayout(StructLayout layout) {
+    layout_ = layout;
+  }
+
+  const StructLayout& getLayout() const {
+    return layout_;
+  }
+
   /// Return a string representation of the list type as "[<element-type>]"
   std::string toString() const override {
     std::stringstream ss;
@@ -584,6 +660,11 @@ private:
   Type* element_type_;
   const int size_;
 
+  /// The name of the constant which gives the size, if the size is not
+  /// written as a literal. Such list types are resolved to the list type with
+  /// the value of the constant as its size.
+  std::string size_name_;
+
   /// Singleton instances of active List types
   static std::vector<std::unique_ptr<ListType>> instances;
 
@@ -592,6 +673,10 @@ public:
   /// Constructs a ListType with the given element type
   ListType(Type* element_type, int size) : element_type_{element_type}, size_{size} {}
 
+  /// Constructs a ListType whose size is the value of the named constant
+  ListType(Type* element_type, std::string size_name)
+  : element_type_{element_type}, size_{-1}, size_name_{size_name} {}
+
   /// Return a pointer to a ListType instance with the given key and value types.
   /// It is guarenteed that all ListType with the same key and value types will
   /// have the same address, so that ListType can be compared by pointer for
@@ -610,11 +695,19 @@ public:
     }
   }
 
+  /// Return a new ListType whose size is named by a constant. Like type
+  /// identifiers, these are not unique, since the same name may refer to
+  /// different constants in different scopes.
+  static ListType* getInstance(Type* type, std::string size_name) {
+    instances.push_back(std::make_unique<ListType>(type, size_name));
+    return instances.back().get();
+  }
+
   /// Compares fields for equality. This should only be necessary when
   /// constructing a new instance. Otherwise, ListTypes should be compared for
   /// pointer equality.
   bool operator==(const ListType &type) const {
-    return element_type_ == type.element_type_ && size_ == type.size_;
+    return element_type_ == type.element_type_ && size_ == type.size_ && size_name_ == type.size_name_;
   };
 
   /// Return the runtime type of the Type, which is Type::Kind::ListType
@@ -626,18 +719,83 @@ public:
   /// Return a const pointer to the element type
   int size() const { return size_; }
 
+  /// Return true if the size is named by a constant which is not resolved yet
+  bool hasNamedSize() const { return !size_name_.empty(); }
+
+  /// Return the name of the constant which gives the size
+  const std::string& size_name() const { return size_name_; }
+
   /// Return a string representation of the list type as "[<element-type>]"
   std::string toString() const override {
     std::stringstream ss;
-    ss << "[" << element_type_->toString() << ", " << size_ << "]";
+    ss << "[" << element_type_->toString() << ", ";
+    if (hasNamedSize()) ss << size_name_; else ss << size_;
+    ss << "]";
+    return ss.str();
+  }
+};
+
+/// A type which represents a fixed number of scalar lanes which are operated
+/// on together. Arithmetic and comparison operators apply lane-wise, so that
+/// values of vector type map directly onto SIMD registers.
+class VectorType : public Type {
+private:
+  Type* element_type_;
+  const int size_;
+
+  /// Singleton instances of active Vector types
+  static std::vector<std::unique_ptr<VectorType>> instances;
+
+public:
+
+  /// Constructs a VectorType with the given lane type and lane count
+  VectorType(Type* element_type, int size) : element_type_{element_type}, size_{size} {}
+
+  /// Return a pointer to a VectorType instance with the given lane type and
+  /// lane count. It is guarenteed that all VectorType with the same lane type
+  /// and count will have the same address, so that VectorType can be compared
+  /// by pointer for equality.
+  static VectorType* getInstance(Type* type, int size) {
+    const VectorType vector_type{type, size};
+    auto it = std::find_if(instances.begin(), instances.end()
+    , [&vector_type](auto &type){
+      return vector_type == *type;
+    });
+    if (it != instances.end()) {
+      return it->get();
+    } else {
+      instances.push_back(std::make_unique<VectorType>(type, size));
+      return instances.back().get();
+    }
+  }
+
+  /// Compares fields for equality. This should only be necessary when
+  /// constructing a new instance. Otherwise, VectorTypes should be compared
+  /// for pointer equality.
+  bool operator==(const VectorType &type) const {
+    return element_type_ == type.element_type_ && size_ == type.size_;
+  };
+
+  /// Return the runtime type of the Type, which is Type::Kind::VectorType
+  Type::Kind getKind() const override { return Kind::VectorType; }
+
+  /// Return a const pointer to the lane type
+  Type* element_type() const { return element_type_; }
+
+  /// Return the number of lanes
+  int size() const { return size_; }
+
+  /// Return a string representation of the vector type as "vec[<lane>, <n>]"
+  std::string toString() const override {
+    std::stringstream ss;
+    ss << "vec[" << element_type_->toString() << ", " << size_ << "]";
     return ss.str();
   }
 };
 
-/// A type which represents a key-value pair mapping. Maps are currently not
-/// implemented. It is unlikely that maps will be fully implemented. Rather,
-/// they will probably be put off until some sort of template system is in
-/// place.
+/// A type which represents a key-value pair mapping, written as `[K: V]`. A
+/// map is a handle to a hash table in the runtime library, so copies of a map
+/// refer to the same table. Keys must be integers, characters or booleans.
 class MapType : public Type {
 private:
   Type* key_;
@@ -687,7 +845,58 @@ public:
 
   /// Return a string representation of the MapType as "[<key>: <val>]"
   std::string toString() const override {
-    return "[" + key_->toString() + ": " + key_->toString() + "]";
+    return "[" + key_->toString() + ": " + val_->toString() + "]";
+  }
+};
+
+/// An integer which is shared between threads, written as `atomic[T]`. An
+/// atomic is only accessed through the atomic builtins, which take a
+/// reference to it, so that every access is a single atomic instruction.
+class AtomicType : public Type {
+private:
+  Type* value_;
+
+  /// Singleton instances of active Atomic types
+  static std::vector<std::unique_ptr<AtomicType>> instances;
+
+public:
+
+  /// The orderings of atomic operations, as in the C++ memory model
+  enum class Order { Relaxed, Acquire, Release, AcquireRelease, SequentiallyConsistent };
+
+  /// Constructs an AtomicType holding values of the given type
+  AtomicType(Type *value): value_{value} {}
+
+  /// Return true if name spells an ordering, i.e. relaxed, acquire, release,
+  /// acq_rel or seq_cst, and sets order to it
+  static bool getOrder(StringRef name, Order &order);
+
+  /// Return a pointer to the AtomicType instance with the given value type.
+  /// It is guarenteed that all AtomicTypes with the same value type will have
+  /// the same address, so that AtomicTypes can be compared by pointer for
+  /// equality.
+  static AtomicType* getInstance(Type *value) {
+    auto it = std::find_if(instances.begin(), instances.end()
+    , [value](auto &type){
+      return type->value_ == value;
+    });
+    if (it != instances.end()) {
+      return it->get();
+    } else {
+      instances.push_back(std::make_unique<AtomicType>(value));
+      return instances.back().get();
+    }
+  }
+
+  /// Return the runtime type of the Type
+  Type::Kind getKind() const override { return Kind::AtomicType; }
+
+  /// Return a const pointer to the type of the values the atomic holds
+  Type* getValueType() const { return value_; }
+
+  /// Return a string representation of the AtomicType as "atomic[<value>]"
+  std::string toString() const override {
+    return "atomic[" + value_->toString() + "]";
   }
 };
 
@@ -11,8 +11,8 @@ private:
 public:
   enum {
     unknown, eof, identifier, l_brace, l_paren, l_square, r_brace, r_paren,
-    r_square, comma, semi, elipses, dot, colon, backslash, integer_literal, double_literal, character_literal, string_literal, operator_id,
-    kw_var, kw_let, kw_func, kw_typedef, kw_struct, kw_extern, kw_if, kw_else, kw_then, kw_true, kw_false, kw_while, kw_return, kw_typealias, new_line
+    r_square, comma, semi, elipses, range, dot, colon, backslash, at, integer_literal, double_literal, character_literal, string_literal, operator_id,
+    kw_var, kw_let, kw_func, kw_typedef, kw_struct, kw_extern, kw_if, kw_else, kw_then, kw_true, kw_false, kw_while, kw_for, kw_in, kw_return, kw_typealias, kw_const, kw_inline, kw_parallel, kw_match, kw_case, new_line
   };
   Token(int type, const char *loc, int length): type_{type}, lexeme_{loc, length} {}
   Token(int type, StringRef str): type_{type}, lexeme_{str} {}
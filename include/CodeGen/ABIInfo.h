@@ -0,0 +1,106 @@
+#ifndef CODEGEN_ABI_INFO_H
+#define CODEGEN_ABI_INFO_H
+
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Type.h"
+
+#include <vector>
+
+/// Describes how a single parameter or return value is passed across a
+/// function boundary in the C calling convention of the target.
+struct ABIArgInfo {
+  enum class Kind {
+    /// Passed as the lowered llvm type itself. Used for all scalars.
+    Direct,
+    /// Passed through a pointer to a copy of the value. Parameters are marked
+    /// 'byval', and return values are written to a caller provided 'sret'
+    /// pointer passed as the first argument.
+    Indirect,
+    /// Split into register sized pieces which are each passed as a separate
+    /// llvm argument, or returned together as a literal struct.
+    Coerce
+  };
+
+  Kind kind = Kind::Direct;
+
+  /// How an integer narrower than 32 bits is extended to fill its register.
+  /// The lowered llvm type does not carry the signedness, so it is set from
+  /// the source type after classification.
+  enum class Extension {
+    None, Sign, Zero
+  };
+
+  Extension extension = Extension::None;
+
+  /// The register sized pieces of a coerced value, in memory order
+  std::vector<llvm::Type*> pieces;
+
+  static ABIArgInfo getDirect() {
+    return ABIArgInfo{};
+  }
+
+  static ABIArgInfo getIndirect() {
+    ABIArgInfo info;
+    info.kind = Kind::Indirect;
+    return info;
+  }
+
+  static ABIArgInfo getCoerce(std::vector<llvm::Type*> pieces) {
+    ABIArgInfo info;
+    info.kind = Kind::Coerce;
+    info.pieces = std::move(pieces);
+    return info;
+  }
+
+  /// Return the in-memory layout of a coerced value, a literal struct of its
+  /// pieces. It is always at least as large as the original aggregate.
+  llvm::StructType* getCoercedType(llvm::LLVMContext &context) const {
+    return llvm::StructType::get(context, pieces);
+  }
+
+  /// Return the llvm type a coerced value is returned as. A single piece is
+  /// returned as itself, multiple pieces are returned as a literal struct.
+  llvm::Type* getCoercedReturnType(llvm::LLVMContext &context) const {
+    if (pieces.size() == 1) return pieces.front();
+    else return getCoercedType(context);
+  }
+};
+
+/// The lowering of every parameter and the return value of a function type.
+struct FunctionABIInfo {
+  ABIArgInfo returns;
+  std::vector<ABIArgInfo> params;
+};
+
+/// Classifies lowered llvm types according to the C calling convention of the
+/// module's target triple. On x86-64 System V targets, aggregates of at most
+/// 16 bytes are split into integer and floating point registers, and larger
+/// aggregates are passed in memory. On all other targets, aggregates are
+/// conservatively passed in memory.
+class ABIInfo {
+private:
+  const llvm::Module &module_;
+
+  enum class RegisterClass {
+    None, Integer, SSE, Memory
+  };
+
+  bool isSysVX86_64() const;
+
+  void classifyEightbytes(
+    llvm::Type *type
+  , uint64_t offset
+  , std::vector<RegisterClass> &classes
+  , std::vector<llvm::Type*> &first_leaves
+  ) const;
+
+public:
+  ABIInfo(const llvm::Module &module): module_{module} {}
+
+  /// Return how a value of the given lowered type is passed
+  ABIArgInfo classify(llvm::Type *type) const;
+};
+
+#endif
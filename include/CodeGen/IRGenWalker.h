@@ -4,14 +4,17 @@
 
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Analysis/Interval.h"
@@ -19,12 +22,15 @@
 #include "llvm/IR/Verifier.h"
 
 #include "Basic/CompilerException.h"
+#include "CodeGen/ABIInfo.h"
 #include "AST/Type.h"
 #include "AST/Expr.h"
 #include "AST/Stmt.h"
 #include "AST/Decl.h"
 #include <vector>
 #include <map>
+#include <set>
+#include <utility>
 
 class LLVMTransformer {
 private:
@@ -35,18 +41,89 @@ private:
 
   std::map<StringRef, llvm::Value*> named_values_;
 
+  /// The lowering of every AST type seen so far. AST types are uniqued, so
+  /// they can be keyed by address. This is shared by all functions of the
+  /// module, and ensures that a struct is lowered to a single llvm type.
+  llvm::DenseMap<const Type*, llvm::Type*> type_cache_;
+
+  /// The opaque type of the hash tables of the runtime library, which all
+  /// map types point to
+  llvm::StructType* map_type_ = nullptr;
+
+  /// The slots of the map variables declared in the enclosing blocks,
+  /// innermost last. Their tables are freed when the block declaring them
+  /// exits or the function returns.
+  std::vector<llvm::Value*> owned_maps_;
+
+  /// The llvm element index of each member of every struct lowered so far,
+  /// which differs from the member index if the struct is reordered or
+  /// over-aligned
+  std::map<const StructType*, std::vector<unsigned>> member_indices_;
+
+  /// Parameters of the current function which were passed in memory. Their
+  /// named value is a pointer to the parameter rather than the value itself.
+  std::set<const llvm::Value*> indirect_args_;
+
+  /// How the current function returns its result, and the caller provided
+  /// 'sret' pointer if the result is returned in memory.
+  ABIArgInfo return_info_;
+  llvm::Value* return_slot_ = nullptr;
+
+  /// Private globals holding constant aggregates. Constants are uniqued by the
+  /// context, so equal literals map to the same global.
+  std::map<llvm::Constant*, llvm::GlobalVariable*> constant_globals_;
+
+  /// The llvm function of every function declared so far. Functions are
+  /// keyed by declaration, so that each instance of a generic function is
+  /// lowered once no matter how often it is called.
+  std::map<const FuncDecl*, llvm::Function*> functions_;
+
+  /// Whether element accesses with a runtime index are checked against the
+  /// length of the accessed aggregate.
+  bool bounds_checking_ = true;
+
+  /// The number of enclosing blocks with their own allocator, which are
+  /// popped before the function returns
+  unsigned allocator_scopes_ = 0;
+
 public:
   LLVMTransformer(llvm::LLVMContext& context, llvm::Module* module) : context_{context} {
     module_ = module;
   }
 
+  /// Enables or disables runtime bounds checks for element accesses. Accesses
+  /// proven in bounds during semantic analysis are never checked.
+  void setBoundsChecking(bool enabled) {
+    bounds_checking_ = enabled;
+  }
+
+  /// Classifies the parameters and return value of a function type according
+  /// to the C calling convention of the target.
+  FunctionABIInfo classifyFunctionType(const FunctionType &type);
+
+  /// Return the llvm function type after ABI lowering. Aggregates passed in
+  /// memory become pointers, and a result returned in memory becomes a
+  /// leading 'sret' pointer parameter.
   llvm::FunctionType* transformFunctionType(const FunctionType &type);
 
   llvm::StructType* transformStructType(const TupleType &type);
+  /// Structs are lowered to a named struct laid out as requested by their
+  /// attributes, which may reorder, pack or over-align the members.
   llvm::StructType* transformStructType(const StructType &type);
 
+  /// Return the llvm element index of a member of the struct
+  unsigned memberIndex(const StructType &type, int member);
+
+  /// Slices are lowered to a { element*, i64 } pair holding a pointer to the
+  /// first element and the number of elements.
+  llvm::StructType* transformSliceType(const SliceType &type);
+
+  /// Return the llvm type of the given type. Results are cached per type.
   llvm::Type* transformType(const Type &type);
 
+  /// Lowers a type which is not yet in the type cache
+  llvm::Type* lowerType(const Type &type);
+
   void transformReturnStmt(const ReturnStmt& stmt, llvm::BasicBlock* current_block);
 
   void transformLetDecl(const LetDecl& let_decl, llvm::BasicBlock* current_block);
@@ -71,21 +148,158 @@ public:
 
   llvm::Value* transformAccessorExprReference(const AccessorExpr &accessor, llvm::BasicBlock* current_block);
 
+  /// Return the GEP index of the member or element accessed by the accessor,
+  /// whose aggregate is at aggregate_loc. Runtime indices are bounds checked.
+  llvm::Value* transformElementIndex(const AccessorExpr &accessor, llvm::Value* aggregate_loc, llvm::BasicBlock* current_block);
+
+  /// Gathers the fields of an element of an array of @soa structs into a
+  /// struct value.
+  llvm::Value* transformSoaElementLoad(llvm::Value* array_loc, const StructType& type, llvm::Value* index, llvm::BasicBlock* current_block);
+
+  /// Scatters a struct value into the field arrays of an element of an array
+  /// of @soa structs.
+  void transformSoaElementStore(llvm::Value* value, llvm::Value* array_loc, const StructType& type, llvm::Value* index, llvm::BasicBlock* current_block);
+
   llvm::Value* transformExprReference(const Expr& expr, llvm::BasicBlock* current_block);
 
+  /// Return a pointer to the value of the expression. Left values are
+  /// referenced in place, and all other values are copied into a temporary.
+  llvm::Value* transformExprAddress(const Expr& expr, llvm::BasicBlock* current_block);
+
+  /// Creates a stack slot at the start of the current function, so that it is
+  /// allocated once no matter how often the current block executes.
+  llvm::AllocaInst* createEntryBlockAlloca(llvm::Type* type, const std::string& name = "");
+
+  /// Splits an aggregate value into the register sized pieces it is passed as
+  std::vector<llvm::Value*> coerceToPieces(llvm::Value* value, const ABIArgInfo& info, llvm::BasicBlock* current_block);
+
+  /// Reassembles an aggregate of the given type from a coerced return value
+  llvm::Value* coerceFromPieces(llvm::Value* value, llvm::Type* type, const ABIArgInfo& info, llvm::BasicBlock* current_block);
+
+  /// Transforms the expression and converts it to the given type if an
+  /// implicit conversion exists, e.g. from a reference to an array to a slice.
+  llvm::Value* transformExprAs(const Expr& expr, const Type& type, llvm::BasicBlock* current_block);
+
+  /// Builds a slice from a reference to an array of statically known length.
+  llvm::Value* transformSliceConversion(const Expr& expr, llvm::BasicBlock* current_block);
+
+  /// Return the pointer to the first element and the length of an array,
+  /// a reference to an array, or a slice. Arrays are accessed in place. For
+  /// an array of @soa structs the pointer is the address of the array.
+  std::pair<llvm::Value*, llvm::Value*> transformSequence(const Expr& sequence, llvm::BasicBlock* current_block);
+
+  /// Return the module-local helper which traps when index is not in the
+  /// range [0, length). It is created on first use.
+  llvm::Function* getBoundsCheckFunction();
+
+  /// Emits a call to the bounds check helper unless bounds checking is
+  /// disabled.
+  void transformBoundsCheck(llvm::Value* index, llvm::Value* length, llvm::BasicBlock* current_block);
+
+  llvm::Value* transformLenCall(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Return the declaration of the runtime map function with the given name,
+  /// e.g. "__bulat_map_find". See runtime/bulat_map.h.
+  llvm::Function* getMapFunction(const std::string& name);
+
+  /// Frees the tables of the owned maps after the first `kept` ones
+  void freeOwnedMaps(size_t kept, llvm::BasicBlock* current_block);
+
+  /// Return the key of a map zero extended to 64 bits, and its hash, which
+  /// is specialized for the width of the key type.
+  std::pair<llvm::Value*, llvm::Value*> transformMapKey(const Expr& key, llvm::BasicBlock* current_block);
+
+  /// Emits insert, find, contains and erase as calls to the runtime library.
+  llvm::Value* transformMapBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Return the declaration of the runtime allocation function with the
+  /// given name, e.g. "__bulat_alloc". See runtime/bulat_alloc.h.
+  llvm::Function* getAllocationFunction(const std::string& name);
+
+  /// Emits new, alloc and free as calls to the runtime library.
+  llvm::Value* transformAllocationBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Emits the atomic builtins as atomic loads and stores, atomicrmw,
+  /// cmpxchg and fence instructions with the ordering of the call.
+  llvm::Value* transformAtomicBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Converts a value between integer and floating point types. Integers are
+  /// extended according to the signedness of the source type.
+  llvm::Value* transformNumericCast(llvm::Value* value, const Type& from, const Type& to, llvm::BasicBlock* current_block);
+
+  /// Return an index of any integer type extended or truncated to the i64
+  /// used for lengths and bounds checks.
+  llvm::Value* transformIndex(const Expr& index, llvm::BasicBlock* current_block);
+
+  /// Emits splat, shuffle, select, the reductions, and vector loads and
+  /// stores. Their operands have been checked by the type checker.
+  llvm::Value* transformVectorBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Lowers a call to an intrinsic such as popcount, fma or prefetch to the
+  /// corresponding LLVM intrinsic or instruction sequence.
+  llvm::Value* transformIntrinsicCall(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Emits a bounds checked load or store of consecutive elements of a
+  /// sequence as a single vector.
+  llvm::Value* transformVectorMemoryAccess(const FunctionCall& call, llvm::BasicBlock* current_block);
+
+  /// Extracts a single lane of a vector. Runtime lane indices are checked
+  /// against the lane count.
+  llvm::Value* transformLaneAccess(const AccessorExpr& accessor, llvm::BasicBlock* current_block);
+
   llvm::Value* transformAssignmentStmt(const BinaryExpr& bin_expr, llvm::BasicBlock* current_block);
 
   llvm::Constant* transformConstant(const Expr& expr);
 
   llvm::Constant* transformConstantListExpr(const ListExpr& list);
 
+  /// Return the constant array of the elements, which are transposed if they
+  /// are @soa structs
+  llvm::Constant* transformConstantArray(const Type& element_type, const std::vector<llvm::Constant*>& elements);
+
   llvm::Constant* transformConstantTupleExpr(const TupleExpr& list);
 
+  /// Return the llvm constant of a value computed at compile time, such as
+  /// the value of a constant declaration
+  llvm::Constant* transformConstantValue(const ConstantValue& value);
+
+  /// Return the constant value of a string, list or tuple literal, or nullptr
+  /// if the expression is not an aggregate literal.
+  llvm::Constant* transformConstantAggregate(const Expr& expr);
+
+  /// Return a 'private unnamed_addr constant' global holding the given
+  /// constant. It is created on first use and shared across the module.
+  llvm::GlobalVariable* getConstantGlobal(llvm::Constant* constant);
+
+  /// Return the declaration of the extern function, which may be referred to
+  /// by several compilation units but is declared once per module.
   llvm::Function* transformExternalFunctionDecl(const ExternFuncDecl &extern_func);
 
   llvm::Function* transformFunction(const FuncDecl &func);
 
-  llvm::Value* transformFunctionCall(const FunctionCall& call, llvm::BasicBlock* current_block);
+  /// Transforms the functions which were called but only declared, and are
+  /// internal to the module. These are the inline functions and generic
+  /// instances of other compilation units, of which every module calling
+  /// them has its own copy.
+  void transformReferencedFunctions();
+
+  /// Return the llvm function of the declaration, which is declared with its
+  /// ABI and attributes if it has not been declared yet. Instances of generic
+  /// functions are internal to the module, since they are created for the
+  /// calls in the module and named after their type arguments.
+  llvm::Function* declareFunction(const FuncDecl &func);
+
+  /// Attaches the memory effects and parameter usage inferred during semantic
+  /// analysis to the current function as llvm attributes.
+  void transformFunctionAttributes(const FuncDecl &func, const FunctionABIInfo &function_info);
+
+  /// If result_slot is given and the callee returns its result in memory, the
+  /// result is written directly to result_slot and nullptr is returned.
+  llvm::Value* transformFunctionCall(
+    const FunctionCall& call
+  , llvm::BasicBlock* current_block
+  , llvm::Value* result_slot = nullptr
+  );
 
 
   llvm::Value* transformIdentifierExpr(const IdentifierExpr& expr, llvm::BasicBlock* current_block);
@@ -101,11 +315,53 @@ public:
     llvm::BasicBlock* current_block
   );
 
+  /// Lowers a match statement to a switch instruction, which LLVM turns into
+  /// a jump table or a binary search over the cases
+  llvm::BasicBlock* transformMatchStmt(
+    MatchStmt& tree
+  , llvm::BasicBlock* current_block
+  );
+
   llvm::BasicBlock* transformWhileLoop(
     WhileLoop& tree
   , llvm::BasicBlock* entry_block
   );
 
+  /// Emits a for loop in the canonical form expected by the loop optimizers.
+  /// The bounds are computed in a preheader, the header tests the induction
+  /// variable, and a single latch increments it and branches back.
+  llvm::BasicBlock* transformForLoop(
+    ForLoop& tree
+  , llvm::BasicBlock* entry_block
+  );
+
+  /// Emits a parallel for loop. The body is outlined into a function which
+  /// runs a subrange of the iterations, and which the runtime library calls
+  /// on its threads with a context holding the values the body uses. Each
+  /// call reduces into private copies of the reduction variables, which are
+  /// combined into the shared variables with atomic operations at its end.
+  llvm::BasicBlock* transformParallelForLoop(
+    ForLoop& tree
+  , llvm::BasicBlock* entry_block
+  );
+
+  /// Atomically combines the partial result of a reduction into the shared
+  /// variable at the given address
+  void combineReduction(
+    Reduction::Operator op
+  , const Type& type
+  , llvm::Value* shared
+  , llvm::Value* partial
+  , llvm::BasicBlock*& current_block
+  );
+
+  /// Return the declaration of a function of the parallel runtime
+  llvm::Function* getParallelFunction(const std::string& name);
+
+  /// Return a new distinct loop id which asks the optimizer to vectorize and
+  /// unroll the loop it is attached to.
+  llvm::MDNode* createLoopMetadata();
+
 
   void transformConditionalStmt(
     ConditionalStmt& tree
@@ -122,6 +378,30 @@ public:
   /// exception is thrown.
   llvm::Value* transformBinaryExpr(const BinaryExpr& expr, llvm::BasicBlock* current_block);
 
+  /// Adds a short circuiting `&&` or `||` of booleans, which only evaluates
+  /// the right operand if the left one does not decide the result
+  llvm::Value* transformLogicalExpr(const BinaryExpr& expr, llvm::BasicBlock* current_block);
+
+  /// Moves the instructions of the block to a new block in front of it, which
+  /// also takes over its predecessors, and returns the new block. This lets
+  /// expressions branch while the caller keeps appending to the given block.
+  llvm::BasicBlock* splitBlockBefore(llvm::BasicBlock* block, const std::string& name);
+
+  /// Which way a branch is expected to go
+  enum class BranchHint { None, Likely, Unlikely };
+
+  /// Returns the condition of a branch without a `likely` or `unlikely` call
+  /// around it, and sets the hint accordingly
+  const Expr& stripBranchHint(const Expr& condition, BranchHint& hint);
+
+  /// Return the branch weights of a hint, or nullptr if there is none
+  llvm::MDNode* createBranchWeights(BranchHint hint);
+
+  /// Applies the builtin binary operator to two operands of the given type.
+  /// Used for binary expressions and compound assignments.
+  llvm::Value* transformBinaryOperator(StringRef op, llvm::Value* lval, llvm::Value* rval,
+                                       const Type& operand_type, llvm::BasicBlock* current_block);
+
 
   llvm::Value* transformUnaryExpr(const UnaryExpr& expr, llvm::BasicBlock* current_block);
 };
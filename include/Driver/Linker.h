@@ -0,0 +1,53 @@
+#ifndef DRIVER_LINKER_H
+#define DRIVER_LINKER_H
+
+#include <string>
+#include <vector>
+
+/// Describes an executable and the files it is linked from.
+struct LinkOptions {
+  /// Object files, bitcode files compiled with -flto, and static libraries,
+  /// in the order they are passed to the linker
+  std::vector<std::string> inputs;
+
+  std::string output;
+
+  /// The C compiler which runs the linker, or empty to search for one
+  std::string linker;
+
+  enum class Mode {
+    /// A position independent executable, whose code must be compiled as
+    /// position independent code
+    PIE,
+    /// An executable loaded at a fixed address, which still uses the shared
+    /// C library
+    NoPIE,
+    /// An executable which contains the C library, and needs no loader
+    Static
+  };
+
+  Mode mode = Mode::PIE;
+
+  /// Removes the functions and globals which are not referenced, which
+  /// requires every function and global to have its own section
+  bool gc_sections = false;
+
+  /// The inputs include bitcode, which the linker optimizes as a whole
+  bool lto = false;
+
+  /// Symbols which are linked from the libraries even though no input refers
+  /// to them
+  std::vector<std::string> undefined_symbols;
+
+  /// Directories searched for libraries, and the libraries given with -l
+  std::vector<std::string> library_paths;
+  std::vector<std::string> libraries;
+};
+
+/// Links an executable with the C compiler of the system, which knows where
+/// the C runtime and libraries of the target are, and runs the system linker
+/// with them. Clang is preferred, since it can link bitcode with -flto.
+/// Returns 0 on success, and otherwise prints an error and returns 1.
+int linkExecutable(const LinkOptions &options);
+
+#endif
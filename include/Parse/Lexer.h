@@ -22,6 +22,10 @@ private:
   void lexSlashSlashComment();
 public:
   Lexer(std::shared_ptr<SourceFile> source);
+
+  /// Construct a lexer which starts at the given location in the source,
+  /// rather than at its beginning
+  Lexer(std::shared_ptr<SourceFile> source, const char* start);
   const char* current_loc() const;
   Token next();
 };
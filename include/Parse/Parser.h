@@ -2,6 +2,7 @@
 #define PARSER_H
 
 #include <deque>
+#include <map>
 
 #include "Basic/Token.h"
 #include "Basic/CompilerException.h"
@@ -55,6 +56,10 @@ private:
 
   Token token_;
 
+  // The types which replace the type parameters of a generic declaration
+  // while one of its instances is parsed, by parameter name
+  std::map<std::string, Type*> type_args_;
+
   //===-------------------------- Internal Use  ---------------------------===//
 
   // The possible start tokens of expressions
@@ -63,6 +68,14 @@ private:
 public:
   Parser(std::shared_ptr<SourceFile> source);
 
+  /**
+   * Constructs a parser which starts at the given location in the source, and
+   * which replaces the named type parameters by the given types. This is used
+   * to parse an instance of a generic declaration, which starts at the
+   * location recorded when the declaration was first parsed.
+   */
+  Parser(std::shared_ptr<SourceFile> source, const char* start, std::map<std::string, Type*> type_args);
+
 
   //===-------------------------  Helper Methods --------------------------===//
 
@@ -138,7 +151,11 @@ public:
    */
   Type* parseType();
   /**
+   * Parses a named type. The name of a generic struct is followed by its type
+   * arguments, and a type parameter is replaced by its argument while an
+   * instance of a generic declaration is parsed.
    *
+   * <type-identifier> := <identifier> ('[' <type> (',' <type>)* ']')?
    */
   Type* parseTypeIdentifier();
   /**
@@ -162,9 +179,20 @@ public:
    */
   Type* parseTupleOrFunctionType();
   /**
+   * Parses the lane type and lane count of a vector type, which follow the
+   * 'vec' identifier.
+   *
+   * <vector-type> := 'vec' '[' <type> ',' <integer-literal> ']'
+   */
+  VectorType* parseVectorType();
+
+  /**
+   * Parses the value type of an atomic type, which follows the 'atomic'
+   * identifier.
    *
+   * <atomic-type> := 'atomic' '[' <type> ']'
    */
-  ListType* parseListType();
+  AtomicType* parseAtomicType();
   /**
    *
    */
@@ -174,7 +202,12 @@ public:
   PointerType* parsePointerType();
 
   /**
+   * Parses a map, array or slice type. The size of an array is either a
+   * literal or the name of an integer constant.
    *
+   * <map-type> := '[' <type> ':' <type> ']'
+   * <list-type> := '[' <type> ',' (<integer-literal> | <identifier>) ']'
+   * <slice-type> := '[' <type> ']'
    */
   Type* parseListOrMapType();
 
@@ -207,15 +240,57 @@ public:
   std::unique_ptr<LetDecl> parseLetDecl();
 
   /**
+   * Parses a constant, whose value is computed during semantic analysis.
+   *
+   * <const-decl> := 'const' <identifier> ':' <type> '=' <expr>
+   */
+  std::unique_ptr<ConstDecl> parseConstDecl();
+
+  /**
+   * Parses a function, which is generic if its name is followed by a list of
+   * type parameters.
    *
+   * <func-decl> := <func-attributes> 'func' <identifier> <type-params>? '(' <param-list> ')' '->' <type> <compound-stmt>
    */
   std::unique_ptr<FuncDecl> parseFuncDecl();
 
   /**
+   * Parses the optimization hints of a function. A function can not be both
+   * inline and noinline, or both hot and cold.
    *
+   * <func-attributes> := ('inline' | '@' ('noinline' | 'hot' | 'cold'))*
+   */
+  FuncAttributes parseFuncAttributes();
+
+  /**
+   * Parses a struct, which is generic if its name is followed by a list of
+   * type parameters.
+   *
+   * <struct-decl> := <struct-attributes> 'struct' <identifier> <type-params>? <struct-type>
    */
   std::unique_ptr<StructDecl> parseStructDecl();
 
+  /**
+   * Parses the layout of a struct. A struct can not be both packed and
+   * aligned, and its alignment must be a power of two.
+   *
+   * <struct-attributes> := ('@' ('packed' | 'reorder' | 'soa' | 'align' '(' <integer> ')'))*
+   */
+  StructLayout parseStructAttributes();
+
+  /// Return true if the current token starts a struct attribute rather than
+  /// a function attribute. No tokens are consumed.
+  bool isStructAttribute();
+
+  /**
+   * Parses the type parameters of a generic function or struct. When an
+   * instance of the declaration is parsed, the parameters are consumed but
+   * not returned, since they are replaced by the type arguments.
+   *
+   * <type-params> := '[' <identifier> (',' <identifier>)* ']'
+   */
+  std::vector<Token> parseTypeParamList();
+
   /**
    *
    */
@@ -380,11 +455,11 @@ public:
    * directly, but instead defers all handling of newlines to the parsing of
    * specific statement types.
    *
-   * The statement may be a ReturnStmt, a CompoundStmt, WhileLoop,
+   * The statement may be a ReturnStmt, a CompoundStmt, WhileLoop, ForLoop,
    * ConditionalStmtList, a DeclStmt, or an ExprStmt.
    *
-   * <stmt> := <return-stmt> | <while-loop> | <conditional-stmt-list> |
-               <decl-stmt> | <expr-stmt>
+   * <stmt> := <return-stmt> | <while-loop> | <for-loop> |
+               <conditional-stmt-list> | <decl-stmt> | <expr-stmt>
    *
    * Note: in parsing a ConditionalStmtList, one or more ConditionalStmts may
    *       be parsed. The must be parsed as a single block to ensure logical
@@ -430,6 +505,15 @@ public:
    */
   std::unique_ptr<CompoundStmt> parseCompoundStmt();
 
+  /**
+   * Parses a statement starting with an attribute, which is either a block
+   * with its own allocator, or a function declaration with attributes.
+   *
+   * <attributed-stmt> := '@' ('arena' | 'pool') <compound-stmt>
+   *                    | <func-decl>
+   */
+  std::unique_ptr<Stmt> parseAttributedStmt();
+
   /**
    * Parses a while loop from the token stream. The while statement consists
    * of a keyword, 'while', a conditional expression, and a block statment.
@@ -440,6 +524,29 @@ public:
    */
   std::unique_ptr<WhileLoop> parseWhileLoop();
 
+  /**
+   * Parses a for loop from the token stream. The for statement consists of
+   * the keyword 'for', the name of the loop variable, the keyword 'in', either
+   * a range or a sequence expression, and a block statement. The for loop may
+   * not be preceded by a newline in the input stream.
+   *
+   * A loop over a range may be parallel, in which case it may be followed by
+   * the variables which the threads of the loop reduce.
+   *
+   * <for-loop> := 'for' <identifier> 'in' <expr> '..' <expr> <compound-stmt> |
+   *               'for' <identifier> 'in' <expr> <compound-stmt> |
+   *               'parallel' 'for' <identifier> 'in' <expr> '..' <expr> <reduction-clause>? <compound-stmt>
+   */
+  std::unique_ptr<ForLoop> parseForLoop();
+
+  /**
+   * Parses the reductions of a parallel loop, if there are any.
+   *
+   * <reduction-clause> := 'reduce' '(' <reduction> (',' <reduction>)* ')'
+   * <reduction> := ('+' | '*' | 'min' | 'max') ':' <identifier>
+   */
+  std::vector<Reduction> parseReductionClause();
+
   /**
    * Parses a conditional statment from the input stream. The conditional
    * statement may not be preceded by a newline character, and will not consume
@@ -474,6 +581,28 @@ public:
    */
    std::unique_ptr<ConditionalBlock> parseConditionalBlock();
 
+  /**
+   * Parses a match statement, which compares a value against the values of
+   * each case, and ends with an optional else case. Newlines between the cases
+   * are skipped. The match statement may not be preceded by a newline, and
+   * will not consume the newline that follows it.
+   *
+   * <match-stmt> := 'match' <expr> '{' <match-case>* ('else' <case-block>)? '}'
+   * <match-case> := 'case' <expr> (',' <expr>)* <case-block>
+   *
+   * Note: the values must be constants of the type of the matched value, which
+   *       is checked during semantic analysis.
+   */
+  std::unique_ptr<MatchStmt> parseMatchStmt();
+
+  /**
+   * Parses the block of a case, which may be a single statement following
+   * 'then', as in a conditional statement.
+   *
+   * <case-block> := <compound-stmt> | 'then' <stmt>
+   */
+  std::unique_ptr<CompoundStmt> parseCaseBlock();
+
   /**
    * Parses as many stmts as possible from the input stream. It will stop
    * parsing stmts when it reaches a stmt-list terminator. The two possible
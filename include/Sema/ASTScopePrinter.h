@@ -53,6 +53,13 @@ public:
     }
     return true;
   }
+  bool visitForLoop(ForLoop& tree) override {
+    os << "---------- " << "loop" << " ----------" << std::endl;
+    for (auto pair: tree.getDeclContext()->getDeclMap()) {
+      os << pair.first << ": " << pair.second->getType()->toString() << std::endl;
+    }
+    return true;
+  }
 };
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef SEMA_BOUNDS_CHECK_ELIMINATOR_H
+#define SEMA_BOUNDS_CHECK_ELIMINATOR_H
+
+#include <set>
+
+/*
+ * This class proves that element accesses inside of counted loops are within
+ * the bounds of the accessed aggregate, and marks them so that codegen can
+ * omit their runtime bounds checks. The recognized pattern is
+ *
+ *   var i: i64 = 0
+ *   while i < len(s) {
+ *     s[i] ...
+ *     i = i + 1
+ *   }
+ *
+ * An access s[i] in the loop body is in bounds if it is reached before any
+ * assignment to i in the body, if i can never be negative, and if the length
+ * of s can not change while the loop runs. The same holds for the whole body
+ * of a counted loop
+ *
+ *   for i in 0..len(s) {
+ *     s[i] ...
+ *   }
+ *
+ * since its loop variable can not be assigned.
+ */
+class BoundsCheckEliminator {
+private:
+  /// Variables which are never negative throughout the function. These are
+  /// variables initialized with an integer literal which are only ever
+  /// incremented by one and are never referenced.
+  std::set<const class Decl*> induction_variables_;
+
+  void findInductionVariables(class FuncDecl& func);
+  void eliminateInElement(class TreeElement& element);
+  void eliminateInLoop(class WhileLoop& loop);
+  void eliminateInLoop(class ForLoop& loop);
+  void markAccesses(class TreeElement& element, const class Decl *aggregate, const class Decl *index);
+
+public:
+  /// Marks all provably in bounds element accesses in the given function.
+  /// The function must already be fully type checked.
+  void eliminate(class FuncDecl& func);
+};
+
+#endif
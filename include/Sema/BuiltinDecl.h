@@ -38,5 +38,27 @@ public:
   static BasicDecl int_to_double;
   static BasicDecl double_to_int;
 
+  /// Declares the arithmetic and comparison operators of the sized integer
+  /// and floating point types, e.g. 'u8' and 'f32', in the given context. The
+  /// operators of 'i64' and 'f64' are declared individually above.
+  static void addSizedOperators(DeclContext *context);
+
+  /// Declares the bitwise and shift operators '&', '|', '^', '~', '<<' and
+  /// '>>' of all integer types in the given context.
+  static void addBitwiseOperators(DeclContext *context);
+
+  /// Declares the logical operators '&&' and '||' of booleans in the given
+  /// context. Codegen short circuits them.
+  static void addLogicalOperators(DeclContext *context);
+
+  /// Declares the intrinsics, i.e. builtin functions which are lowered to
+  /// single LLVM intrinsics or instructions rather than called, such as
+  /// 'popcount', 'sqrt' or 'min', for all types they apply to. 'prefetch'
+  /// takes any reference and is checked structurally instead.
+  static void addIntrinsics(DeclContext *context);
+
+  /// Returns true if the name is the name of an intrinsic.
+  static bool isIntrinsic(StringRef name);
+
 };
 #endif
@@ -0,0 +1,72 @@
+#ifndef SEMA_CONST_EVALUATOR_H
+#define SEMA_CONST_EVALUATOR_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "AST/ConstantValue.h"
+
+/*
+ * This class computes the values of constants at compile time by interpreting
+ * the type checked AST. Besides literals, operators and other constants, an
+ * initializer may call functions declared before it, such as
+ *
+ *   func square(x: i64) -> i64 {
+ *     return x * x
+ *   }
+ *   const area: i64 = square(12)
+ *
+ * The called functions may use local bindings, arrays, loops, conditionals,
+ * intrinsics and other functions, but no references, slices, maps or extern
+ * functions. Integers wrap around at their bit width, as they do at runtime.
+ * Evaluation throws a CompilerException if it encounters anything else,
+ * divides by zero, accesses an array out of bounds, or takes too many steps.
+ */
+class ConstEvaluator {
+private:
+  /// The local bindings of each function being evaluated, innermost last
+  std::vector<std::map<const class Decl*, ConstantValue>> frames_;
+
+  /// The value returned by the innermost function, once it has returned
+  ConstantValue result_;
+  bool returned_ = false;
+
+  /// Number of statements executed so far, which is limited so that
+  /// compilation terminates
+  uint64_t steps_ = 0;
+
+  /// The location of the evaluated initializer, at which evaluations which
+  /// do not terminate are reported
+  const char* location_ = nullptr;
+
+  const ConstantValue& evaluateIdentifierExpr(class IdentifierExpr& expr);
+  ConstantValue evaluateUnaryExpr(class UnaryExpr& expr);
+  ConstantValue evaluateBinaryExpr(class BinaryExpr& expr);
+  ConstantValue evaluateAssignment(class BinaryExpr& expr);
+  ConstantValue evaluateIndex(class AccessorExpr& expr);
+  ConstantValue evaluateAccessorExpr(class AccessorExpr& expr);
+  ConstantValue evaluateFunctionCall(class FunctionCall& call);
+  ConstantValue evaluateIntrinsic(class FunctionCall& call, const std::vector<ConstantValue>& args);
+  ConstantValue callFunction(const class FuncDecl& func, std::vector<ConstantValue> args, const char* location);
+
+  /// Return the storage of an assignable expression, i.e. a local binding or
+  /// an element or member of one
+  ConstantValue& evaluateLocation(class Expr& expr);
+
+  /// Count a statement or loop iteration against the step limit
+  void countStep();
+
+  void execute(class Stmt& stmt);
+  void executeBlock(class CompoundStmt& block);
+
+public:
+  /// Return the value of the type checked expression
+  ConstantValue evaluate(class Expr& expr);
+
+  /// Return the integer of the given type with the low bits of value, which
+  /// are extended according to the signedness of the type
+  static ConstantValue getInteger(class Type* type, uint64_t value);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SEMA_EFFECT_ANALYZER_H
+#define SEMA_EFFECT_ANALYZER_H
+
+#include <map>
+
+/*
+ * This class infers which memory a function accesses and how its reference
+ * and slice parameters are used, so that codegen can describe the function to
+ * the optimizer. Memory is only accessed through references and slices. An
+ * access is attributed to a parameter p if p is the aggregate of the access,
+ * as in
+ *
+ *   p.x = p.y + p[i]
+ *
+ * All other accesses through references and slices, and calls to functions
+ * which access memory, may touch any memory. A parameter escapes if it is
+ * used in any other way, e.g. passed to a function, returned, or referenced
+ * as in `&p.x`, since accesses through the copy can no longer be tracked.
+ */
+class EffectAnalyzer {
+private:
+  struct ParamUsage {
+    bool reads = false;
+    bool writes = false;
+    bool escapes = false;
+  };
+
+  /// Usage of the reference and slice parameters of the current function
+  std::map<const class Decl*, ParamUsage> params_;
+
+  /// Whether memory not attributable to a parameter is read or written
+  bool reads_unknown_ = false;
+  bool writes_unknown_ = false;
+
+  /// Whether the function is known to return, i.e. it has no while loops,
+  /// calls no function which might not return, and has no checks which might
+  /// trap. For loops have a finite trip count and always terminate.
+  bool will_return_ = true;
+
+  void analyzeElement(class TreeElement& element, class TreeElement* parent);
+  void analyzeAccess(class AccessorExpr& accessor, bool is_write);
+  void analyzeAssignmentTarget(class Expr& target);
+  void analyzeCall(class FunctionCall& call);
+  void markAccess(class Expr& aggregate, bool is_write);
+  void markCaptures(class TreeElement& element);
+
+public:
+  /// Annotates the function and its parameters with the inferred effects.
+  /// The function must already be fully type checked, and all functions it
+  /// calls must have been analyzed before. Calls to functions which have not
+  /// been analyzed yet, including recursive calls, are treated conservatively.
+  void analyze(class FuncDecl& func);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SEMA_GENERIC_INSTANTIATOR_H
+#define SEMA_GENERIC_INSTANTIATOR_H
+
+#include <vector>
+
+/*
+ * This class creates the instances of generic functions and structs. An
+ * instance is parsed again from the source of its generic declaration, with
+ * the type parameters replaced by the canonical type arguments, e.g.
+ *
+ *   func larger[T](a: T, b: T) -> T {
+ *     ...
+ *   }
+ *
+ * is parsed as a function `larger[i64]` with parameters of type i64 when it is
+ * called with two integers. Each instance is created, checked and compiled
+ * once per list of type arguments, and is cached by its generic declaration.
+ * The instance is added to the cache before it is checked, so that recursive
+ * uses of the declaration refer to the instance being checked.
+ */
+class GenericInstantiator {
+public:
+  /// Return the instance of the generic function for the canonical type
+  /// arguments, whose scope has been built and whose body has been checked
+  class FuncDecl& instantiate(class FuncDecl& generic, const std::vector<class Type*>& type_args);
+
+  /// Return the instance of the generic struct for the canonical type
+  /// arguments, whose member types have been resolved
+  class StructDecl& instantiate(class StructDecl& generic, const std::vector<class Type*>& type_args);
+};
+
+#endif
@@ -5,6 +5,10 @@ class ScopeBuilder {
 private:
   const class FuncDecl* function_;
 
+  /// Builds the scopes of the top level declarations of a unit, whose scope
+  /// is already parented
+  void buildUnitDeclScopes(class CompilationUnit&);
+
 public:
   /**
    * Recursively builds the lexical scope for the entire compilation
@@ -21,10 +25,24 @@ public:
    *    d. Calls buildFunctionScope.
    *
    * Note that because global declarations are processed linearly, functions
-   * and global variables must be declared before they are used.
+   * and global variables must be declared before they are used. Generic
+   * functions and structs are only added to the unit scope, and each of their
+   * instances is checked when it is first used.
    */
   void buildCompilationUnitScope(class CompilationUnit&);
 
+  /**
+   * Builds the scope of one of several compilation units of a program. The
+   * unit scope is parented to the program scope, and once the unit is built
+   * its top level declarations are added to the program scope, so that the
+   * units built after it may refer to them. Units are therefore built in the
+   * order of their dependencies, just as declarations within a unit are.
+   *
+   * A unit may declare the same extern function as an earlier unit, but any
+   * other declaration which is already in the program scope is an error.
+   */
+  void buildCompilationUnitScope(class CompilationUnit&, class DeclContext &program);
+
   /**
    * Recursively builds the lexical scope for the entire function.
    * The involves the following steps.
@@ -78,6 +96,38 @@ public:
    */
   void buildWhileLoopScope(class WhileLoop&);
 
+  /**
+   * Builds the lexical scope for a for loop with the following steps.
+   *
+   * 1. Type check the range bounds, which must be integers of the same
+   *    type, or the sequence, which must be an array, a reference to an
+   *    array, or a slice.
+   * 2. Infer the type of the loop variable and add it to the loop scope.
+   * 3. Parent block scope to loop scope.
+   * 4. Process block scope with buildBlockScope.
+   *
+   * The reductions of a parallel loop are checked before the loop variable
+   * is declared, and its body after it was processed.
+   */
+  void buildForLoopScope(class ForLoop&);
+
+  /// Checks that maps are only passed to the map builtins and to functions,
+  /// as the table of a map is freed when the block declaring it exits
+  void checkMapUses(class TreeElement& element, class TreeElement* parent);
+
+  /// Checks that every reduction of a parallel loop names a distinct integer
+  /// or floating point variable
+  void checkReductions(class ForLoop&);
+
+  /// Checks that the body of a parallel loop neither returns nor assigns to
+  /// variables declared outside of the loop, except for its reductions, and
+  /// only allocates within an allocator block of its own
+  void checkParallelBody(class TreeElement&, class ForLoop&, bool has_allocator);
+
+  /// Checks that expressions of atomic type are only referenced, as atomics
+  /// may only be accessed through the atomic builtins
+  void checkAtomicAccesses(class TreeElement& element, class TreeElement* parent);
+
   /**
    * Recursivly builds the lexical scope for a ConditionalStmt loop with
    * the following steps.
@@ -94,9 +144,23 @@ public:
    */
   void buildConditionalStmtScope(class ConditionalStmt&);
 
+  /**
+   * Builds the scopes of the cases of a match statement, after checking that
+   * the matched value is an integer or a character, and that the values of
+   * the cases are distinct constants of its type. The values are evaluated so
+   * that codegen can switch on them. A match without an else case must cover
+   * every value of its type, which is only possible for 8 bit types.
+   */
+  void buildMatchStmtScope(class MatchStmt&, class DeclContext *parent);
+
   void buildDeclScope(class Decl&);
 
   void buildLetDeclScope(class LetDecl&);
+
+  /// Type checks the initializer of the constant and evaluates it, so that
+  /// the constant may be used where a value is needed at compile time, such
+  /// as the size of an array type
+  void buildConstDeclScope(class ConstDecl&);
   void buildVarDeclScope(class VarDecl&);
   void buildUninitializedVarDeclScope(class UninitializedVarDecl&);
   void buildTypeAliasScope(class TypeAlias&);
@@ -0,0 +1,49 @@
+#ifndef SEMA_TAIL_CALL_ANALYZER_H
+#define SEMA_TAIL_CALL_ANALYZER_H
+
+/*
+ * This class finds the calls of a function which are in tail position, i.e.
+ * whose result is returned right away as in
+ *
+ *   return f(n - 1, acc * n)
+ *
+ * and marks them so that codegen can reuse the stack frame of the caller for
+ * the callee. A call is not a tail call if anything remains to be done after
+ * it returns, which is the case within an `@arena` or `@pool` block, whose
+ * allocator is popped after the call, or after the declaration of a map
+ * variable, whose table is freed after the call. Neither is it if one of its
+ * arguments may refer to the stack frame of the caller, e.g. a reference to a
+ * local variable, which would no longer exist during the call.
+ *
+ * A tail call to a function of the same type as the caller is guaranteed,
+ * since the callee receives its arguments and returns its result exactly as
+ * the caller does. Recursive calls of a function declared `@tailcall` must be
+ * guaranteed tail calls, so that the function runs in constant stack space.
+ */
+class TailCallAnalyzer {
+private:
+  class FuncDecl *function_ = nullptr;
+
+  /// The number of `@arena` and `@pool` blocks around the current statement
+  unsigned allocator_scopes_ = 0;
+
+  /// The number of map variables declared before the current statement whose
+  /// tables are freed when their block exits
+  unsigned owned_maps_ = 0;
+
+  void analyzeElement(class TreeElement& element);
+  void analyzeReturn(class ReturnStmt& stmt);
+  void checkRecursiveCalls(class TreeElement& element);
+
+  /// Returns true if the argument may refer to the stack frame of the current
+  /// function, which is then passed to a parameter of the given type
+  bool mayReferToFrame(class Expr& arg, class Type* param_type);
+
+public:
+  /// Marks the tail calls of the given function, which must already be fully
+  /// type checked. Throws a CompilerException if the function is declared
+  /// `@tailcall` and a recursive call can not be made as a tail call.
+  void analyze(class FuncDecl& func);
+};
+
+#endif
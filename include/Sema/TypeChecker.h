@@ -1,6 +1,11 @@
 #ifndef SEMA_TYPE_CHECKER
 #define SEMA_TYPE_CHECKER
 
+#include <map>
+#include <string>
+
+#include "Basic/SourceCode.h"
+
 /**
  * The type checker uses the ASTScope to annotate every type with an
  * an expression. It uses a bottom up approach, which is necessary for
@@ -21,6 +26,15 @@ public:
    */
   bool is_implicitly_assignable_to(class Type *l, class Type *r);
 
+  /**
+   * Integer and floating point literals are typed as 'i64' and 'f64'. This
+   * method retypes an already checked literal, which may be negated, to the
+   * given integer or floating point type, so that e.g. `let x: u8 = 200` is
+   * valid. A literal whose value does not fit the type is an error. Returns
+   * true if the expression is a literal which was retyped.
+   */
+  bool convertLiteral(class Expr &expr, class Type *type);
+
   void checkExpr(class Expr &expr);
   void checkCharacterExpr(class CharacterExpr &expr);
   void checkStringExpr(class StringExpr &expr);
@@ -38,7 +52,54 @@ public:
   void checkBoolExpr(class BoolExpr &expr);
   void checkUnaryExpr(class UnaryExpr &expr);
   void checkBinaryExpr(class BinaryExpr &expr);
+
+  /// Return the result type of the builtin or overloaded binary operator
+  /// applied to operands of the given types. Operators apply lane-wise to
+  /// vectors. Throws if the operator is not defined for the operands.
+  class Type* resolveBinaryOperator(StringRef op, class Type *left_type, class Type *right_type);
   void checkFunctionCall(class FunctionCall &expr);
+  void checkLenCall(class FunctionCall &expr);
+
+  /// Return true if the name is one of the builtins which operate on vectors,
+  /// e.g. splat, shuffle, select, load, store and the reductions
+  static bool isVectorBuiltin(StringRef name);
+  void checkVectorBuiltin(class FunctionCall &expr);
+
+  /// Return true if the name is one of the builtins which operate on maps,
+  /// i.e. insert, find, contains and erase
+  static bool isMapBuiltin(StringRef name);
+  void checkMapBuiltin(class FunctionCall &expr);
+
+  /// Return true if the name is one of the builtins which allocate or free
+  /// heap memory, i.e. new, alloc and free
+  static bool isAllocationBuiltin(StringRef name);
+  void checkAllocationBuiltin(class FunctionCall &expr);
+
+  /// Return true if the name is one of the builtins which access atomics,
+  /// e.g. atomic_load, fetch_add or fence
+  static bool isAtomicBuiltin(StringRef name);
+  void checkAtomicBuiltin(class FunctionCall &expr);
+
+  /// Checks an explicit conversion between integer and floating point types,
+  /// which is spelled as a call to the target type, e.g. `u8(x)` or `f32(x)`
+  void checkConversionCall(class FunctionCall &expr);
+
+  /// Checks a call to an intrinsic such as `popcount(x)` or `min(a, b)`. The
+  /// intrinsics are declared for each type in the global scope and apply
+  /// lane-wise to vectors.
+  void checkIntrinsicCall(class FunctionCall &expr);
+  void checkPrefetchCall(class FunctionCall &expr);
+
+  /// Checks a call to a generic function. The type arguments are inferred from
+  /// the types of the arguments, and the call refers to the instance of the
+  /// function for those type arguments, which is created if necessary.
+  void checkGenericCall(class FunctionCall &expr, class FuncDecl &generic);
+
+  /// Binds the type parameters which occur in the declared type of a parameter
+  /// of a generic function to the matching parts of the canonical type of the
+  /// argument, e.g. T to i64 for a parameter of type `[T]` and an argument of
+  /// type `&[i64, 4]`. Parameters which are already bound are left unchanged.
+  void inferTypeArgs(class Type *param_type, class Type *arg_type, std::map<std::string, class Type*> &bindings);
 
 };
 
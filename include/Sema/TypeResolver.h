@@ -22,7 +22,9 @@ public:
   void resolve(class TupleType& type);
   void resolve(class FunctionType& type);
   void resolve(class ListType& type);
+  void resolve(class VectorType& type);
   void resolve(class MapType& type);
+  void resolve(class AtomicType& type);
 };
 
 #endif
@@ -0,0 +1,96 @@
+// Compares the runtime hash map with std::unordered_map on 64 bit keys.
+//
+//   make bench && bin/map_bench [count]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../bulat_map.h"
+
+/// The hash the compiler emits for 64 bit keys
+static uint64_t hash(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+/// Hashes std::unordered_map keys the same way, so that both maps see the
+/// same distribution
+struct Hash {
+  size_t operator()(uint64_t key) const { return hash(key); }
+};
+
+template <typename F>
+static double measure(const char* name, size_t count, F f) {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t sum = f();
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() / count;
+  std::printf("  %-16s %8.2f ns/op  (%llu)\n", name, ns, (unsigned long long)sum);
+  return ns;
+}
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  std::mt19937_64 random{42};
+  std::vector<uint64_t> keys(count), misses(count);
+  for (auto& key : keys) key = random();
+  for (auto& key : misses) key = random();
+
+  std::printf("bulat_map\n");
+  bulat_map* map = __bulat_map_new(sizeof(uint64_t), alignof(uint64_t));
+  measure("insert", count, [&] {
+    for (size_t i = 0; i < count; i++) {
+      *static_cast<uint64_t*>(__bulat_map_insert(map, keys[i], hash(keys[i]))) = i;
+    }
+    return static_cast<uint64_t>(__bulat_map_len(map));
+  });
+  measure("find hit", count, [&] {
+    uint64_t sum = 0;
+    for (uint64_t key : keys) sum += *static_cast<uint64_t*>(__bulat_map_find(map, key, hash(key)));
+    return sum;
+  });
+  measure("find miss", count, [&] {
+    uint64_t sum = 0;
+    for (uint64_t key : misses) sum += __bulat_map_find(map, key, hash(key)) != nullptr;
+    return sum;
+  });
+  measure("erase", count, [&] {
+    uint64_t sum = 0;
+    for (uint64_t key : keys) sum += __bulat_map_erase(map, key, hash(key));
+    return sum;
+  });
+  __bulat_map_free(map);
+
+  std::printf("std::unordered_map\n");
+  std::unordered_map<uint64_t, uint64_t, Hash> std_map;
+  measure("insert", count, [&] {
+    for (size_t i = 0; i < count; i++) std_map[keys[i]] = i;
+    return static_cast<uint64_t>(std_map.size());
+  });
+  measure("find hit", count, [&] {
+    uint64_t sum = 0;
+    for (uint64_t key : keys) sum += std_map.find(key)->second;
+    return sum;
+  });
+  measure("find miss", count, [&] {
+    uint64_t sum = 0;
+    for (uint64_t key : misses) sum += std_map.find(key) != std_map.end();
+    return sum;
+  });
+  measure("erase", count, [&] {
+    uint64_t sum = 0;
+    for (uint64_t key : keys) sum += std_map.erase(key);
+    return sum;
+  });
+  return 0;
+}
@@ -0,0 +1,70 @@
+// Measures how a reduction over an array scales across the threads of the
+// parallel loop runtime, which is what a `parallel for` with a `reduce`
+// clause compiles to.
+//
+//   make bench && BULAT_THREADS=4 bin/parallel_bench [count]
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../bulat_parallel.h"
+
+/// The captured variables of the outlined loop body
+struct Context {
+  const double* values;
+  std::atomic<double>* total;
+};
+
+// Each chunk sums into a private total, which is added to the shared total
+// once, as the compiler does for `reduce(+: total)`
+static void body(void* context, int64_t begin, int64_t end) {
+  Context* captures = static_cast<Context*>(context);
+  double partial = 0.0;
+  for (int64_t i = begin; i < end; i++) {
+    partial += std::sqrt(captures->values[i]);
+  }
+  double current = captures->total->load();
+  while (!captures->total->compare_exchange_weak(current, current + partial)) {}
+}
+
+template <typename F>
+static double measure(const char* name, F f) {
+  auto start = std::chrono::steady_clock::now();
+  double result = f();
+  auto end = std::chrono::steady_clock::now();
+  double ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::printf("  %-16s %8.2f ms  (%.6e)\n", name, ms, result);
+  return ms;
+}
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000000;
+  std::vector<double> values(count);
+  for (size_t i = 0; i < count; i++) values[i] = (double)(i % 1000);
+
+  std::printf("sum of square roots of %zu doubles on %lld threads\n",
+              count, (long long)__bulat_parallel_threads());
+
+  double serial = measure("serial", [&] {
+    std::atomic<double> total{0.0};
+    Context context{values.data(), &total};
+    body(&context, 0, (int64_t)count);
+    return total.load();
+  });
+
+  // the first loop wakes the pool, so the second is measured
+  for (int run = 0; run < 2; run++) {
+    double parallel = measure("parallel", [&] {
+      std::atomic<double> total{0.0};
+      Context context{values.data(), &total};
+      __bulat_parallel_for(0, (int64_t)count, body, &context);
+      return total.load();
+    });
+    if (run == 1) std::printf("  speedup %.2fx\n", serial / parallel);
+  }
+}
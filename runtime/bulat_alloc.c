@@ -0,0 +1,254 @@
+// posix_memalign
+#define _POSIX_C_SOURCE 200112L
+
+#include "bulat_alloc.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// The size of the chunks which arenas allocate from. Released chunks of this
+/// size are cached per thread, so that an arena which is pushed and popped
+/// for every request does not call malloc once it is warm.
+#define CHUNK_SIZE (64 * 1024)
+#define MAX_CACHED_CHUNKS 16
+
+/// Allocations larger than this get a chunk of their own, so that the rest of
+/// the current chunk is not abandoned
+#define MAX_BUMP_SIZE (CHUNK_SIZE / 4)
+
+/// The size classes of pools are the powers of two from 16 to 256 bytes
+#define MIN_CLASS_SHIFT 4
+#define CLASS_COUNT 5
+#define MAX_CLASS_SIZE (1u << (MIN_CLASS_SHIFT + CLASS_COUNT - 1))
+
+/// The allocator on top of the stack of the thread, or NULL for malloc
+static _Thread_local bulat_allocator* current = NULL;
+
+//===----------------------------------------------------------------------===//
+// Malloc
+//===----------------------------------------------------------------------===//
+
+static void* malloc_aligned(uint64_t size, uint64_t align) {
+  void* memory = NULL;
+  if (align <= _Alignof(max_align_t)) {
+    memory = malloc(size ? size : 1);
+  } else if (posix_memalign(&memory, align, size ? size : 1) != 0) {
+    memory = NULL;
+  }
+  if (!memory) abort();
+  return memory;
+}
+
+//===----------------------------------------------------------------------===//
+// Arena
+//===----------------------------------------------------------------------===//
+
+typedef struct chunk {
+  struct chunk* next;
+
+  /// The number of usable bytes after the header
+  uint64_t size;
+} chunk;
+
+/// An arena lives at the start of its first chunk
+typedef struct {
+  bulat_allocator base;
+
+  /// The chunks of the arena, the one which is bumped first
+  chunk* chunks;
+  char* ptr;
+  char* end;
+} arena;
+
+static _Thread_local chunk* cached_chunks = NULL;
+static _Thread_local int cached_chunk_count = 0;
+
+static char* chunk_data(chunk* c) {
+  return (char*)(c + 1);
+}
+
+static chunk* new_chunk(uint64_t size) {
+  if (size <= CHUNK_SIZE && cached_chunks) {
+    chunk* c = cached_chunks;
+    cached_chunks = c->next;
+    cached_chunk_count--;
+    return c;
+  }
+  if (size < CHUNK_SIZE) size = CHUNK_SIZE;
+  chunk* c = malloc_aligned(sizeof(chunk) + size, _Alignof(max_align_t));
+  c->size = size;
+  return c;
+}
+
+static void release_chunk(chunk* c) {
+  if (c->size == CHUNK_SIZE && cached_chunk_count < MAX_CACHED_CHUNKS) {
+    c->next = cached_chunks;
+    cached_chunks = c;
+    cached_chunk_count++;
+  } else {
+    free(c);
+  }
+}
+
+static char* align_up(char* ptr, uint64_t align) {
+  return (char*)(((uintptr_t)ptr + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+static void* arena_alloc(bulat_allocator* self, uint64_t size, uint64_t align) {
+  arena* a = (arena*)self;
+  char* ptr = align_up(a->ptr, align);
+  if (ptr + size <= a->end) {
+    a->ptr = ptr + size;
+    return ptr;
+  }
+
+  chunk* c = new_chunk(size + align);
+  if (size > MAX_BUMP_SIZE) {
+    // the chunk is linked behind the bumped chunk, which stays current
+    c->next = a->chunks->next;
+    a->chunks->next = c;
+    return align_up(chunk_data(c), align);
+  }
+  c->next = a->chunks;
+  a->chunks = c;
+  ptr = align_up(chunk_data(c), align);
+  a->ptr = ptr + size;
+  a->end = chunk_data(c) + c->size;
+  return ptr;
+}
+
+// only the most recent allocation can be reclaimed
+static void arena_free(bulat_allocator* self, void* ptr, uint64_t size, uint64_t align) {
+  arena* a = (arena*)self;
+  (void)align;
+  if ((char*)ptr + size == a->ptr) a->ptr = ptr;
+}
+
+static void arena_release(bulat_allocator* self) {
+  // the arena itself is released with its first chunk, which is last
+  chunk* c = ((arena*)self)->chunks;
+  while (c) {
+    chunk* next = c->next;
+    release_chunk(c);
+    c = next;
+  }
+}
+
+// Return a new arena of the given size, which starts out with its first chunk
+static arena* new_arena(uint64_t size) {
+  chunk* c = new_chunk(size);
+  c->next = NULL;
+  arena* a = (arena*)chunk_data(c);
+  a->base.alloc = arena_alloc;
+  a->base.free = arena_free;
+  a->base.release = arena_release;
+  a->base.parent = NULL;
+  a->chunks = c;
+  a->ptr = chunk_data(c) + size;
+  a->end = chunk_data(c) + c->size;
+  return a;
+}
+
+//===----------------------------------------------------------------------===//
+// Pool
+//===----------------------------------------------------------------------===//
+
+typedef struct free_block {
+  struct free_block* next;
+} free_block;
+
+/// A pool is an arena with a free list per size class
+typedef struct {
+  arena arena;
+  free_block* free_lists[CLASS_COUNT];
+} pool;
+
+// Return the size class of small allocations, or -1 for large ones
+static int size_class(uint64_t size, uint64_t align) {
+  if (size > MAX_CLASS_SIZE || align > (1u << MIN_CLASS_SHIFT)) return -1;
+  if (size <= (1u << MIN_CLASS_SHIFT)) return 0;
+  return 64 - __builtin_clzll(size - 1) - MIN_CLASS_SHIFT;
+}
+
+static void* pool_alloc(bulat_allocator* self, uint64_t size, uint64_t align) {
+  pool* p = (pool*)self;
+  int c = size_class(size, align);
+  if (c < 0) return arena_alloc(self, size, align);
+  free_block* block = p->free_lists[c];
+  if (block) {
+    p->free_lists[c] = block->next;
+    return block;
+  }
+  return arena_alloc(self, (uint64_t)1 << (c + MIN_CLASS_SHIFT), 1u << MIN_CLASS_SHIFT);
+}
+
+static void pool_free(bulat_allocator* self, void* ptr, uint64_t size, uint64_t align) {
+  pool* p = (pool*)self;
+  int c = size_class(size, align);
+  if (c < 0) {
+    arena_free(self, ptr, size, align);
+    return;
+  }
+  free_block* block = ptr;
+  block->next = p->free_lists[c];
+  p->free_lists[c] = block;
+}
+
+//===----------------------------------------------------------------------===//
+// Interface
+//===----------------------------------------------------------------------===//
+
+void* __bulat_alloc(uint64_t size, uint64_t align) {
+  if (!current) return malloc_aligned(size, align);
+  return current->alloc(current, size, align);
+}
+
+void* __bulat_alloc_array(uint64_t size, uint64_t align, int64_t count, const void* init) {
+  if (count < 0 || (size && (uint64_t)count > UINT64_MAX / size)) abort();
+  char* memory = __bulat_alloc(size * (uint64_t)count, align);
+
+  // zeroed elements are common enough to be set at once
+  const char* bytes = init;
+  uint64_t zeros = 0;
+  while (zeros < size && bytes[zeros] == 0) zeros++;
+  if (zeros == size) {
+    memset(memory, 0, size * (uint64_t)count);
+  } else {
+    for (int64_t i = 0; i < count; i++) memcpy(memory + i * size, init, size);
+  }
+  return memory;
+}
+
+void __bulat_free(void* ptr, uint64_t size, uint64_t align) {
+  if (!current) {
+    free(ptr);
+  } else {
+    current->free(current, ptr, size, align);
+  }
+}
+
+void __bulat_push_allocator(bulat_allocator* allocator) {
+  allocator->parent = current;
+  current = allocator;
+}
+
+void __bulat_pop_allocator(void) {
+  bulat_allocator* allocator = current;
+  if (!allocator) return;
+  current = allocator->parent;
+  if (allocator->release) allocator->release(allocator);
+}
+
+void __bulat_push_arena(void) {
+  arena* a = new_arena(sizeof(arena));
+  __bulat_push_allocator(&a->base);
+}
+
+void __bulat_push_pool(void) {
+  pool* p = (pool*)new_arena(sizeof(pool));
+  p->arena.base.alloc = pool_alloc;
+  p->arena.base.free = pool_free;
+  memset(p->free_lists, 0, sizeof(p->free_lists));
+  __bulat_push_allocator(&p->arena.base);
+}
@@ -0,0 +1,64 @@
+#ifndef BULAT_ALLOC_H
+#define BULAT_ALLOC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The heap behind the `new`, `alloc` and `free` builtins. Every thread has a
+ * stack of allocators, and all allocations are served by the allocator on top
+ * of it, or by malloc if the stack is empty. A block marked `@arena` or `@pool`
+ * pushes a new allocator when it is entered and pops it when it is left, which
+ * releases everything allocated in the block at once:
+ *
+ *   arena  allocates by bumping a pointer, and only reclaims the most recent
+ *          allocation when it is freed
+ *   pool   keeps a free list per size class, so that freed blocks of up to
+ *          256 bytes are reused, and allocates larger blocks like an arena
+ *
+ * Programs may plug in their own allocators by pushing a bulat_allocator.
+ * Memory must be freed while the allocator which allocated it is current.
+ */
+typedef struct bulat_allocator bulat_allocator;
+
+struct bulat_allocator {
+  void* (*alloc)(bulat_allocator* self, uint64_t size, uint64_t align);
+  void (*free)(bulat_allocator* self, void* ptr, uint64_t size, uint64_t align);
+
+  /// Releases all memory of the allocator when it is popped, or NULL
+  void (*release)(bulat_allocator* self);
+
+  /// The allocator which was current before this one was pushed
+  bulat_allocator* parent;
+};
+
+/// Return memory for size bytes with the given alignment, which must be a
+/// power of two. Aborts if memory can not be allocated.
+void* __bulat_alloc(uint64_t size, uint64_t align);
+
+/// Return memory for count elements of the given size and alignment, which
+/// are each initialized with a copy of the size bytes at init. Aborts if the
+/// count is negative or memory can not be allocated.
+void* __bulat_alloc_array(uint64_t size, uint64_t align, int64_t count, const void* init);
+
+/// Frees memory of the given size and alignment returned by __bulat_alloc
+void __bulat_free(void* ptr, uint64_t size, uint64_t align);
+
+/// Makes the allocator current until it is popped
+void __bulat_push_allocator(bulat_allocator* allocator);
+
+/// Releases the current allocator and makes its parent current again
+void __bulat_pop_allocator(void);
+
+/// Push a new arena or pool allocator
+void __bulat_push_arena(void);
+void __bulat_push_pool(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
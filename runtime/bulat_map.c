@@ -0,0 +1,244 @@
+#include "bulat_map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// The number of control bytes which are matched at once
+#define GROUP_WIDTH 16
+
+/// The control byte of a slot which has never been used
+#define CTRL_EMPTY ((int8_t)-128)
+
+/// The control byte of a slot whose key was erased. Lookups must probe past
+/// it, since the key they look for may have been inserted after it.
+#define CTRL_DELETED ((int8_t)-2)
+
+/// The control byte of a full slot is the low 7 bits of the hash of its key,
+/// and its position is derived from the remaining bits
+#define H1(hash) ((hash) >> 7)
+#define H2(hash) ((int8_t)((hash) & 0x7F))
+
+/// The key of a slot, along with its hash, which is needed to move the key
+/// when the table grows
+typedef struct {
+  uint64_t key;
+  uint64_t hash;
+} bulat_map_entry;
+
+struct bulat_map {
+  /// One control byte per slot, followed by a copy of the first GROUP_WIDTH
+  /// control bytes, so that a group can be loaded starting at any slot
+  int8_t* ctrl;
+  bulat_map_entry* entries;
+  char* values;
+
+  /// The number of slots, which is zero or a power of two of at least
+  /// GROUP_WIDTH
+  uint64_t capacity;
+  uint64_t size;
+
+  /// The number of empty slots which may still be filled before the table is
+  /// rehashed, which keeps at least one in eight slots empty
+  uint64_t growth_left;
+
+  uint64_t value_size;
+  uint64_t value_align;
+
+  /// The distance between consecutive values, i.e. their size rounded up to
+  /// their alignment
+  uint64_t value_stride;
+};
+
+//===----------------------------------------------------------------------===//
+// Groups
+//===----------------------------------------------------------------------===//
+
+// Each function returns a bit mask with bit i set if control byte i of the
+// group starting at ctrl matches.
+
+#if defined(__SSE2__)
+
+static inline uint32_t match_byte(const int8_t* ctrl, int8_t byte) {
+  __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(byte), group));
+}
+
+// empty and deleted are the only negative control bytes below -1
+static inline uint32_t match_empty_or_deleted(const int8_t* ctrl) {
+  __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), group));
+}
+
+#else
+
+static inline uint32_t match_byte(const int8_t* ctrl, int8_t byte) {
+  uint32_t mask = 0;
+  for (int i = 0; i < GROUP_WIDTH; i++) {
+    if (ctrl[i] == byte) mask |= 1u << i;
+  }
+  return mask;
+}
+
+static inline uint32_t match_empty_or_deleted(const int8_t* ctrl) {
+  uint32_t mask = 0;
+  for (int i = 0; i < GROUP_WIDTH; i++) {
+    if (ctrl[i] < -1) mask |= 1u << i;
+  }
+  return mask;
+}
+
+#endif
+
+static inline uint32_t match_empty(const int8_t* ctrl) {
+  return match_byte(ctrl, CTRL_EMPTY);
+}
+
+//===----------------------------------------------------------------------===//
+// Slots
+//===----------------------------------------------------------------------===//
+
+static inline void* value_at(const bulat_map* map, uint64_t slot) {
+  return map->values + slot * map->value_stride;
+}
+
+static inline void set_ctrl(bulat_map* map, uint64_t slot, int8_t byte) {
+  map->ctrl[slot] = byte;
+  if (slot < GROUP_WIDTH) map->ctrl[map->capacity + slot] = byte;
+}
+
+static void* allocate(uint64_t size, uint64_t align) {
+  void* memory = NULL;
+  if (align < sizeof(void*)) align = sizeof(void*);
+  // at least one byte is allocated, so that values of size zero have a
+  // valid address
+  if (posix_memalign(&memory, align, size ? size : 1) != 0) abort();
+  return memory;
+}
+
+// Groups are probed at triangular offsets from the position of the hash,
+// which visits every group once since the number of slots is a power of two.
+// Return the first empty or deleted slot of the probe sequence of the hash.
+static uint64_t find_insert_slot(const bulat_map* map, uint64_t hash) {
+  uint64_t mask = map->capacity - 1;
+  uint64_t pos = H1(hash) & mask;
+  for (uint64_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+    uint32_t match = match_empty_or_deleted(map->ctrl + pos);
+    if (match) return (pos + (uint64_t)__builtin_ctz(match)) & mask;
+    pos = (pos + step) & mask;
+  }
+}
+
+// Moves all keys into a table of the given capacity, which drops the deleted
+// slots
+static void resize(bulat_map* map, uint64_t capacity) {
+  int8_t* old_ctrl = map->ctrl;
+  bulat_map_entry* old_entries = map->entries;
+  char* old_values = map->values;
+  uint64_t old_capacity = map->capacity;
+
+  map->ctrl = allocate(capacity + GROUP_WIDTH, GROUP_WIDTH);
+  map->entries = allocate(capacity * sizeof(bulat_map_entry), sizeof(bulat_map_entry));
+  map->values = allocate(capacity * map->value_stride, map->value_align);
+  map->capacity = capacity;
+  map->growth_left = capacity - capacity / 8 - map->size;
+  memset(map->ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+
+  for (uint64_t slot = 0; slot < old_capacity; slot++) {
+    if (old_ctrl[slot] < 0) continue;
+    uint64_t new_slot = find_insert_slot(map, old_entries[slot].hash);
+    set_ctrl(map, new_slot, old_ctrl[slot]);
+    map->entries[new_slot] = old_entries[slot];
+    memcpy(value_at(map, new_slot), old_values + slot * map->value_stride, map->value_size);
+  }
+
+  free(old_ctrl);
+  free(old_entries);
+  free(old_values);
+}
+
+// Return the slot of the key, or capacity if it is not in the map
+static uint64_t find_slot(const bulat_map* map, uint64_t key, uint64_t hash) {
+  if (map->size == 0) return map->capacity;
+  uint64_t mask = map->capacity - 1;
+  uint64_t pos = H1(hash) & mask;
+  for (uint64_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+    const int8_t* group = map->ctrl + pos;
+    for (uint32_t match = match_byte(group, H2(hash)); match; match &= match - 1) {
+      uint64_t slot = (pos + (uint64_t)__builtin_ctz(match)) & mask;
+      if (map->entries[slot].key == key) return slot;
+    }
+    // the key would have been inserted into an empty slot of this group
+    if (match_empty(group)) return map->capacity;
+    pos = (pos + step) & mask;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Interface
+//===----------------------------------------------------------------------===//
+
+bulat_map* __bulat_map_new(uint64_t value_size, uint64_t value_align) {
+  bulat_map* map = allocate(sizeof(bulat_map), _Alignof(bulat_map));
+  memset(map, 0, sizeof(bulat_map));
+  map->value_size = value_size;
+  map->value_align = value_align ? value_align : 1;
+  map->value_stride = (value_size + map->value_align - 1) / map->value_align * map->value_align;
+  return map;
+}
+
+void __bulat_map_free(bulat_map* map) {
+  if (!map) return;
+  free(map->ctrl);
+  free(map->entries);
+  free(map->values);
+  free(map);
+}
+
+void* __bulat_map_find(const bulat_map* map, uint64_t key, uint64_t hash) {
+  uint64_t slot = find_slot(map, key, hash);
+  return slot == map->capacity ? NULL : value_at(map, slot);
+}
+
+void* __bulat_map_insert(bulat_map* map, uint64_t key, uint64_t hash) {
+  uint64_t slot = find_slot(map, key, hash);
+  if (slot != map->capacity) return value_at(map, slot);
+
+  if (map->growth_left == 0) {
+    // a table which is mostly deleted slots is rehashed at the same capacity
+    uint64_t capacity = map->capacity;
+    if (capacity == 0) {
+      capacity = GROUP_WIDTH;
+    } else if (map->size >= capacity / 2) {
+      capacity *= 2;
+    }
+    resize(map, capacity);
+  }
+
+  slot = find_insert_slot(map, hash);
+  // reusing a deleted slot does not reduce the number of empty slots
+  if (map->ctrl[slot] == CTRL_EMPTY) map->growth_left--;
+  set_ctrl(map, slot, H2(hash));
+  map->entries[slot].key = key;
+  map->entries[slot].hash = hash;
+  map->size++;
+
+  void* value = value_at(map, slot);
+  memset(value, 0, map->value_size);
+  return value;
+}
+
+bool __bulat_map_erase(bulat_map* map, uint64_t key, uint64_t hash) {
+  uint64_t slot = find_slot(map, key, hash);
+  if (slot == map->capacity) return false;
+  set_ctrl(map, slot, CTRL_DELETED);
+  map->size--;
+  return true;
+}
+
+int64_t __bulat_map_len(const bulat_map* map) {
+  return (int64_t)map->size;
+}
@@ -0,0 +1,55 @@
+#ifndef BULAT_MAP_H
+#define BULAT_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The hash map behind the map types of the language, e.g. `[i64: f64]`. It
+ * is an open addressing table in the style of SwissTable. Besides the keys
+ * and values, the table stores one control byte per slot, which is either
+ * empty, deleted, or the low 7 bits of the hash of the key in the slot. A
+ * lookup compares the control bytes of a group of 16 slots at once with SIMD
+ * instructions, so that keys are only compared in the few slots whose control
+ * byte matches.
+ *
+ * Keys are integers, characters or booleans, which the compiler passes as
+ * their bits zero extended to 64 bits, along with their hash. The hash
+ * function is chosen by the compiler for each key type, so the table never
+ * hashes itself. Values are copied in and out of the table as raw bytes of the
+ * size given when the map is created.
+ */
+typedef struct bulat_map bulat_map;
+
+/// Return a new empty map whose values have the given size and alignment.
+/// Aborts if memory can not be allocated.
+bulat_map* __bulat_map_new(uint64_t value_size, uint64_t value_align);
+
+/// Frees the map and all of its entries
+void __bulat_map_free(bulat_map* map);
+
+/// Return a pointer to the value of the key, or NULL if the key is not in
+/// the map. The pointer is valid until the next insertion.
+void* __bulat_map_find(const bulat_map* map, uint64_t key, uint64_t hash);
+
+/// Return a pointer to the value of the key, which is inserted with a zeroed
+/// value if it is not in the map yet. The pointer is valid until the next
+/// insertion. Aborts if memory can not be allocated.
+void* __bulat_map_insert(bulat_map* map, uint64_t key, uint64_t hash);
+
+/// Removes the key from the map. Returns true if the key was in the map.
+bool __bulat_map_erase(bulat_map* map, uint64_t key, uint64_t hash);
+
+/// Return the number of keys in the map
+int64_t __bulat_map_len(const bulat_map* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
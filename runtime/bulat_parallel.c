@@ -0,0 +1,236 @@
+// pthread_setaffinity_np, sched_getaffinity
+#define _GNU_SOURCE
+
+#include "bulat_parallel.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/// The most threads a pool may have
+#define MAX_THREADS 256
+
+/// Every thread starts out with this many chunks, so that threads which
+/// finish early have chunks left to steal
+#define CHUNKS_PER_THREAD 8
+
+/// Loops with fewer iterations than this run on the calling thread, since
+/// waking the pool costs more than it saves
+#define MIN_PARALLEL_ITERATIONS 2
+
+/// How often a thread checks for a new loop before it goes to sleep
+#define SPIN_COUNT 4096
+
+/// The chunks [next, end) of a thread, packed into one word so that the owner
+/// and thieves can take chunks with a single compare and swap. The owner takes
+/// chunks from the front, and thieves take the back half.
+typedef struct {
+  _Alignas(64) _Atomic uint64_t range;
+} chunk_queue;
+
+#define RANGE(next, end) (((uint64_t)(end) << 32) | (uint64_t)(next))
+#define RANGE_NEXT(range) ((uint32_t)(range))
+#define RANGE_END(range) ((uint32_t)((range) >> 32))
+
+static struct {
+  int threads;
+  chunk_queue queues[MAX_THREADS];
+
+  /// Serializes loops started by different threads of the program
+  pthread_mutex_t loop_lock;
+
+  /// Workers sleep until the generation changes, which starts a new loop
+  pthread_mutex_t wake_lock;
+  pthread_cond_t wake;
+  _Atomic uint64_t generation;
+
+  /// The number of workers which have not finished the current loop
+  _Atomic int active;
+
+  /// The current loop, which is written before the generation changes
+  bulat_parallel_body body;
+  void* context;
+  int64_t begin;
+  int64_t end;
+  int64_t chunk_size;
+} pool = {
+  .loop_lock = PTHREAD_MUTEX_INITIALIZER,
+  .wake_lock = PTHREAD_MUTEX_INITIALIZER,
+  .wake = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+/// Whether the thread runs a parallel loop, in which case loops it starts
+/// run serially
+static _Thread_local bool in_parallel = false;
+
+//===----------------------------------------------------------------------===//
+// Chunks
+//===----------------------------------------------------------------------===//
+
+static void run_chunk(uint32_t chunk) {
+  int64_t begin = pool.begin + (int64_t)chunk * pool.chunk_size;
+  int64_t end = pool.end - begin > pool.chunk_size ? begin + pool.chunk_size : pool.end;
+  pool.body(pool.context, begin, end);
+}
+
+// Take the next chunk of the queue of the thread
+static bool pop_chunk(chunk_queue* queue, uint32_t* chunk) {
+  uint64_t range = atomic_load_explicit(&queue->range, memory_order_acquire);
+  while (RANGE_NEXT(range) < RANGE_END(range)) {
+    uint64_t rest = RANGE(RANGE_NEXT(range) + 1, RANGE_END(range));
+    if (atomic_compare_exchange_weak(&queue->range, &range, rest)) {
+      *chunk = RANGE_NEXT(range);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Take the back half of the chunks of another thread. The first stolen chunk
+// is returned, and the others are moved to the queue of the thief, which is
+// empty, so that they can be stolen in turn.
+static bool steal_chunks(int thief, uint32_t* chunk) {
+  for (int distance = 1; distance < pool.threads; distance++) {
+    chunk_queue* victim = &pool.queues[(thief + distance) % pool.threads];
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_acquire);
+    while (RANGE_NEXT(range) < RANGE_END(range)) {
+      uint32_t next = RANGE_NEXT(range);
+      uint32_t end = RANGE_END(range);
+      uint32_t middle = next + (end - next) / 2;
+      if (atomic_compare_exchange_weak(&victim->range, &range, RANGE(next, middle))) {
+        atomic_store_explicit(&pool.queues[thief].range, RANGE(middle + 1, end), memory_order_release);
+        *chunk = middle;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static void run_chunks(int thread) {
+  uint32_t chunk;
+  while (pop_chunk(&pool.queues[thread], &chunk) || steal_chunks(thread, &chunk)) {
+    run_chunk(chunk);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Pool
+//===----------------------------------------------------------------------===//
+
+static void* worker_main(void* arg) {
+  int thread = (int)(intptr_t)arg;
+  in_parallel = true;
+
+  uint64_t seen = 0;
+  for (;;) {
+    uint64_t generation = atomic_load_explicit(&pool.generation, memory_order_acquire);
+    for (int spin = 0; generation == seen && spin < SPIN_COUNT; spin++) {
+      generation = atomic_load_explicit(&pool.generation, memory_order_acquire);
+    }
+    if (generation == seen) {
+      pthread_mutex_lock(&pool.wake_lock);
+      while ((generation = atomic_load(&pool.generation)) == seen) {
+        pthread_cond_wait(&pool.wake, &pool.wake_lock);
+      }
+      pthread_mutex_unlock(&pool.wake_lock);
+    }
+    seen = generation;
+
+    run_chunks(thread);
+    atomic_fetch_sub_explicit(&pool.active, 1, memory_order_release);
+  }
+  return NULL;
+}
+
+// Pin the thread to the index-th CPU the process may run on
+static void pin_thread(pthread_t thread, const cpu_set_t* allowed, int index) {
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, allowed) || index-- > 0) continue;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // pinning is only a hint, so failures are ignored
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+    return;
+  }
+}
+
+static void start_pool(void) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  bool has_affinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+  int threads = has_affinity ? CPU_COUNT(&allowed) : 1;
+
+  const char* requested = getenv("BULAT_THREADS");
+  if (requested && atoi(requested) > 0) threads = atoi(requested);
+  if (threads > MAX_THREADS) threads = MAX_THREADS;
+  if (threads < 1) threads = 1;
+  pool.threads = threads;
+
+  // the thread which starts a loop is the first thread of the pool, so it is
+  // not pinned
+  for (int index = 1; index < threads; index++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, worker_main, (void*)(intptr_t)index) != 0) {
+      pool.threads = index;
+      break;
+    }
+    if (has_affinity && threads <= CPU_COUNT(&allowed)) pin_thread(thread, &allowed, index);
+    pthread_detach(thread);
+  }
+}
+
+int64_t __bulat_parallel_threads(void) {
+  pthread_once(&pool_once, start_pool);
+  return pool.threads;
+}
+
+void __bulat_parallel_for(int64_t begin, int64_t end, bulat_parallel_body body, void* context) {
+  if (end <= begin) return;
+  uint64_t iterations = (uint64_t)end - (uint64_t)begin;
+  int threads = (int)__bulat_parallel_threads();
+  if (in_parallel || threads == 1 || iterations < MIN_PARALLEL_ITERATIONS) {
+    body(context, begin, end);
+    return;
+  }
+
+  pthread_mutex_lock(&pool.loop_lock);
+
+  // the iterations are split into at most CHUNKS_PER_THREAD chunks per thread
+  uint64_t max_chunks = (uint64_t)threads * CHUNKS_PER_THREAD;
+  uint64_t chunk_size = iterations / max_chunks + (iterations % max_chunks != 0);
+  uint64_t chunks = iterations / chunk_size + (iterations % chunk_size != 0);
+
+  pool.body = body;
+  pool.context = context;
+  pool.begin = begin;
+  pool.end = end;
+  pool.chunk_size = (int64_t)chunk_size;
+  for (int thread = 0; thread < threads; thread++) {
+    uint64_t first = chunks * (uint64_t)thread / (uint64_t)threads;
+    uint64_t last = chunks * (uint64_t)(thread + 1) / (uint64_t)threads;
+    atomic_store_explicit(&pool.queues[thread].range, RANGE(first, last), memory_order_relaxed);
+  }
+  atomic_store_explicit(&pool.active, threads - 1, memory_order_relaxed);
+
+  pthread_mutex_lock(&pool.wake_lock);
+  atomic_fetch_add_explicit(&pool.generation, 1, memory_order_release);
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.wake_lock);
+
+  in_parallel = true;
+  run_chunks(0);
+  in_parallel = false;
+
+  // the workers may still run the last chunks they took
+  while (atomic_load_explicit(&pool.active, memory_order_acquire) > 0) {
+    sched_yield();
+  }
+
+  pthread_mutex_unlock(&pool.loop_lock);
+}
@@ -0,0 +1,43 @@
+#ifndef BULAT_PARALLEL_H
+#define BULAT_PARALLEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The thread pool behind `parallel for` loops. The compiler outlines the body
+ * of a parallel loop into a function which runs the iterations of a range,
+ * and passes it along with a pointer to the variables it captures.
+ *
+ * The range is split into chunks, and each thread of the pool starts out with
+ * a contiguous share of them, so that a loop which is run repeatedly over the
+ * same data hands the same part of it to the same thread. A thread which runs
+ * out of chunks steals half of the remaining chunks of another thread,
+ * starting with its neighbours. Threads are pinned to consecutive CPUs, which
+ * usually keeps neighbours on the same NUMA node.
+ *
+ * The pool is started by the first parallel loop. It has one thread per CPU
+ * the process may run on, including the thread which starts a loop, unless
+ * the BULAT_THREADS environment variable gives the number of threads. Loops
+ * started from within a parallel loop run on the calling thread.
+ */
+
+/// Runs the iterations [begin, end) of an outlined loop body
+typedef void (*bulat_parallel_body)(void* context, int64_t begin, int64_t end);
+
+/// Runs body over the range [begin, end) on the thread pool, and returns once
+/// all iterations are done
+void __bulat_parallel_for(int64_t begin, int64_t end, bulat_parallel_body body, void* context);
+
+/// Return the number of threads of the pool, which is started if it is not
+/// running yet
+int64_t __bulat_parallel_threads(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
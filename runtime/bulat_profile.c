@@ -0,0 +1,139 @@
+#include "bulat_profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/// The layout of the profile sections and of the .profraw file are taken from
+/// the LLVM the compiler is built with, so that they always match
+#include "llvm/ProfileData/InstrProfData.inc"
+
+typedef void* IntPtrT;
+
+enum ValueKind {
+#define VALUE_PROF_KIND(Enumerator, Value, Descr) Enumerator = Value,
+#include "llvm/ProfileData/InstrProfData.inc"
+};
+
+/// The record of an instrumented function in __llvm_prf_data
+typedef struct {
+#define INSTR_PROF_DATA(Type, LLVMType, Name, Initializer) Type Name;
+#include "llvm/ProfileData/InstrProfData.inc"
+} __attribute__((aligned(8))) profile_data;
+
+typedef struct {
+#define INSTR_PROF_RAW_HEADER(Type, Name, Initializer) Type Name;
+#include "llvm/ProfileData/InstrProfData.inc"
+} profile_header;
+
+// the bounds of the profile sections, which the linker defines if the program
+// has instrumented functions
+extern profile_data __start___llvm_prf_data[] __attribute__((weak, visibility("hidden")));
+extern profile_data __stop___llvm_prf_data[] __attribute__((weak, visibility("hidden")));
+extern uint64_t __start___llvm_prf_cnts[] __attribute__((weak, visibility("hidden")));
+extern uint64_t __stop___llvm_prf_cnts[] __attribute__((weak, visibility("hidden")));
+extern char __start___llvm_prf_names[] __attribute__((weak, visibility("hidden")));
+extern char __stop___llvm_prf_names[] __attribute__((weak, visibility("hidden")));
+
+// defined by instrumented modules, the latter only if a file is given to
+// --profile-generate
+extern const uint64_t __llvm_profile_raw_version __attribute__((weak));
+extern const char __llvm_profile_filename[] __attribute__((weak));
+
+int __llvm_profile_runtime;
+
+// Value profiling is not supported. The instrumentation calls these hooks
+// with the targets of indirect calls and the sizes of memory intrinsics, which
+// are dropped, so the profile has no value records and the optimizer neither
+// promotes indirect calls nor specializes memcpy and memset by size.
+void __llvm_profile_instrument_target(uint64_t value, void* data, uint32_t site) {}
+void __llvm_profile_instrument_memop(uint64_t value, void* data, uint32_t site) {}
+void __llvm_profile_instrument_range(uint64_t value, void* data, uint32_t site,
+                                     int64_t precise_start, int64_t precise_last, int64_t large_value) {}
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+static const char zeros[8];
+
+static uint64_t padding_to_8(uint64_t size) {
+  return (8 - size % 8) % 8;
+}
+
+// The header of the value profile record of a kind, padded to 8 bytes, which
+// is followed by no values
+static uint32_t value_record_size(uint32_t sites) {
+  return (uint32_t)(2 * sizeof(uint32_t) + sites + padding_to_8(sites));
+}
+
+// Every function with value sites is followed by their values in the file.
+// None are recorded, so each site has a count of zero.
+static void write_value_data(FILE* file, const profile_data* data) {
+  uint32_t kinds = 0;
+  uint32_t total_size = 2 * sizeof(uint32_t);
+  for (uint32_t kind = 0; kind <= IPVK_Last; kind++) {
+    if (data->NumValueSites[kind] == 0) continue;
+    kinds++;
+    total_size += value_record_size(data->NumValueSites[kind]);
+  }
+  if (kinds == 0) return;
+
+  fwrite(&total_size, sizeof(total_size), 1, file);
+  fwrite(&kinds, sizeof(kinds), 1, file);
+  for (uint32_t kind = 0; kind <= IPVK_Last; kind++) {
+    uint32_t sites = data->NumValueSites[kind];
+    if (sites == 0) continue;
+    fwrite(&kind, sizeof(kind), 1, file);
+    fwrite(&sites, sizeof(sites), 1, file);
+    for (uint32_t site = 0; site < sites; site++) fputc(0, file);
+    fwrite(zeros, 1, padding_to_8(sites), file);
+  }
+}
+
+static const char* profile_path(void) {
+  const char* path = getenv("LLVM_PROFILE_FILE");
+  if (path && *path) return path;
+  if (__llvm_profile_filename && *__llvm_profile_filename) return __llvm_profile_filename;
+  return "default.profraw";
+}
+
+// The header initializers of InstrProfData.inc refer to these names
+#define __llvm_profile_get_magic() (sizeof(void*) == 8 ? (INSTR_PROF_RAW_MAGIC_64) : (INSTR_PROF_RAW_MAGIC_32))
+#define __llvm_profile_get_version() \
+  (&__llvm_profile_raw_version ? __llvm_profile_raw_version : (INSTR_PROF_RAW_VERSION | VARIANT_MASK_IR_PROF))
+#define __llvm_write_binary_ids(writer) 0
+
+__attribute__((destructor))
+static void write_profile(void) {
+  const profile_data* DataBegin = __start___llvm_prf_data;
+  const uint64_t* CountersBegin = __start___llvm_prf_cnts;
+  const char* NamesBegin = __start___llvm_prf_names;
+  if (DataBegin == __stop___llvm_prf_data) return;
+
+  uint64_t DataSize = (uint64_t)(__stop___llvm_prf_data - DataBegin);
+  uint64_t CountersSize = (uint64_t)(__stop___llvm_prf_cnts - CountersBegin);
+  uint64_t NamesSize = (uint64_t)(__stop___llvm_prf_names - NamesBegin);
+  uint64_t PaddingBytesBeforeCounters = 0;
+  uint64_t PaddingBytesAfterCounters = 0;
+
+  profile_header header = {
+#define INSTR_PROF_RAW_HEADER(Type, Name, Initializer) Initializer,
+#include "llvm/ProfileData/InstrProfData.inc"
+  };
+
+  const char* path = profile_path();
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    fprintf(stderr, "profile: could not open %s\n", path);
+    return;
+  }
+  fwrite(&header, sizeof(header), 1, file);
+  fwrite(DataBegin, sizeof(profile_data), DataSize, file);
+  fwrite(CountersBegin, sizeof(uint64_t), CountersSize, file);
+  fwrite(NamesBegin, 1, NamesSize, file);
+  fwrite(zeros, 1, padding_to_8(NamesSize), file);
+  for (const profile_data* data = DataBegin; data != __stop___llvm_prf_data; data++) {
+    write_value_data(file, data);
+  }
+  if (fclose(file) != 0) fprintf(stderr, "profile: could not write %s\n", path);
+}
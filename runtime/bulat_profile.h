@@ -0,0 +1,40 @@
+#ifndef BULAT_PROFILE_H
+#define BULAT_PROFILE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The profile runtime of programs compiled with --profile-generate. LLVM's
+ * instrumentation places a record per function, its counters and its name in
+ * the __llvm_prf_data, __llvm_prf_cnts and __llvm_prf_names sections. When the
+ * program exits, the runtime writes the sections to a .profraw file in the
+ * raw profile format of the LLVM the compiler was built with, which
+ * `llvm-profdata merge` turns into a profile for --profile-use.
+ *
+ * The profile is written to the file named by the LLVM_PROFILE_FILE
+ * environment variable, or else to the file given to --profile-generate, or
+ * to default.profraw. A program which is killed by a signal writes nothing.
+ *
+ * Nothing in an instrumented program refers to the runtime, so it has to be
+ * pulled out of libbulat.a with -u __llvm_profile_runtime when linking.
+ */
+
+/// Defined so that linking with -u __llvm_profile_runtime includes the runtime
+extern int __llvm_profile_runtime;
+
+/// Value profiling of indirect call targets and memcpy sizes. The values are
+/// not recorded, so the profile has no value sites with data.
+void __llvm_profile_instrument_target(uint64_t value, void* data, uint32_t site);
+void __llvm_profile_instrument_memop(uint64_t value, void* data, uint32_t site);
+void __llvm_profile_instrument_range(uint64_t value, void* data, uint32_t site,
+                                     int64_t precise_start, int64_t precise_last, int64_t large_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,10 +2,28 @@
 #include "AST/Type.h"
 #include "AST/Decl.h"
 
+#include <array>
+#include <algorithm>
+
 bool UnaryExpr::isLeftValue() const {
   return getType()->getKind() == Type::Kind::ReferenceType;
 }
 
 bool IdentifierExpr::isLeftValue() const {
-  return decl_->is<const VarDecl>() || decl_->is<const LetDecl>() || decl_->is<const UninitializedVarDecl>();
+  return decl_->is<const VarDecl>() || decl_->is<const LetDecl>() || decl_->is<const UninitializedVarDecl>()
+    || decl_->is<const ConstDecl>();
+}
+
+bool BinaryExpr::isAssignment() const {
+  return getOperator() == StringRef{"="} || isCompoundAssignment();
+}
+
+bool BinaryExpr::isCompoundAssignment() const {
+  static const std::array<const char*, 10> compound_operators{{
+    "+=", "-=", "*=", "/=", "%=", "<<=", ">>=", "&=", "|=", "^="
+  }};
+  StringRef op = getOperator();
+  return std::any_of(compound_operators.begin(), compound_operators.end(), [&op](const char *compound) {
+    return op == StringRef{compound};
+  });
 }
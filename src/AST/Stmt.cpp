@@ -28,7 +28,62 @@ std::vector<TreeElement*> WhileLoop::getChildren() const {
   return { condition_.get(), stmt_.get()};
 }
 
+ForLoop::ForLoop(
+  std::unique_ptr<LoopVarDecl> decl
+, std::unique_ptr<Expr> start
+, std::unique_ptr<Expr> end
+, std::unique_ptr<CompoundStmt> stmt
+): decl_{std::move(decl)}, start_{std::move(start)}, end_{std::move(end)}, stmt_{std::move(stmt)} {
+  assert(decl_ && "precondition: declaration must not be nullptr");
+  assert(start_ && end_ && "precondition: range bounds must not be nullptr");
+  assert(stmt_ && "precondition: stmt must not be nullptr");
+}
+
+ForLoop::ForLoop(
+  std::unique_ptr<LoopVarDecl> decl
+, std::unique_ptr<Expr> sequence
+, std::unique_ptr<CompoundStmt> stmt
+): decl_{std::move(decl)}, sequence_{std::move(sequence)}, stmt_{std::move(stmt)} {
+  assert(decl_ && "precondition: declaration must not be nullptr");
+  assert(sequence_ && "precondition: sequence must not be nullptr");
+  assert(stmt_ && "precondition: stmt must not be nullptr");
+}
+
+ForLoop::~ForLoop() = default;
+
+void ForLoop::setParallel(std::vector<Reduction> reductions) {
+  is_parallel_ = true;
+  reductions_ = std::move(reductions);
+}
+
+std::vector<TreeElement*> ForLoop::getChildren() const {
+  if (isRange()) return { decl_.get(), start_.get(), end_.get(), stmt_.get() };
+  else return { decl_.get(), sequence_.get(), stmt_.get() };
+}
+
 std::vector<TreeElement*> ConditionalStmt::getChildren() const {
   if (!condition_) { return { stmt_.get()}; }
   else return { condition_.get(), stmt_.get()};
 }
+
+MatchStmt::MatchStmt(
+  std::unique_ptr<Expr> scrutinee
+, std::vector<MatchCase> cases
+, std::unique_ptr<CompoundStmt> else_block
+): scrutinee_{std::move(scrutinee)}, cases_{std::move(cases)}, else_{std::move(else_block)} {
+  assert(scrutinee_ && "precondition: scrutinee must not be nullptr");
+}
+
+MatchStmt::~MatchStmt() = default;
+
+std::vector<TreeElement*> MatchStmt::getChildren() const {
+  std::vector<TreeElement*> children{scrutinee_.get()};
+  for (auto &match_case: cases_) {
+    for (auto &value: match_case.values) {
+      children.push_back(value.get());
+    }
+    children.push_back(match_case.block.get());
+  }
+  if (else_) children.push_back(else_.get());
+  return children;
+}
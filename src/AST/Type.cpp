@@ -22,10 +22,39 @@ bool Type::isBooleanType() const {
 // IntegerType
 //----------------------------------------------------------------------------//
 
-IntegerType IntegerType::singleton;
+Type* Type::getBuiltinType(StringRef name) {
+  if (name == StringRef{"bool"}) return BooleanType::getInstance();
+  else if (name == StringRef{"char"}) return CharacterType::getInstance();
+  else if (name == StringRef{"f32"}) return DoubleType::getInstance(32);
+  else if (name == StringRef{"f64"}) return DoubleType::getInstance(64);
+
+  for (int bits: {8, 16, 32, 64}) {
+    for (bool is_signed: {true, false}) {
+      IntegerType* type = IntegerType::getInstance(bits, is_signed);
+      if (name.str() == type->toString()) return type;
+    }
+  }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------//
+// IntegerType
+//----------------------------------------------------------------------------//
+
+IntegerType IntegerType::instances[8] = {
+  {8, true}, {16, true}, {32, true}, {64, true}
+, {8, false}, {16, false}, {32, false}, {64, false}
+};
+
+IntegerType* IntegerType::getInstance() {
+  return getInstance(64, true);
+}
 
- IntegerType* IntegerType::getInstance() {
-  return &IntegerType::singleton;
+IntegerType* IntegerType::getInstance(int bits, bool is_signed) {
+  for (IntegerType &instance: instances) {
+    if (instance.bits_ == bits && instance.is_signed_ == is_signed) return &instance;
+  }
+  return nullptr;
 }
 
 
@@ -40,13 +69,20 @@ CharacterType CharacterType::singleton;
 // IntegerType
 //----------------------------------------------------------------------------//
 
-DoubleType DoubleType::singleton;
+DoubleType DoubleType::single{32};
+DoubleType DoubleType::singleton{64};
 
 
- DoubleType* DoubleType::getInstance() {
+DoubleType* DoubleType::getInstance() {
   return &DoubleType::singleton;
 }
 
+DoubleType* DoubleType::getInstance(int bits) {
+  if (bits == 32) return &DoubleType::single;
+  else if (bits == 64) return &DoubleType::singleton;
+  else return nullptr;
+}
+
 BooleanType BooleanType::singleton;
 
 
@@ -66,8 +102,24 @@ std::vector<std::unique_ptr<TypeIdentifier>> TypeIdentifier::instances;
 std::vector<std::unique_ptr<TupleType>> TupleType::instances;
 std::vector<std::unique_ptr<FunctionType>> FunctionType::instances;
 std::vector<std::unique_ptr<ListType>> ListType::instances;
+std::vector<std::unique_ptr<VectorType>> VectorType::instances;
 std::vector<std::unique_ptr<MapType>> MapType::instances;
+std::vector<std::unique_ptr<AtomicType>> AtomicType::instances;
 
 bool equal(std::shared_ptr<Type> t1, std::shared_ptr<Type> t2) {
   return t1->getCanonicalType() == t2->getCanonicalType();
 }
+
+//----------------------------------------------------------------------------//
+// AtomicType
+//----------------------------------------------------------------------------//
+
+bool AtomicType::getOrder(StringRef name, Order &order) {
+  if (name == StringRef{"relaxed"}) order = Order::Relaxed;
+  else if (name == StringRef{"acquire"}) order = Order::Acquire;
+  else if (name == StringRef{"release"}) order = Order::Release;
+  else if (name == StringRef{"acq_rel"}) order = Order::AcquireRelease;
+  else if (name == StringRef{"seq_cst"}) order = Order::SequentiallyConsistent;
+  else return false;
+  return true;
+}
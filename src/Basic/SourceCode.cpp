@@ -1,5 +1,7 @@
 #include "Basic/SourceCode.h"
 
+#include <algorithm>
+
 std::shared_ptr<SourceFile> SourceManager::currentSource = nullptr;
 
 bool operator==(const StringRef& str1, const StringRef& str2) {
@@ -13,7 +15,11 @@ bool operator!=(const StringRef& str1, const StringRef& str2) {
 }
 
 bool operator<(const StringRef& str1, const StringRef& str2) {
-  return strncmp(str2.start, str1.start, str1.length) < 0;
+  // a string orders before the longer strings it is a prefix of, so that the
+  // order is strict and e.g. "i" and "i8" are different keys of a map
+  int length = std::min(str1.length, str2.length);
+  int result = strncmp(str1.start, str2.start, length);
+  return result < 0 || (result == 0 && str1.length < str2.length);
 }
 
 std::ostream& operator<<(std::ostream &stream, const StringRef& ref) {
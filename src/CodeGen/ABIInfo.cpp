@@ -0,0 +1,103 @@
+#include "CodeGen/ABIInfo.h"
+
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/DataLayout.h"
+
+#include <algorithm>
+
+bool ABIInfo::isSysVX86_64() const {
+  llvm::Triple triple{module_.getTargetTriple()};
+  return triple.getArch() == llvm::Triple::x86_64 && !triple.isOSWindows();
+}
+
+ABIArgInfo ABIInfo::classify(llvm::Type *type) const {
+  // scalars and pointers are always passed in a single register
+  if (!type->isAggregateType()) return ABIArgInfo::getDirect();
+
+  const llvm::DataLayout &data_layout = module_.getDataLayout();
+  uint64_t size = data_layout.getTypeAllocSize(type);
+
+  // empty aggregates have nothing to pass
+  if (size == 0) return ABIArgInfo::getDirect();
+
+  if (!isSysVX86_64() || size > 16) return ABIArgInfo::getIndirect();
+
+  // each eightbyte of the aggregate is assigned the class of the scalars it
+  // contains. An eightbyte containing any integer is passed in an integer
+  // register, otherwise it is passed in an SSE register.
+  std::vector<RegisterClass> classes((size + 7) / 8, RegisterClass::None);
+  std::vector<llvm::Type*> first_leaves(classes.size(), nullptr);
+  classifyEightbytes(type, 0, classes, first_leaves);
+
+  if (std::find(classes.begin(), classes.end(), RegisterClass::Memory) != classes.end()) {
+    return ABIArgInfo::getIndirect();
+  }
+
+  llvm::LLVMContext &context = type->getContext();
+  std::vector<llvm::Type*> pieces;
+  for (size_t i = 0; i < classes.size(); i++) {
+    uint64_t piece_size = std::min<uint64_t>(8, size - 8 * i);
+    switch (classes[i]) {
+    case RegisterClass::Integer:
+    case RegisterClass::None:
+      // a pointer fills its whole eightbyte. It is passed as a pointer, so
+      // that attributes describing the pointee can be attached to it.
+      if (first_leaves[i] && first_leaves[i]->isPointerTy()) {
+        pieces.push_back(first_leaves[i]);
+      } else {
+        pieces.push_back(llvm::IntegerType::get(context, piece_size * 8));
+      }
+      break;
+    case RegisterClass::SSE:
+      if (piece_size <= 4) {
+        pieces.push_back(llvm::Type::getFloatTy(context));
+      } else if (first_leaves[i]->isDoubleTy()) {
+        pieces.push_back(llvm::Type::getDoubleTy(context));
+      } else {
+        pieces.push_back(llvm::VectorType::get(llvm::Type::getFloatTy(context), 2));
+      }
+      break;
+    case RegisterClass::Memory:
+      return ABIArgInfo::getIndirect();
+    }
+  }
+  return ABIArgInfo::getCoerce(std::move(pieces));
+}
+
+void ABIInfo::classifyEightbytes(
+  llvm::Type *type
+, uint64_t offset
+, std::vector<RegisterClass> &classes
+, std::vector<llvm::Type*> &first_leaves
+) const {
+  const llvm::DataLayout &data_layout = module_.getDataLayout();
+  size_t eightbyte = offset / 8;
+
+  // fields which are not naturally aligned must be passed in memory
+  if (offset % data_layout.getABITypeAlignment(type) != 0) {
+    classes[eightbyte] = RegisterClass::Memory;
+    return;
+  }
+
+  if (llvm::StructType *struct_type = llvm::dyn_cast<llvm::StructType>(type)) {
+    const llvm::StructLayout *layout = data_layout.getStructLayout(struct_type);
+    for (unsigned i = 0; i < struct_type->getNumElements(); i++) {
+      classifyEightbytes(struct_type->getElementType(i), offset + layout->getElementOffset(i), classes, first_leaves);
+    }
+  } else if (llvm::ArrayType *array_type = llvm::dyn_cast<llvm::ArrayType>(type)) {
+    uint64_t element_size = data_layout.getTypeAllocSize(array_type->getElementType());
+    for (uint64_t i = 0; i < array_type->getNumElements(); i++) {
+      classifyEightbytes(array_type->getElementType(), offset + i * element_size, classes, first_leaves);
+    }
+  } else {
+    if (!first_leaves[eightbyte]) first_leaves[eightbyte] = type;
+    RegisterClass &current = classes[eightbyte];
+    if (type->isIntegerTy() || type->isPointerTy()) {
+      if (current != RegisterClass::Memory) current = RegisterClass::Integer;
+    } else if (type->isFloatTy() || type->isDoubleTy()) {
+      if (current == RegisterClass::None) current = RegisterClass::SSE;
+    } else {
+      current = RegisterClass::Memory;
+    }
+  }
+}
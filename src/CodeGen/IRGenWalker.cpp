@@ -11,6 +11,8 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Analysis/Interval.h"
@@ -22,22 +24,129 @@
 #include "AST/Expr.h"
 #include "AST/Stmt.h"
 #include "AST/Decl.h"
+#include <algorithm>
+#include <tuple>
 #include <vector>
 #include <map>
+#include <numeric>
+
+// Return true if the type is an unsigned integer, or a vector of unsigned
+// integers. Unsigned values are divided, compared and extended with the
+// unsigned variants of the integer instructions.
+static bool isUnsigned(const Type& type) {
+  const Type* scalar = type.getCanonicalType();
+  if (const VectorType* vector_type = dynamic_cast<const VectorType*>(scalar)) {
+    scalar = vector_type->element_type()->getCanonicalType();
+  }
+  const IntegerType* int_type = dynamic_cast<const IntegerType*>(scalar);
+  return int_type && !int_type->isSigned();
+}
+
+// Return how an integer narrower than 32 bits is extended when passed to or
+// returned from a function, as the C calling convention expects the full
+// register to hold the value.
+static ABIArgInfo::Extension getExtension(const Type& type) {
+  const IntegerType* int_type = dynamic_cast<const IntegerType*>(type.getCanonicalType());
+  if (!int_type || int_type->bits() >= 32) return ABIArgInfo::Extension::None;
+  return int_type->isSigned() ? ABIArgInfo::Extension::Sign : ABIArgInfo::Extension::Zero;
+}
+
+FunctionABIInfo LLVMTransformer::classifyFunctionType(const FunctionType &type) {
+  ABIInfo abi_info{*module_};
+  FunctionABIInfo function_info;
+  function_info.returns = abi_info.classify(transformType(*type.getReturnType()));
+  function_info.returns.extension = getExtension(*type.getReturnType());
+  for (auto param_type: type.getParamTypes()) {
+    function_info.params.push_back(abi_info.classify(transformType(*param_type)));
+    function_info.params.back().extension = getExtension(*param_type);
+  }
+  return function_info;
+}
 
 llvm::FunctionType* LLVMTransformer::transformFunctionType(const FunctionType &type) {
-  if (type.getParamTypes().size() == 0) {
-    // functions with no arguments can be created trivially
-    return llvm::FunctionType::get(transformType(*type.getReturnType()), false);
-  } else {
-    // functions with arguments must have their argument iteratively
-    // converted to llvm types
-    std::vector<llvm::Type*> param_types;
-    for (auto param_type: type.getParamTypes()) {
-      param_types.push_back(transformType(*param_type));
+  FunctionABIInfo function_info = classifyFunctionType(type);
+
+  llvm::Type* return_type = transformType(*type.getReturnType());
+  std::vector<llvm::Type*> param_types;
+
+  switch (function_info.returns.kind) {
+    case ABIArgInfo::Kind::Direct:
+      break;
+    case ABIArgInfo::Kind::Indirect:
+      param_types.push_back(llvm::PointerType::getUnqual(return_type));
+      return_type = llvm::Type::getVoidTy(context_);
+      break;
+    case ABIArgInfo::Kind::Coerce:
+      return_type = function_info.returns.getCoercedReturnType(context_);
+      break;
+  }
+
+  for (size_t i = 0; i < type.getParamTypes().size(); i++) {
+    const ABIArgInfo &info = function_info.params[i];
+    llvm::Type* param_type = transformType(*type.getParam(i));
+    switch (info.kind) {
+      case ABIArgInfo::Kind::Direct:
+        param_types.push_back(param_type);
+        break;
+      case ABIArgInfo::Kind::Indirect:
+        param_types.push_back(llvm::PointerType::getUnqual(param_type));
+        break;
+      case ABIArgInfo::Kind::Coerce:
+        param_types.insert(param_types.end(), info.pieces.begin(), info.pieces.end());
+        break;
     }
-    return llvm::FunctionType::get(transformType(*type.getReturnType()), param_types, type.isVarArg());
   }
+
+  return llvm::FunctionType::get(return_type, param_types, type.isVarArg());
+}
+
+// Return the llvm argument index of the first piece of each parameter
+static std::vector<unsigned> argIndices(const FunctionABIInfo& function_info) {
+  std::vector<unsigned> indices;
+  unsigned index = function_info.returns.kind == ABIArgInfo::Kind::Indirect ? 1 : 0;
+  for (const ABIArgInfo &info: function_info.params) {
+    indices.push_back(index);
+    index += info.kind == ABIArgInfo::Kind::Coerce ? info.pieces.size() : 1;
+  }
+  return indices;
+}
+
+// Return the attribute which describes the extension of a narrow integer
+static llvm::Attribute::AttrKind getExtensionAttribute(ABIArgInfo::Extension extension) {
+  return extension == ABIArgInfo::Extension::Sign ? llvm::Attribute::SExt : llvm::Attribute::ZExt;
+}
+
+// Marks the 'sret' and 'byval' pointers, and the extension of narrow integers,
+// of a function or call site. Indices are llvm argument indices after lowering.
+template <typename T>
+static void addABIAttributes(T& function_or_call, const FunctionABIInfo& function_info, const std::vector<unsigned>& byval_indices) {
+  if (function_info.returns.kind == ABIArgInfo::Kind::Indirect) {
+    function_or_call.addParamAttr(0, llvm::Attribute::StructRet);
+    function_or_call.addParamAttr(0, llvm::Attribute::NoAlias);
+  }
+  for (unsigned index: byval_indices) {
+    function_or_call.addParamAttr(index, llvm::Attribute::ByVal);
+  }
+
+  if (function_info.returns.extension != ABIArgInfo::Extension::None) {
+    function_or_call.addAttribute(llvm::AttributeList::ReturnIndex, getExtensionAttribute(function_info.returns.extension));
+  }
+  std::vector<unsigned> arg_indices = argIndices(function_info);
+  for (size_t i = 0; i < function_info.params.size(); i++) {
+    if (function_info.params[i].extension != ABIArgInfo::Extension::None) {
+      function_or_call.addParamAttr(arg_indices[i], getExtensionAttribute(function_info.params[i].extension));
+    }
+  }
+}
+
+// Return the llvm argument indices of all parameters passed in memory
+static std::vector<unsigned> byvalIndices(const FunctionABIInfo& function_info) {
+  std::vector<unsigned> arg_indices = argIndices(function_info);
+  std::vector<unsigned> indices;
+  for (size_t i = 0; i < function_info.params.size(); i++) {
+    if (function_info.params[i].kind == ABIArgInfo::Kind::Indirect) indices.push_back(arg_indices[i]);
+  }
+  return indices;
 }
 
 llvm::StructType* LLVMTransformer::transformStructType(const TupleType &type) {
@@ -45,27 +154,102 @@ llvm::StructType* LLVMTransformer::transformStructType(const TupleType &type) {
   for (auto element: type.elements()) {
     element_types.push_back(transformType(*element));
   }
-  return llvm::StructType::create(element_types);
+  // tuples are structural, so equal tuple types share a literal struct type
+  return llvm::StructType::get(context_, element_types);
 }
 
 llvm::StructType* LLVMTransformer::transformStructType(const StructType &type) {
-  std::vector<llvm::Type*> element_types;
+  const StructLayout &layout = type.getLayout();
+  std::vector<llvm::Type*> member_types;
   for (auto element: type.elements()) {
-    element_types.push_back(transformType(*element));
+    member_types.push_back(transformType(*element));
+  }
+
+  // reordered members are sorted by decreasing alignment, and members of
+  // equal alignment keep their declaration order
+  std::vector<unsigned> order(member_types.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (layout.is_reordered) {
+    const llvm::DataLayout &data_layout = module_->getDataLayout();
+    std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+      return data_layout.getABITypeAlignment(member_types[a]) > data_layout.getABITypeAlignment(member_types[b]);
+    });
+  }
+
+  // an empty array of N byte vectors raises the alignment of the struct to N
+  // without taking up space, so the struct is padded to a multiple of N
+  std::vector<llvm::Type*> element_types;
+  if (layout.align) {
+    llvm::Type* align_type = llvm::VectorType::get(llvm::Type::getInt8Ty(context_), layout.align);
+    element_types.push_back(llvm::ArrayType::get(align_type, 0));
+  }
+
+  std::vector<unsigned> &indices = member_indices_[&type];
+  indices.assign(member_types.size(), 0);
+  for (unsigned member: order) {
+    indices[member] = element_types.size();
+    element_types.push_back(member_types[member]);
+  }
+  return llvm::StructType::create(context_, element_types, "", layout.is_packed);
+}
+
+unsigned LLVMTransformer::memberIndex(const StructType &type, int member) {
+  transformType(type);
+  return member_indices_[&type][member];
+}
+
+// Return the struct type of the elements if the type is an array of @soa
+// structs or a reference to one
+static const StructType* soaElementType(const Type* type) {
+  type = type->getCanonicalType();
+  if (const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(type)) {
+    type = ref_type->getReferencedType()->getCanonicalType();
   }
-  return llvm::StructType::create(element_types);
+  const ListType* list_type = dynamic_cast<const ListType*>(type);
+  if (!list_type) return nullptr;
+  const StructType* struct_type = dynamic_cast<const StructType*>(list_type->element_type()->getCanonicalType());
+  return struct_type && struct_type->getLayout().is_soa ? struct_type : nullptr;
+}
+
+llvm::StructType* LLVMTransformer::transformSliceType(const SliceType &type) {
+  llvm::Type* data_type = llvm::PointerType::getUnqual(transformType(*type.element()));
+  llvm::Type* length_type = llvm::Type::getInt64Ty(context_);
+  return llvm::StructType::get(context_, {data_type, length_type});
 }
 
 llvm::Type* LLVMTransformer::transformType(const Type &type) {
+  auto cache_it = type_cache_.find(&type);
+  if (cache_it != type_cache_.end()) return cache_it->second;
+
+  llvm::Type* lowered = lowerType(type);
+  type_cache_[&type] = lowered;
+  return lowered;
+}
+
+llvm::Type* LLVMTransformer::lowerType(const Type &type) {
   if (type.isIntegerType()) {
-    return llvm::Type::getInt64Ty(context_);
+    return llvm::Type::getIntNTy(context_, dynamic_cast<const IntegerType*>(type.getCanonicalType())->bits());
   } if (type.isBooleanType()) {
     return llvm::Type::getInt1Ty(context_);
   } else if (type.isDoubleType()) {
+    if (dynamic_cast<const DoubleType*>(type.getCanonicalType())->bits() == 32) {
+      return llvm::Type::getFloatTy(context_);
+    }
     return llvm::Type::getDoubleTy(context_);
   } else if (type.getKind() == Type::Kind::ListType) {
     const ListType &list_type = dynamic_cast<const ListType&>(type);
+    // an array of @soa structs is a struct with an array for each field
+    if (const StructType* soa_type = soaElementType(&type)) {
+      std::vector<llvm::Type*> field_types;
+      for (auto element: soa_type->elements()) {
+        field_types.push_back(llvm::ArrayType::get(transformType(*element), list_type.size()));
+      }
+      return llvm::StructType::get(context_, field_types);
+    }
     return llvm::ArrayType::get(transformType(*list_type.element_type()), list_type.size());
+  } else if (type.getKind() == Type::Kind::VectorType) {
+    const VectorType &vector_type = dynamic_cast<const VectorType&>(type);
+    return llvm::VectorType::get(transformType(*vector_type.element_type()), vector_type.size());
   } else if (type.getKind() == Type::Kind::CharacterType) {
     return llvm::Type::getInt8Ty(context_);
   } else if (type.getKind() == Type::Kind::PointerType) {
@@ -75,20 +259,27 @@ llvm::Type* LLVMTransformer::transformType(const Type &type) {
     const ReferenceType &ptr_type = dynamic_cast<const ReferenceType&>(type);
     return llvm::PointerType::getUnqual(transformType(*ptr_type.getReferencedType()));
   } else if (type.getKind() == Type::Kind::SliceType) {
-    const SliceType &slice_type = dynamic_cast<const SliceType&>(type);
-    return llvm::PointerType::getUnqual(transformType(*slice_type.element()));
+    return transformSliceType(dynamic_cast<const SliceType&>(type));
   } else if (type.getKind() == Type::Kind::TupleType) {
     return transformStructType(dynamic_cast<const TupleType&>(type));
+  } else if (type.getKind() == Type::Kind::AtomicType) {
+    // atomics are only accessed through atomic instructions, so they are laid
+    // out like their value
+    return transformType(*dynamic_cast<const AtomicType&>(type).getValueType());
+  } else if (type.getKind() == Type::Kind::MapType) {
+    // a map is a handle to a table owned by the runtime library
+    if (!map_type_) map_type_ = llvm::StructType::create(context_, "bulat.map");
+    return llvm::PointerType::getUnqual(map_type_);
   } else if (type.getKind() == Type::Kind::StructType) {
     return transformStructType(dynamic_cast<const StructType&>(type));
   } else if (type.getKind() == Type::Kind::TypeIdentifier) {
+    // a named type shares the lowering of its canonical type, so that values
+    // of the struct have the same llvm type no matter how they are spelled
     const TypeIdentifier *type_id = dynamic_cast<const TypeIdentifier*>(&type);
-    llvm::Type* lookup = module_->getTypeByName(type_id->name());
-    if (lookup) return lookup;
     const Type* canonical = type.getCanonicalType();
     llvm::Type* transformed = transformType(*canonical);
-    if (transformed->isStructTy()) {
-      static_cast<llvm::StructType*>(transformed)->setName(type_id->name());
+    if (llvm::StructType* struct_type = llvm::dyn_cast<llvm::StructType>(transformed)) {
+      if (!struct_type->isLiteral() && !struct_type->hasName()) struct_type->setName(type_id->toString());
     } else throw CompilerException(nullptr, "invalid named type");
     return transformed;
   } else {
@@ -98,30 +289,131 @@ llvm::Type* LLVMTransformer::transformType(const Type &type) {
 
 void LLVMTransformer::transformReturnStmt(const ReturnStmt& stmt, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
+
+  // the maps and allocators of the enclosing blocks are released once the
+  // result is computed
+  auto exitScopes = [this, &builder, current_block]() {
+    freeOwnedMaps(0, current_block);
+    for (unsigned i = 0; i < allocator_scopes_; i++) {
+      builder.CreateCall(getAllocationFunction("__bulat_pop_allocator"));
+    }
+  };
+
   if (const Expr *expr = stmt.getExpr()) {
-    builder.CreateRet(transformExpr(*expr, current_block));
+    // the callee of a guaranteed tail call has the type of the function, so
+    // its result is returned as the callee returned it, and an indirect result
+    // is written straight to the return slot of the caller
+    const FunctionCall *call = dynamic_cast<const FunctionCall*>(expr);
+    if (call && call->getTailCall() == FunctionCall::TailCall::Guaranteed) {
+      llvm::Value* result = transformFunctionCall(
+        *call, current_block, return_info_.kind == ABIArgInfo::Kind::Indirect ? return_slot_ : nullptr
+      );
+      if (result->getType()->isVoidTy()) builder.CreateRetVoid();
+      else builder.CreateRet(result);
+      return;
+    }
+
+    llvm::Value* value = transformExpr(*expr, current_block);
+    exitScopes();
+    switch (return_info_.kind) {
+      case ABIArgInfo::Kind::Direct:
+        builder.CreateRet(value);
+        break;
+      case ABIArgInfo::Kind::Indirect:
+        builder.CreateStore(value, return_slot_);
+        builder.CreateRetVoid();
+        break;
+      case ABIArgInfo::Kind::Coerce: {
+        std::vector<llvm::Value*> pieces = coerceToPieces(value, return_info_, current_block);
+        if (pieces.size() == 1) {
+          builder.CreateRet(pieces.front());
+        } else {
+          llvm::Value* result = llvm::UndefValue::get(return_info_.getCoercedType(context_));
+          for (unsigned i = 0; i < pieces.size(); i++) {
+            result = builder.CreateInsertValue(result, pieces[i], i);
+          }
+          builder.CreateRet(result);
+        }
+        break;
+      }
+    }
   } else {
+    exitScopes();
     builder.CreateRetVoid();
   }
 }
 
 void LLVMTransformer::transformLetDecl(const LetDecl& let_decl, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
-  llvm::AllocaInst *alloca = builder.CreateAlloca(transformType(*let_decl.getType()), 0, let_decl.getName().str());
-  builder.CreateStore(transformExpr(let_decl.getExpr(),current_block), alloca);
+  llvm::Type* type = transformType(*let_decl.getType());
+
+  // let bindings are immutable, so a constant aggregate initializer is
+  // referenced in place rather than copied onto the stack. A binding whose
+  // location is taken gets its own copy, since the global is read-only and
+  // shared by equal constants.
+  llvm::Constant* constant = transformConstantAggregate(let_decl.getExpr());
+  if (constant && constant->getType() == type && !let_decl.isReferenced()) {
+    named_values_[let_decl.getName()] = getConstantGlobal(constant);
+    return;
+  }
+
+  llvm::AllocaInst *alloca = builder.CreateAlloca(type, 0, let_decl.getName().str());
+  const FunctionCall* call = let_decl.getExpr().as<FunctionCall>();
+  if (constant && constant->getType() == type) {
+    const llvm::DataLayout &data_layout = module_->getDataLayout();
+    unsigned align = data_layout.getABITypeAlignment(type);
+    uint64_t size = data_layout.getTypeAllocSize(type);
+    builder.CreateMemCpy(alloca, align, getConstantGlobal(constant), align, size);
+  } else if (call && let_decl.getType()->getCanonicalType()->getKind() != Type::Kind::SliceType) {
+    // calls returning in memory write their result directly into the binding
+    if (llvm::Value* value = transformFunctionCall(*call, current_block, alloca)) {
+      builder.CreateStore(value, alloca);
+    }
+  } else {
+    builder.CreateStore(transformExprAs(let_decl.getExpr(), *let_decl.getType(), current_block), alloca);
+  }
   named_values_[let_decl.getName()] = alloca;
 }
 
 void LLVMTransformer::transformVarDecl(const VarDecl& var_decl, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
   llvm::AllocaInst *alloca = builder.CreateAlloca(transformType(*var_decl.getType()), 0, var_decl.getName().str());
-  builder.CreateStore(transformExpr(var_decl.getExpr(),current_block), alloca);
+  llvm::Constant* constant = transformConstantAggregate(var_decl.getExpr());
+  const FunctionCall* call = var_decl.getExpr().as<FunctionCall>();
+  if (constant && constant->getType() == alloca->getAllocatedType()) {
+    // the mutable copy of a constant aggregate is initialized from its global
+    const llvm::DataLayout &data_layout = module_->getDataLayout();
+    unsigned align = data_layout.getABITypeAlignment(constant->getType());
+    uint64_t size = data_layout.getTypeAllocSize(constant->getType());
+    builder.CreateMemCpy(alloca, align, getConstantGlobal(constant), align, size);
+  } else if (call && var_decl.getType()->getCanonicalType()->getKind() != Type::Kind::SliceType) {
+    // calls returning in memory write their result directly into the binding
+    if (llvm::Value* value = transformFunctionCall(*call, current_block, alloca)) {
+      builder.CreateStore(value, alloca);
+    }
+  } else {
+    builder.CreateStore(transformExprAs(var_decl.getExpr(), *var_decl.getType(), current_block), alloca);
+  }
   named_values_[var_decl.getName()] = alloca;
 }
 
 void LLVMTransformer::transformUninitializedVarDecl(const UninitializedVarDecl& var_decl, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
   llvm::AllocaInst *alloca = builder.CreateAlloca(transformType(*var_decl.getType()), 0, var_decl.getName().str());
+  if (const MapType* map_type = dynamic_cast<const MapType*>(var_decl.getType()->getCanonicalType())) {
+    // a map variable starts out as a new empty table
+    const llvm::DataLayout &data_layout = module_->getDataLayout();
+    llvm::Type* value_type = transformType(*map_type->getValueType());
+    llvm::Value* map = builder.CreateCall(getMapFunction("__bulat_map_new"), {
+      builder.getInt64(data_layout.getTypeAllocSize(value_type))
+    , builder.getInt64(data_layout.getABITypeAlignment(value_type))
+    });
+    builder.CreateStore(map, alloca);
+    owned_maps_.push_back(alloca);
+  } else if (var_decl.getType()->getCanonicalType()->is<AtomicType>()) {
+    // an atomic variable starts out as zero
+    builder.CreateStore(llvm::Constant::getNullValue(alloca->getAllocatedType()), alloca);
+  }
   named_values_[var_decl.getName()] = alloca;
 }
 
@@ -137,6 +429,9 @@ void LLVMTransformer::transformDeclStmt(const DeclStmt& declStmt, llvm::BasicBlo
     case Decl::Kind::UninitializedVarDecl:
       transformUninitializedVarDecl(static_cast<const UninitializedVarDecl&>(*decl), current_block);
       break;
+    case Decl::Kind::ConstDecl:
+      // constants are emitted where they are used
+      break;
     case Decl::Kind::FuncDecl:
       throw CompilerException(nullptr, "nested function declarations not current supported");
       break;
@@ -146,6 +441,10 @@ void LLVMTransformer::transformDeclStmt(const DeclStmt& declStmt, llvm::BasicBlo
 }
 
 llvm::Value* LLVMTransformer::transformIdentifierExprReference(const IdentifierExpr& id_expr, llvm::BasicBlock* current_block) {
+  if (const ConstDecl *const_decl = dynamic_cast<const ConstDecl*>(id_expr.getDecl())) {
+    return getConstantGlobal(transformConstantValue(*const_decl->getValue()));
+  }
+
   auto map_it = named_values_.find(id_expr.lexeme());
   if (map_it != named_values_.end()) {
     return map_it->second;
@@ -156,45 +455,111 @@ llvm::Value* LLVMTransformer::transformIdentifierExprReference(const IdentifierE
   }
 }
 
-llvm::Value* LLVMTransformer::transformAccessorExprReference(const AccessorExpr &accessor, llvm::BasicBlock* current_block) {
+llvm::Value* LLVMTransformer::transformElementIndex(const AccessorExpr &accessor, llvm::Value* aggregate_loc, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
 
-  // in order to access a member of an aggregate structure, we must first
-  // aquire a pointer to the start of the structure.
-  llvm::Value* aggregate_loc = transformExprReference(
-    accessor.identifier()
-  , current_block
-  );
-
   // GetElementPtr instructions ONLY take indices of the type i32. For this
   // reason, all indices used MUST be zero-extended or truncated to fit an i32.
   llvm::Type* index_type = llvm::Type::getInt32Ty(context_);
 
+  const Type* aggregate_type = accessor.identifier().getType()->getCanonicalType();
+  if (const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(aggregate_type)) {
+    aggregate_type = ref_type->getReferencedType()->getCanonicalType();
+  }
+
   // The element index may either be known at compile time, or generated at
   // runtime.
-  llvm::Value* element_index;
-
   if (accessor.hasStaticIndex()) {
-    element_index = llvm::ConstantInt::get(index_type, accessor.getMemberIndex());
-  } else {
-    element_index = builder.CreateSExtOrTrunc(
-      transformExpr(accessor.index(), current_block)
-    , index_type
-    );
+    int index = accessor.getMemberIndex();
+    // the layout of a struct may store its members in a different order
+    if (const StructType* struct_type = dynamic_cast<const StructType*>(aggregate_type)) {
+      index = memberIndex(*struct_type, index);
+    }
+    return llvm::ConstantInt::get(index_type, index);
   }
 
+  llvm::Value* runtime_index = transformIndex(accessor.index(), current_block);
+
+  // runtime indices are checked against the length of the aggregate unless
+  // semantic analysis proved the access to be in bounds.
+  if (bounds_checking_ && !accessor.isInBounds()) {
+    if (aggregate_type->getKind() == Type::Kind::SliceType) {
+      transformBoundsCheck(runtime_index, builder.CreateExtractValue(aggregate_loc, 1), current_block);
+    } else if (const ListType* list_type = dynamic_cast<const ListType*>(aggregate_type)) {
+      llvm::Value* length = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context_), list_type->size());
+      transformBoundsCheck(runtime_index, length, current_block);
+    }
+  }
+
+  return builder.CreateSExtOrTrunc(runtime_index, index_type);
+}
+
+llvm::Value* LLVMTransformer::transformAccessorExprReference(const AccessorExpr &accessor, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Value* element_index_0 = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), 0);
+
+  // a field of an element of an array of @soa structs is an element of the
+  // array of the field
+  const AccessorExpr* element = dynamic_cast<const AccessorExpr*>(&accessor.identifier());
+  if (element && soaElementType(element->identifier().getType())) {
+    llvm::Value* array_loc = transformExprReference(element->identifier(), current_block);
+    llvm::Value* element_index = transformElementIndex(*element, array_loc, current_block);
+    llvm::Value* field_index = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), accessor.getMemberIndex());
+    std::array<llvm::Value*,3> indices{{element_index_0, field_index, element_index}};
+    return builder.CreateGEP(array_loc, indices);
+  }
+
+  // in order to access a member of an aggregate structure, we must first
+  // aquire a pointer to the start of the structure.
+  llvm::Value* aggregate_loc = transformExprReference(
+    accessor.identifier()
+  , current_block
+  );
+  llvm::Value* element_index = transformElementIndex(accessor, aggregate_loc, current_block);
+
+  // a whole element of an array of @soa structs is gathered into a copy,
+  // which is only read. Elements are assigned by transformAssignmentStmt.
+  if (const StructType* soa_type = soaElementType(accessor.identifier().getType())) {
+    llvm::Value* value = transformSoaElementLoad(aggregate_loc, *soa_type, element_index, current_block);
+    llvm::AllocaInst* copy = createEntryBlockAlloca(value->getType(), "element");
+    builder.CreateStore(value, copy);
+    return copy;
+  }
 
   if (accessor.identifier().isType<SliceType>()) {
     std::array<llvm::Value*,1> indices{{element_index}};
-    return builder.CreateGEP(aggregate_loc, indices);
+    return builder.CreateGEP(builder.CreateExtractValue(aggregate_loc, 0), indices);
   } else {
-    llvm::Value* element_index_0 = llvm::ConstantInt::get(index_type, 0);
     std::array<llvm::Value*,2> indices{{element_index_0, element_index}};
     return builder.CreateGEP(aggregate_loc, indices);
   }
 
 }
 
+llvm::Value* LLVMTransformer::transformSoaElementLoad(llvm::Value* array_loc, const StructType& type, llvm::Value* index, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Value* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), 0);
+  llvm::Value* element = llvm::UndefValue::get(transformType(type));
+  for (unsigned member = 0; member < type.elements().size(); member++) {
+    llvm::Value* field_index = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), member);
+    std::array<llvm::Value*,3> indices{{zero, field_index, index}};
+    llvm::Value* field = builder.CreateLoad(builder.CreateInBoundsGEP(array_loc, indices));
+    element = builder.CreateInsertValue(element, field, memberIndex(type, member));
+  }
+  return element;
+}
+
+void LLVMTransformer::transformSoaElementStore(llvm::Value* value, llvm::Value* array_loc, const StructType& type, llvm::Value* index, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Value* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), 0);
+  for (unsigned member = 0; member < type.elements().size(); member++) {
+    llvm::Value* field_index = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), member);
+    std::array<llvm::Value*,3> indices{{zero, field_index, index}};
+    llvm::Value* field = builder.CreateExtractValue(value, memberIndex(type, member));
+    builder.CreateStore(field, builder.CreateInBoundsGEP(array_loc, indices));
+  }
+}
+
 
 llvm::Value* LLVMTransformer::transformExprReference(const Expr& expr, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
@@ -220,11 +585,190 @@ llvm::Value* LLVMTransformer::transformExprReference(const Expr& expr, llvm::Bas
   }
 }
 
+llvm::Value* LLVMTransformer::transformExprAddress(const Expr& expr, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+
+  if (expr.isLeftValue() && (expr.getKind() == Expr::Kind::IdentifierExpr
+  || expr.getKind() == Expr::Kind::AccessorExpr)) {
+    return transformExprReference(expr, current_block);
+  }
+
+  // parameters passed in memory already have an address
+  if (const IdentifierExpr* id_expr = dynamic_cast<const IdentifierExpr*>(&expr)) {
+    auto map_it = named_values_.find(id_expr->lexeme());
+    if (map_it != named_values_.end() && indirect_args_.count(map_it->second)) {
+      return map_it->second;
+    }
+  }
+
+  // literals are passed from their constant global
+  if (llvm::Constant* constant = transformConstantAggregate(expr)) {
+    return getConstantGlobal(constant);
+  }
+
+  llvm::Value* value = transformExpr(expr, current_block);
+  llvm::AllocaInst* temporary = createEntryBlockAlloca(value->getType(), "tmp");
+  builder.CreateStore(value, temporary);
+  return temporary;
+}
+
+llvm::AllocaInst* LLVMTransformer::createEntryBlockAlloca(llvm::Type* type, const std::string& name) {
+  llvm::BasicBlock &entry_block = function_->getEntryBlock();
+  llvm::IRBuilder<> builder{&entry_block, entry_block.begin()};
+  return builder.CreateAlloca(type, nullptr, name);
+}
+
+std::vector<llvm::Value*> LLVMTransformer::coerceToPieces(llvm::Value* value, const ABIArgInfo& info, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+
+  // the aggregate is reinterpreted in memory. The coerced layout covers every
+  // byte of the aggregate, so the temporary is large enough for both.
+  llvm::AllocaInst* temporary = createEntryBlockAlloca(info.getCoercedType(context_), "coerce");
+  builder.CreateStore(value, builder.CreateBitCast(temporary, llvm::PointerType::getUnqual(value->getType())));
+
+  std::vector<llvm::Value*> pieces;
+  for (unsigned i = 0; i < info.pieces.size(); i++) {
+    pieces.push_back(builder.CreateLoad(builder.CreateStructGEP(temporary, i)));
+  }
+  return pieces;
+}
+
+llvm::Value* LLVMTransformer::coerceFromPieces(llvm::Value* value, llvm::Type* type, const ABIArgInfo& info, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+
+  llvm::AllocaInst* temporary = createEntryBlockAlloca(info.getCoercedType(context_), "coerce");
+  if (info.pieces.size() == 1) {
+    builder.CreateStore(value, builder.CreateStructGEP(temporary, 0));
+  } else {
+    builder.CreateStore(value, temporary);
+  }
+  return builder.CreateLoad(builder.CreateBitCast(temporary, llvm::PointerType::getUnqual(type)));
+}
+
+llvm::Value* LLVMTransformer::transformExprAs(const Expr& expr, const Type& type, llvm::BasicBlock* current_block) {
+  if (type.getCanonicalType()->getKind() == Type::Kind::SliceType && expr.isReferenceTo<ListType>()) {
+    return transformSliceConversion(expr, current_block);
+  }
+  return transformExpr(expr, current_block);
+}
+
+llvm::Value* LLVMTransformer::transformSliceConversion(const Expr& expr, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+
+  const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(expr.getType()->getCanonicalType());
+  const ListType* list_type = dynamic_cast<const ListType*>(ref_type->getReferencedType()->getCanonicalType());
+
+  // the data pointer of the slice points to the first element of the array
+  llvm::Value* array_loc = transformExpr(expr, current_block);
+  llvm::Value* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), 0);
+  std::array<llvm::Value*,2> indices{{zero, zero}};
+  llvm::Value* data = builder.CreateGEP(array_loc, indices);
+
+  // the length of the slice is the statically known length of the array
+  llvm::Value* length = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context_), list_type->size());
+
+  llvm::StructType* slice_type = transformSliceType(*SliceType::getInstance(list_type->element_type()));
+  llvm::Value* slice = builder.CreateInsertValue(llvm::UndefValue::get(slice_type), data, 0);
+  return builder.CreateInsertValue(slice, length, 1);
+}
+
+std::pair<llvm::Value*, llvm::Value*> LLVMTransformer::transformSequence(const Expr& sequence, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  const Type* type = sequence.getType()->getCanonicalType();
+
+  // the data pointer and the length of a slice are stored in the slice
+  if (type->getKind() == Type::Kind::SliceType) {
+    llvm::Value* slice = transformExpr(sequence, current_block);
+    return {builder.CreateExtractValue(slice, 0), builder.CreateExtractValue(slice, 1)};
+  }
+
+  // the length of an array is part of its type
+  llvm::Value* array_loc;
+  const ListType* list_type;
+  if (const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(type)) {
+    array_loc = transformExpr(sequence, current_block);
+    list_type = dynamic_cast<const ListType*>(ref_type->getReferencedType()->getCanonicalType());
+  } else {
+    array_loc = transformExprAddress(sequence, current_block);
+    list_type = dynamic_cast<const ListType*>(type);
+  }
+  llvm::Value* length = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context_), list_type->size());
+
+  // the elements of an array of @soa structs are not contiguous, so they are
+  // found from the address of the array
+  if (soaElementType(list_type)) return {array_loc, length};
+
+  llvm::Value* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context_), 0);
+  std::array<llvm::Value*,2> indices{{zero, zero}};
+  llvm::Value* data = builder.CreateInBoundsGEP(array_loc, indices);
+  return {data, length};
+}
+
+llvm::Function* LLVMTransformer::getBoundsCheckFunction() {
+  const std::string name = "__bulat_bounds_check";
+  if (llvm::Function* existing = module_->getFunction(name)) return existing;
+
+  llvm::Type* length_type = llvm::Type::getInt64Ty(context_);
+  llvm::FunctionType* type = llvm::FunctionType::get(
+    llvm::Type::getVoidTy(context_), {length_type, length_type}, false
+  );
+
+  // the helper is small and always inlined, so that the comparison becomes
+  // visible to the optimizer at each access.
+  llvm::Function* function = llvm::Function::Create(type, llvm::Function::InternalLinkage, name, module_);
+  function->addFnAttr(llvm::Attribute::AlwaysInline);
+  function->addFnAttr(llvm::Attribute::NoUnwind);
+
+  llvm::Argument* index = function->arg_begin();
+  llvm::Argument* length = function->arg_begin() + 1;
+  index->setName("index");
+  length->setName("length");
+
+  llvm::BasicBlock* entry = llvm::BasicBlock::Create(context_, "entry", function);
+  llvm::BasicBlock* in_bounds = llvm::BasicBlock::Create(context_, "in_bounds", function);
+  llvm::BasicBlock* out_of_bounds = llvm::BasicBlock::Create(context_, "out_of_bounds", function);
+
+  // an unsigned comparison rejects negative indices as well
+  llvm::IRBuilder<> entry_builder{entry};
+  entry_builder.CreateCondBr(entry_builder.CreateICmpULT(index, length), in_bounds, out_of_bounds);
+
+  llvm::IRBuilder<> out_of_bounds_builder{out_of_bounds};
+  out_of_bounds_builder.CreateCall(llvm::Intrinsic::getDeclaration(module_, llvm::Intrinsic::trap));
+  out_of_bounds_builder.CreateUnreachable();
+
+  llvm::IRBuilder<> in_bounds_builder{in_bounds};
+  in_bounds_builder.CreateRetVoid();
+
+  return function;
+}
+
+void LLVMTransformer::transformBoundsCheck(llvm::Value* index, llvm::Value* length, llvm::BasicBlock* current_block) {
+  if (!bounds_checking_) return;
+  llvm::IRBuilder<> builder{current_block};
+  builder.CreateCall(getBoundsCheckFunction(), {index, length});
+}
+
 llvm::Value* LLVMTransformer::transformAssignmentStmt(const BinaryExpr& bin_expr, llvm::BasicBlock* current_block) {
   llvm::IRBuilder<> builder{current_block};
    if (bin_expr.getLeft().isLeftValue()) {
+    // the fields of an element of an array of @soa structs are stored apart
+    const AccessorExpr* element = dynamic_cast<const AccessorExpr*>(&bin_expr.getLeft());
+    if (element && soaElementType(element->identifier().getType())) {
+      llvm::Value *array_loc = transformExprReference(element->identifier(), current_block);
+      llvm::Value *index = transformElementIndex(*element, array_loc, current_block);
+      llvm::Value *rval = transformExpr(bin_expr.getRight(), current_block);
+      transformSoaElementStore(rval, array_loc, *soaElementType(element->identifier().getType()), index, current_block);
+      return rval;
+    }
+
     llvm::Value *lval = transformExprReference(bin_expr.getLeft(), current_block);
     llvm::Value *rval = transformExpr(bin_expr.getRight(), current_block);
+    // a compound assignment evaluates the location once, e.g. `a[f()] += 1`
+    // calls f only once
+    if (bin_expr.isCompoundAssignment()) {
+      rval = transformBinaryOperator(bin_expr.getCompoundOperator(), builder.CreateLoad(lval), rval,
+                                     *bin_expr.getLeft().getType(), current_block);
+    }
     builder.CreateStore(rval, lval);
     return rval;
   } else {
@@ -235,50 +779,271 @@ llvm::Value* LLVMTransformer::transformAssignmentStmt(const BinaryExpr& bin_expr
 }
 
 llvm::Function* LLVMTransformer::transformExternalFunctionDecl(const ExternFuncDecl &extern_func) {
-  llvm::FunctionType* type = transformFunctionType(*extern_func.getFunctionType());
-  return llvm::Function::Create(type, llvm::Function::ExternalLinkage, extern_func.getName().str(), module_);
+  if (llvm::Function* existing = module_->getFunction(extern_func.getName().str())) return existing;
+
+  const FunctionType& func_type = *extern_func.getFunctionType();
+  FunctionABIInfo function_info = classifyFunctionType(func_type);
+  llvm::FunctionType* type = transformFunctionType(func_type);
+  llvm::Function* function = llvm::Function::Create(type, llvm::Function::ExternalLinkage, extern_func.getName().str(), module_);
+  addABIAttributes(*function, function_info, byvalIndices(function_info));
+  return function;
 }
 
 llvm::Function* LLVMTransformer::transformFunction(const FuncDecl &func) {
   currentContext = func.getDeclContext();
 
-  llvm::FunctionType* type = transformFunctionType(dynamic_cast<const FunctionType&>(*func.getType()));
-  function_ = llvm::Function::Create(type, llvm::Function::ExternalLinkage, func.getName().str(), module_);
+  const FunctionType& func_type = dynamic_cast<const FunctionType&>(*func.getType());
+  FunctionABIInfo function_info = classifyFunctionType(func_type);
+  function_ = declareFunction(func);
+
+  llvm::BasicBlock *entry_block = llvm::BasicBlock::Create(context_, "entry", function_);
+  llvm::IRBuilder<> builder{entry_block};
+
+  indirect_args_.clear();
+  owned_maps_.clear();
+  return_info_ = function_info.returns;
+  return_slot_ = nullptr;
 
-  int index = 0;
-  for (auto &arg : function_->args()) {
-    ParamDecl *param = func.getParams()[index++].get();
-    arg.setName(param->getName().str());
-    named_values_[param->getName()] = &arg;
+  auto arg_it = function_->arg_begin();
+  if (return_info_.kind == ABIArgInfo::Kind::Indirect) {
+    arg_it->setName("result");
+    return_slot_ = &*arg_it++;
   }
 
-  llvm::BasicBlock *entry_block = llvm::BasicBlock::Create(context_, "entry", function_);
+  for (size_t index = 0; index < func.getParams().size(); index++) {
+    ParamDecl *param = func.getParams()[index].get();
+    const ABIArgInfo &info = function_info.params[index];
+    switch (info.kind) {
+      case ABIArgInfo::Kind::Direct:
+        arg_it->setName(param->getName().str());
+        named_values_[param->getName()] = &*arg_it++;
+        break;
+      case ABIArgInfo::Kind::Indirect:
+        arg_it->setName(param->getName().str());
+        indirect_args_.insert(&*arg_it);
+        named_values_[param->getName()] = &*arg_it++;
+        break;
+      case ABIArgInfo::Kind::Coerce: {
+        // the pieces are reassembled in memory, so that the parameter is
+        // accessed in the same way as one passed by pointer
+        llvm::AllocaInst* alloca = builder.CreateAlloca(info.getCoercedType(context_), 0, param->getName().str());
+        for (unsigned piece = 0; piece < info.pieces.size(); piece++) {
+          builder.CreateStore(&*arg_it++, builder.CreateStructGEP(alloca, piece));
+        }
+        llvm::Type* param_type = llvm::PointerType::getUnqual(transformType(*param->getType()));
+        llvm::Value* param_loc = builder.CreateBitCast(alloca, param_type);
+        indirect_args_.insert(param_loc);
+        named_values_[param->getName()] = param_loc;
+        break;
+      }
+    }
+  }
 
   transformCompoundStmt(func.getBlockStmt(), entry_block);
 
   return function_;
 }
 
+void LLVMTransformer::transformReferencedFunctions() {
+  // a body may call further functions, which are added to the map while it
+  // is transformed, so the search starts over after each function
+  auto is_missing = [](const std::pair<const FuncDecl* const, llvm::Function*> &entry) {
+    return entry.second->isDeclaration() && entry.second->hasInternalLinkage();
+  };
+  auto missing = std::find_if(functions_.begin(), functions_.end(), is_missing);
+  while (missing != functions_.end()) {
+    transformFunction(*missing->first);
+    missing = std::find_if(functions_.begin(), functions_.end(), is_missing);
+  }
+}
+
+llvm::Function* LLVMTransformer::declareFunction(const FuncDecl &func) {
+  auto function_it = functions_.find(&func);
+  if (function_it != functions_.end()) return function_it->second;
+
+  const FunctionType& func_type = dynamic_cast<const FunctionType&>(*func.getType());
+  FunctionABIInfo function_info = classifyFunctionType(func_type);
+  llvm::FunctionType* type = transformFunctionType(func_type);
+  // inline functions are not exported, so that they are removed once all of
+  // their calls have been inlined
+  bool is_internal = func.isInstance() || func.getFuncAttributes().is_inline;
+  auto linkage = is_internal ? llvm::Function::InternalLinkage : llvm::Function::ExternalLinkage;
+  llvm::Function* function = llvm::Function::Create(type, linkage, func.getSymbolName(), module_);
+  addABIAttributes(*function, function_info, byvalIndices(function_info));
+
+  // the attributes are attached to the current function, which is restored
+  // since a callee may be declared while its caller is transformed
+  llvm::Function* current_function = function_;
+  function_ = function;
+  transformFunctionAttributes(func, function_info);
+  function_ = current_function;
+
+  functions_[&func] = function;
+  return function;
+}
+
+void LLVMTransformer::transformFunctionAttributes(const FuncDecl &func, const FunctionABIInfo &function_info) {
+  // the language has no exceptions, so no function unwinds
+  function_->addFnAttr(llvm::Attribute::NoUnwind);
+  if (func.willReturn()) function_->addFnAttr(llvm::Attribute::WillReturn);
+
+  // the optimization hints written before the function. Hot functions are
+  // grouped in the .text.hot section and cold ones in .text.unlikely, so that
+  // the code which runs most often shares the fewest pages.
+  const FuncAttributes &attributes = func.getFuncAttributes();
+  if (attributes.is_inline) function_->addFnAttr(llvm::Attribute::AlwaysInline);
+  if (attributes.is_noinline) function_->addFnAttr(llvm::Attribute::NoInline);
+  if (attributes.is_hot) {
+    function_->addFnAttr(llvm::Attribute::InlineHint);
+    function_->setSectionPrefix(".hot");
+  }
+  if (attributes.is_cold) {
+    function_->addFnAttr(llvm::Attribute::Cold);
+    function_->addFnAttr(llvm::Attribute::OptimizeForSize);
+    function_->setSectionPrefix(".unlikely");
+  }
+
+  // a result returned in memory is written through the 'sret' pointer, and
+  // parameters passed in memory are read through their 'byval' pointer
+  bool has_byval = std::any_of(function_info.params.begin(), function_info.params.end(), [](const ABIArgInfo &info) {
+    return info.kind == ABIArgInfo::Kind::Indirect;
+  });
+  bool reads = func.readsMemory() || has_byval;
+  bool writes = func.writesMemory() || function_info.returns.kind == ABIArgInfo::Kind::Indirect;
+  if (!reads && !writes) {
+    function_->addFnAttr(llvm::Attribute::ReadNone);
+  } else {
+    if (!writes) function_->addFnAttr(llvm::Attribute::ReadOnly);
+    if (func.accessesArgMemoryOnly()) function_->addFnAttr(llvm::Attribute::ArgMemOnly);
+  }
+
+  const llvm::DataLayout &data_layout = module_->getDataLayout();
+  std::vector<unsigned> arg_indices = argIndices(function_info);
+  for (size_t i = 0; i < func.getParams().size(); i++) {
+    const ParamDecl &param = *func.getParams()[i];
+    const ABIArgInfo &info = function_info.params[i];
+    const Type *type = param.getType()->getCanonicalType();
+    unsigned index = arg_indices[i];
+
+    if (const ReferenceType *ref_type = dynamic_cast<const ReferenceType*>(type)) {
+      if (info.kind != ABIArgInfo::Kind::Direct) continue;
+      // references are always taken from a location, so they are never null
+      function_->addParamAttr(index, llvm::Attribute::NonNull);
+      uint64_t size = data_layout.getTypeAllocSize(transformType(*ref_type->getReferencedType()));
+      if (size > 0) function_->addDereferenceableParamAttr(index, size);
+    } else if (type->is<SliceType>()) {
+      // the attributes describe the data pointer, which is the first piece
+      if (info.kind != ABIArgInfo::Kind::Coerce || !info.pieces.front()->isPointerTy()) continue;
+    } else continue;
+
+    if (param.isReadOnly()) function_->addParamAttr(index, llvm::Attribute::ReadOnly);
+    if (param.isNoAlias()) function_->addParamAttr(index, llvm::Attribute::NoAlias);
+  }
+}
+
 llvm::Constant* LLVMTransformer::transformConstantTupleExpr(const TupleExpr& tuple_expr) {
   std::vector<llvm::Constant*> elements;
   for (auto &element: tuple_expr.elements()) {
     elements.push_back(transformConstant(*element));
   }
-  return llvm::ConstantStruct::get(transformStructType(*dynamic_cast<const TupleType*>(tuple_expr.type())), elements);
+  return llvm::ConstantStruct::get(llvm::cast<llvm::StructType>(transformType(*tuple_expr.type())), elements);
 }
 
 llvm::Constant* LLVMTransformer::transformConstantListExpr(const ListExpr& list) {
   const ListType* list_type = dynamic_cast<const ListType*>(list.getType());
-  llvm::ArrayType *array_type =  llvm::ArrayType::get(transformType(*list_type->element_type()), list.elements().size());
   std::vector<llvm::Constant*> elements;
 
   for (auto &element: list.elements()) {
     elements.push_back(transformConstant(*element));
   }
-  return llvm::ConstantArray::get(array_type, elements);
+  return transformConstantArray(*list_type->element_type(), elements);
 }
 
-llvm::Value* LLVMTransformer::transformFunctionCall(const FunctionCall& call, llvm::BasicBlock* current_block) {
+llvm::Constant* LLVMTransformer::transformConstantArray(const Type& element_type, const std::vector<llvm::Constant*>& elements) {
+  const StructType* struct_type = dynamic_cast<const StructType*>(element_type.getCanonicalType());
+  if (!struct_type || !struct_type->getLayout().is_soa) {
+    llvm::ArrayType *array_type = llvm::ArrayType::get(transformType(element_type), elements.size());
+    return llvm::ConstantArray::get(array_type, elements);
+  }
+
+  // the elements of an array of @soa structs are transposed into an array
+  // for each field
+  std::vector<llvm::Constant*> fields;
+  for (unsigned member = 0; member < struct_type->elements().size(); member++) {
+    unsigned index = memberIndex(*struct_type, member);
+    std::vector<llvm::Constant*> field_elements;
+    for (llvm::Constant* element: elements) {
+      field_elements.push_back(element->getAggregateElement(index));
+    }
+    llvm::Type* field_type = transformType(*struct_type->type_of_member_at(member));
+    fields.push_back(llvm::ConstantArray::get(llvm::ArrayType::get(field_type, elements.size()), field_elements));
+  }
+  return llvm::ConstantStruct::getAnon(context_, fields);
+}
+
+llvm::Constant* LLVMTransformer::transformConstantAggregate(const Expr& expr) {
+  if (const StringExpr *string_expr = dynamic_cast<const StringExpr*>(&expr)) {
+    return llvm::ConstantDataArray::getString(context_, string_expr->getString());
+  } else if (const ListExpr *list_expr = dynamic_cast<const ListExpr*>(&expr)) {
+    return transformConstantListExpr(*list_expr);
+  } else if (const TupleExpr *tuple_expr = dynamic_cast<const TupleExpr*>(&expr)) {
+    return transformConstantTupleExpr(*tuple_expr);
+  } else {
+    return nullptr;
+  }
+}
+
+llvm::GlobalVariable* LLVMTransformer::getConstantGlobal(llvm::Constant* constant) {
+  auto global_it = constant_globals_.find(constant);
+  if (global_it != constant_globals_.end()) return global_it->second;
+
+  llvm::ConstantDataSequential* data = llvm::dyn_cast<llvm::ConstantDataSequential>(constant);
+  std::string name = data && data->isString() ? ".str" : ".const";
+
+  // the address of the global is never compared, so equal constants may be
+  // merged by the linker as well
+  llvm::GlobalVariable* global = new llvm::GlobalVariable(
+    *module_, constant->getType(), true, llvm::GlobalValue::PrivateLinkage, constant, name
+  );
+  global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  global->setAlignment(module_->getDataLayout().getABITypeAlignment(constant->getType()));
+
+  constant_globals_[constant] = global;
+  return global;
+}
+
+// returns true if the call is to one of the atomic builtins, whose first
+// argument is a reference to an atomic, except for fence
+static bool isAtomicBuiltin(const FunctionCall& call) {
+  if (call.getFunctionName() == StringRef{"fence"}) return true;
+  if (call.getArguments().empty()) return false;
+  const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(call.getArguments()[0]->getType()->getCanonicalType());
+  return ref_type && ref_type->getReferencedType()->getCanonicalType()->is<AtomicType>();
+}
+
+// returns the ordering of an atomic builtin, which is given by its last
+// argument if that is an ordering rather than a value
+static llvm::AtomicOrdering atomicOrdering(const FunctionCall& call) {
+  AtomicType::Order order = AtomicType::Order::SequentiallyConsistent;
+  if (!call.getArguments().empty()) {
+    const IdentifierExpr* order_expr = call.getArguments().back()->as<IdentifierExpr>();
+    if (order_expr && !order_expr->getDecl()) AtomicType::getOrder(order_expr->lexeme(), order);
+  }
+  switch (order) {
+    case AtomicType::Order::Relaxed: return llvm::AtomicOrdering::Monotonic;
+    case AtomicType::Order::Acquire: return llvm::AtomicOrdering::Acquire;
+    case AtomicType::Order::Release: return llvm::AtomicOrdering::Release;
+    case AtomicType::Order::AcquireRelease: return llvm::AtomicOrdering::AcquireRelease;
+    case AtomicType::Order::SequentiallyConsistent: return llvm::AtomicOrdering::SequentiallyConsistent;
+  }
+  return llvm::AtomicOrdering::SequentiallyConsistent;
+}
+
+llvm::Value* LLVMTransformer::transformFunctionCall(
+  const FunctionCall& call
+, llvm::BasicBlock* current_block
+, llvm::Value* result_slot
+) {
   llvm::IRBuilder<> builder{current_block};
 
   if (call.getFunctionName() == StringRef{"Double"}) {
@@ -289,30 +1054,571 @@ llvm::Value* LLVMTransformer::transformFunctionCall(const FunctionCall& call, ll
     llvm::Value *arg1 = transformExpr(*call.getArguments()[0], current_block);
     llvm::Type *t = transformType(*IntegerType::getInstance());
     return builder.CreateFPToSI(arg1, t);
+  } else if (call.getFunctionName() == StringRef{"len"} && !call.getDecl()) {
+    return transformLenCall(call, current_block);
+  } else if (!call.getDecl() && Type::getBuiltinType(call.getFunctionName())) {
+    const Expr& arg = *call.getArguments()[0];
+    return transformNumericCast(transformExpr(arg, current_block), *arg.getType(), *call.getType(), current_block);
+  } else if (call.getFunctionName() == StringRef{"prefetch"} && !call.getDecl()) {
+    return transformIntrinsicCall(call, current_block);
+  } else if (!call.getDecl() && isAtomicBuiltin(call)) {
+    return transformAtomicBuiltin(call, current_block);
+  } else if (!call.getDecl() && !call.getArguments().empty() && call.getArguments()[0]->isType<MapType>()) {
+    return transformMapBuiltin(call, current_block);
+  } else if (!call.getDecl() && (call.getFunctionName() == StringRef{"new"}
+  || call.getFunctionName() == StringRef{"alloc"} || call.getFunctionName() == StringRef{"free"})) {
+    return transformAllocationBuiltin(call, current_block);
+  } else if (!call.getDecl()) {
+    // all other builtins without a declaration operate on vectors
+    return transformVectorBuiltin(call, current_block);
+  } else if (dynamic_cast<const BasicDecl*>(call.getDecl())) {
+    // calls which resolve to a builtin declaration rather than a function are
+    // intrinsics
+    return transformIntrinsicCall(call, current_block);
   }
 
   //  return named_values_[identifierExpr.getLexeme()];
-  llvm::Function *CalleeF = module_->getFunction(call.getFunctionName().str());
+  const FuncDecl *callee_decl = dynamic_cast<const FuncDecl*>(call.getDecl());
+  const ExternFuncDecl *extern_decl = dynamic_cast<const ExternFuncDecl*>(call.getDecl());
+  llvm::Function *CalleeF = callee_decl ? declareFunction(*callee_decl)
+    : extern_decl ? transformExternalFunctionDecl(*extern_decl)
+    : module_->getFunction(call.getFunctionName().str());
   if (!CalleeF) {
     throw CompilerException(call.getFunctionName().start, "unknown function referenced");
   }
 
 
-   std::vector<llvm::Value*> ArgsV;
-   for (unsigned i = 0, e = call.getArguments().size(); i != e; ++i) {
-     ArgsV.push_back(transformExpr(*call.getArguments()[i],current_block));
-     if (!ArgsV.back())
-       return nullptr;
-   }
+  // arguments are converted to the declared parameter types, so that arrays
+  // may be passed where slices are expected
+  const FunctionType* callee_type = call.getDecl()
+    ? dynamic_cast<const FunctionType*>(call.getDecl()->getType()->getCanonicalType())
+    : nullptr;
+
+  // variadic arguments are passed according to their own type
+  ABIInfo abi_info{*module_};
+  FunctionABIInfo function_info = callee_type ? classifyFunctionType(*callee_type) : FunctionABIInfo{};
+  for (size_t i = function_info.params.size(); i < call.getArguments().size(); i++) {
+    function_info.params.push_back(abi_info.classify(transformType(*call.getArguments()[i]->getType())));
+  }
+
+  std::vector<llvm::Value*> ArgsV;
+  std::vector<unsigned> byval_indices;
+
+  llvm::Value* result_loc = nullptr;
+  if (function_info.returns.kind == ABIArgInfo::Kind::Indirect) {
+    llvm::Type* result_type = CalleeF->getFunctionType()->getParamType(0)->getPointerElementType();
+    result_loc = result_slot ? result_slot : createEntryBlockAlloca(result_type, "result");
+    ArgsV.push_back(result_loc);
+  }
+
+  for (unsigned i = 0, e = call.getArguments().size(); i != e; ++i) {
+    const Expr& arg = *call.getArguments()[i];
+    const ABIArgInfo& info = function_info.params[i];
+    const Type& param_type = callee_type && i < callee_type->getParamTypes().size()
+      ? *callee_type->getParam(i)
+      : *arg.getType();
+
+    switch (info.kind) {
+      case ABIArgInfo::Kind::Direct:
+        ArgsV.push_back(transformExprAs(arg, param_type, current_block));
+        break;
+      case ABIArgInfo::Kind::Indirect:
+        // the callee receives its own copy of a byval argument, so left values
+        // can be passed in place
+        byval_indices.push_back(ArgsV.size());
+        ArgsV.push_back(transformExprAddress(arg, current_block));
+        break;
+      case ABIArgInfo::Kind::Coerce: {
+        std::vector<llvm::Value*> pieces = coerceToPieces(transformExpr(arg, current_block), info, current_block);
+        ArgsV.insert(ArgsV.end(), pieces.begin(), pieces.end());
+        break;
+      }
+    }
+  }
+
+  llvm::CallInst* call_inst = CalleeF->getReturnType()->isVoidTy()
+    ? builder.CreateCall(CalleeF, ArgsV)
+    : builder.CreateCall(CalleeF, ArgsV, "calltmp");
+  addABIAttributes(*call_inst, function_info, byval_indices);
+
+  // a guaranteed tail call is returned as it is, see transformReturnStmt
+  if (call.getTailCall() == FunctionCall::TailCall::Guaranteed) {
+    call_inst->setTailCallKind(llvm::CallInst::TCK_MustTail);
+    return call_inst;
+  }
+  // an indirect result is written to an alloca of the caller, which the
+  // callee of a tail call may not access
+  if (call.getTailCall() == FunctionCall::TailCall::Tail && function_info.returns.kind != ABIArgInfo::Kind::Indirect) {
+    call_inst->setTailCallKind(llvm::CallInst::TCK_Tail);
+  }
+
+  switch (function_info.returns.kind) {
+    case ABIArgInfo::Kind::Direct:
+      return call_inst;
+    case ABIArgInfo::Kind::Indirect:
+      return result_slot ? nullptr : builder.CreateLoad(result_loc);
+    case ABIArgInfo::Kind::Coerce:
+      return coerceFromPieces(call_inst, transformType(*callee_type->getReturnType()), function_info.returns, current_block);
+  }
+  return call_inst;
+}
+
+llvm::Value* LLVMTransformer::transformLenCall(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  const Expr& arg = *call.getArguments()[0];
+
+  // the length of an array is part of its type
+  const Type* type = arg.getType()->getCanonicalType();
+  if (const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(type)) {
+    type = ref_type->getReferencedType()->getCanonicalType();
+  }
+  if (const ListType* list_type = dynamic_cast<const ListType*>(type)) {
+    return llvm::ConstantInt::get(llvm::Type::getInt64Ty(context_), list_type->size());
+  }
+
+  // the runtime library counts the keys of a map
+  if (type->getKind() == Type::Kind::MapType) {
+    return builder.CreateCall(getMapFunction("__bulat_map_len"), {transformExpr(arg, current_block)});
+  }
+
+  // the length of a slice is stored alongside its data pointer
+  return builder.CreateExtractValue(transformExpr(arg, current_block), 1);
+}
+
+llvm::Function* LLVMTransformer::getMapFunction(const std::string& name) {
+  if (llvm::Function* existing = module_->getFunction(name)) return existing;
+
+  llvm::Type* map_type = transformType(*MapType::getInstance(IntegerType::getInstance(), IntegerType::getInstance()));
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(context_);
+  llvm::FunctionType* type;
+  if (name == "__bulat_map_new") {
+    type = llvm::FunctionType::get(map_type, {int64_type, int64_type}, false);
+  } else if (name == "__bulat_map_free") {
+    type = llvm::FunctionType::get(llvm::Type::getVoidTy(context_), {map_type}, false);
+  } else if (name == "__bulat_map_len") {
+    type = llvm::FunctionType::get(int64_type, {map_type}, false);
+  } else if (name == "__bulat_map_erase") {
+    type = llvm::FunctionType::get(llvm::Type::getInt1Ty(context_), {map_type, int64_type, int64_type}, false);
+  } else {
+    // find and insert return a pointer to the value of the key
+    type = llvm::FunctionType::get(llvm::Type::getInt8PtrTy(context_), {map_type, int64_type, int64_type}, false);
+  }
+
+  llvm::Function* function = llvm::Function::Create(type, llvm::Function::ExternalLinkage, name, module_);
+  function->addFnAttr(llvm::Attribute::NoUnwind);
+  if (name == "__bulat_map_find" || name == "__bulat_map_len") {
+    function->addFnAttr(llvm::Attribute::ReadOnly);
+  }
+  if (name == "__bulat_map_erase") {
+    // a C bool is returned zero extended
+    function->addAttribute(llvm::AttributeList::ReturnIndex, llvm::Attribute::ZExt);
+  }
+  return function;
+}
+
+void LLVMTransformer::freeOwnedMaps(size_t kept, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  for (size_t i = owned_maps_.size(); i > kept; i--) {
+    builder.CreateCall(getMapFunction("__bulat_map_free"), {builder.CreateLoad(owned_maps_[i - 1])});
+  }
+}
+
+// The runtime library never hashes keys itself. 64 bit keys are mixed with the
+// finalizer of MurmurHash3. Narrower keys only need a multiplication by the
+// golden ratio, whose high bits are folded into the low bits which the table
+// matches against its control bytes.
+std::pair<llvm::Value*, llvm::Value*> LLVMTransformer::transformMapKey(const Expr& key, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Value* value = transformExpr(key, current_block);
+  unsigned bits = value->getType()->getIntegerBitWidth();
+  llvm::Value* key_bits = builder.CreateZExt(value, builder.getInt64Ty());
+
+  llvm::Value* hash = key_bits;
+  if (bits <= 32) {
+    hash = builder.CreateMul(hash, builder.getInt64(0x9E3779B97F4A7C15));
+    hash = builder.CreateXor(hash, builder.CreateLShr(hash, 32));
+  } else {
+    hash = builder.CreateXor(hash, builder.CreateLShr(hash, 33));
+    hash = builder.CreateMul(hash, builder.getInt64(0xff51afd7ed558ccd));
+    hash = builder.CreateXor(hash, builder.CreateLShr(hash, 33));
+    hash = builder.CreateMul(hash, builder.getInt64(0xc4ceb9fe1a85ec53));
+    hash = builder.CreateXor(hash, builder.CreateLShr(hash, 33));
+  }
+  return {key_bits, hash};
+}
+
+llvm::Value* LLVMTransformer::transformMapBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  StringRef name = call.getFunctionName();
+  const auto& args = call.getArguments();
+  const MapType* map_type = dynamic_cast<const MapType*>(args[0]->getType()->getCanonicalType());
+  const Type& value_type = *map_type->getValueType();
+  llvm::Type* value_ptr_type = llvm::PointerType::getUnqual(transformType(value_type));
+
+  llvm::Value* map = transformExpr(*args[0], current_block);
+  std::pair<llvm::Value*, llvm::Value*> key = transformMapKey(*args[1], current_block);
+
+  if (name == StringRef{"insert"}) {
+    // the value is computed before the table may grow
+    llvm::Value* value = transformExprAs(*args[2], value_type, current_block);
+    llvm::Value* slot = builder.CreateCall(getMapFunction("__bulat_map_insert"), {map, key.first, key.second});
+    builder.CreateStore(value, builder.CreatePointerCast(slot, value_ptr_type));
+    return llvm::UndefValue::get(transformType(*call.getType()));
+  } else if (name == StringRef{"find"}) {
+    // a missing key reads the value from a zeroed global rather than
+    // branching around the load
+    llvm::Value* slot = builder.CreateCall(getMapFunction("__bulat_map_find"), {map, key.first, key.second});
+    slot = builder.CreatePointerCast(slot, value_ptr_type);
+    llvm::Value* found = builder.CreateICmpNE(slot, llvm::Constant::getNullValue(value_ptr_type));
+    llvm::Value* zero = getConstantGlobal(llvm::Constant::getNullValue(transformType(value_type)));
+    return builder.CreateLoad(builder.CreateSelect(found, slot, zero));
+  } else if (name == StringRef{"contains"}) {
+    llvm::Value* slot = builder.CreateCall(getMapFunction("__bulat_map_find"), {map, key.first, key.second});
+    return builder.CreateICmpNE(slot, llvm::Constant::getNullValue(slot->getType()));
+  } else {
+    return builder.CreateCall(getMapFunction("__bulat_map_erase"), {map, key.first, key.second});
+  }
+}
+
+llvm::Value* LLVMTransformer::transformAtomicBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  StringRef name = call.getFunctionName();
+  const auto& args = call.getArguments();
+  llvm::AtomicOrdering ordering = atomicOrdering(call);
+  if (name == StringRef{"fence"}) {
+    builder.CreateFence(ordering);
+    return llvm::UndefValue::get(transformType(*call.getType()));
+  }
+
+  const ReferenceType* ref_type = dynamic_cast<const ReferenceType*>(args[0]->getType()->getCanonicalType());
+  const AtomicType* atomic_type = dynamic_cast<const AtomicType*>(ref_type->getReferencedType()->getCanonicalType());
+  const Type& value_type = *atomic_type->getValueType();
+  llvm::Value* atomic = transformExpr(*args[0], current_block);
+  // atomic loads and stores need an explicit alignment, which is the natural
+  // alignment of the value since atomics are never packed
+  unsigned align = module_->getDataLayout().getABITypeAlignment(transformType(value_type));
+
+  if (name == StringRef{"atomic_load"}) {
+    llvm::LoadInst* load = builder.CreateLoad(atomic);
+    load->setAtomic(ordering);
+    load->setAlignment(align);
+    return load;
+  } else if (name == StringRef{"atomic_store"}) {
+    llvm::StoreInst* store = builder.CreateStore(transformExpr(*args[1], current_block), atomic);
+    store->setAtomic(ordering);
+    store->setAlignment(align);
+    return llvm::UndefValue::get(transformType(*call.getType()));
+  } else if (name == StringRef{"compare_swap"}) {
+    llvm::Value* expected = transformExpr(*args[1], current_block);
+    llvm::Value* desired = transformExpr(*args[2], current_block);
+    // a failed exchange only loads, so it can not release
+    llvm::AtomicOrdering failure = llvm::AtomicCmpXchgInst::getStrongestFailureOrdering(ordering);
+    llvm::Value* exchange = builder.CreateAtomicCmpXchg(atomic, expected, desired, ordering, failure);
+    return builder.CreateExtractValue(exchange, 0);
+  }
+
+  bool is_unsigned = isUnsigned(value_type);
+  llvm::AtomicRMWInst::BinOp op = llvm::AtomicRMWInst::Xchg;
+  if (name == StringRef{"fetch_add"}) op = llvm::AtomicRMWInst::Add;
+  else if (name == StringRef{"fetch_sub"}) op = llvm::AtomicRMWInst::Sub;
+  else if (name == StringRef{"fetch_and"}) op = llvm::AtomicRMWInst::And;
+  else if (name == StringRef{"fetch_or"}) op = llvm::AtomicRMWInst::Or;
+  else if (name == StringRef{"fetch_xor"}) op = llvm::AtomicRMWInst::Xor;
+  else if (name == StringRef{"fetch_min"}) op = is_unsigned ? llvm::AtomicRMWInst::UMin : llvm::AtomicRMWInst::Min;
+  else if (name == StringRef{"fetch_max"}) op = is_unsigned ? llvm::AtomicRMWInst::UMax : llvm::AtomicRMWInst::Max;
+  return builder.CreateAtomicRMW(op, atomic, transformExpr(*args[1], current_block), ordering);
+}
+
+llvm::Function* LLVMTransformer::getAllocationFunction(const std::string& name) {
+  if (llvm::Function* existing = module_->getFunction(name)) return existing;
+
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(context_);
+  llvm::Type* memory_type = llvm::Type::getInt8PtrTy(context_);
+  llvm::FunctionType* type;
+  if (name == "__bulat_alloc") {
+    type = llvm::FunctionType::get(memory_type, {int64_type, int64_type}, false);
+  } else if (name == "__bulat_alloc_array") {
+    type = llvm::FunctionType::get(memory_type, {int64_type, int64_type, int64_type, memory_type}, false);
+  } else if (name == "__bulat_free") {
+    type = llvm::FunctionType::get(llvm::Type::getVoidTy(context_), {memory_type, int64_type, int64_type}, false);
+  } else {
+    // pushing and popping allocators
+    type = llvm::FunctionType::get(llvm::Type::getVoidTy(context_), false);
+  }
+
+  llvm::Function* function = llvm::Function::Create(type, llvm::Function::ExternalLinkage, name, module_);
+  function->addFnAttr(llvm::Attribute::NoUnwind);
+  if (name == "__bulat_alloc" || name == "__bulat_alloc_array") {
+    // like malloc, the returned memory is not reachable through any other
+    // pointer
+    function->addAttribute(llvm::AttributeList::ReturnIndex, llvm::Attribute::NoAlias);
+  }
+  return function;
+}
+
+llvm::Value* LLVMTransformer::transformAllocationBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  StringRef name = call.getFunctionName();
+  const Expr& arg = *call.getArguments()[0];
+  const llvm::DataLayout &data_layout = module_->getDataLayout();
+
+  // the size and alignment of a value of the type
+  auto layoutOf = [&](llvm::Type* type) {
+    return std::make_pair(
+      builder.getInt64(data_layout.getTypeAllocSize(type))
+    , builder.getInt64(data_layout.getABITypeAlignment(type))
+    );
+  };
+
+  if (name == StringRef{"new"}) {
+    llvm::Value* value = transformExpr(arg, current_block);
+    std::pair<llvm::Value*, llvm::Value*> layout = layoutOf(value->getType());
+    llvm::Value* memory = builder.CreateCall(getAllocationFunction("__bulat_alloc"), {layout.first, layout.second});
+    llvm::Value* ptr = builder.CreatePointerCast(memory, llvm::PointerType::getUnqual(value->getType()));
+    builder.CreateStore(value, ptr);
+    return ptr;
+  } else if (name == StringRef{"alloc"}) {
+    // the runtime copies the initial value into every element
+    llvm::Value* value = transformExpr(arg, current_block);
+    llvm::AllocaInst* init = createEntryBlockAlloca(value->getType(), "init");
+    builder.CreateStore(value, init);
+    llvm::Value* count = transformIndex(*call.getArguments()[1], current_block);
+    std::pair<llvm::Value*, llvm::Value*> layout = layoutOf(value->getType());
+    llvm::Value* memory = builder.CreateCall(getAllocationFunction("__bulat_alloc_array"), {
+      layout.first, layout.second, count, builder.CreatePointerCast(init, builder.getInt8PtrTy())
+    });
+    llvm::Type* slice_type = transformType(*call.getType());
+    llvm::Value* slice = llvm::UndefValue::get(slice_type);
+    slice = builder.CreateInsertValue(slice, builder.CreatePointerCast(memory, llvm::PointerType::getUnqual(value->getType())), 0);
+    return builder.CreateInsertValue(slice, count, 1);
+  }
 
-   return builder.CreateCall(CalleeF, ArgsV, "calltmp");
+  // the runtime is told the size of the freed memory, so that allocators
+  // need not store it
+  llvm::Value* value = transformExpr(arg, current_block);
+  llvm::Value* ptr = value;
+  llvm::Value* size;
+  llvm::Value* align;
+  if (arg.isType<SliceType>()) {
+    ptr = builder.CreateExtractValue(value, 0);
+    std::tie(size, align) = layoutOf(ptr->getType()->getPointerElementType());
+    size = builder.CreateMul(size, builder.CreateExtractValue(value, 1));
+  } else {
+    std::tie(size, align) = layoutOf(ptr->getType()->getPointerElementType());
+  }
+  builder.CreateCall(getAllocationFunction("__bulat_free"), {
+    builder.CreatePointerCast(ptr, builder.getInt8PtrTy()), size, align
+  });
+  return llvm::UndefValue::get(transformType(*call.getType()));
+}
+
+llvm::Value* LLVMTransformer::transformNumericCast(llvm::Value* value, const Type& from, const Type& to, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Type* type = transformType(to);
+  if (from.isIntegerType() && to.isIntegerType()) {
+    return builder.CreateIntCast(value, type, !isUnsigned(from));
+  } else if (from.isIntegerType()) {
+    return isUnsigned(from) ? builder.CreateUIToFP(value, type) : builder.CreateSIToFP(value, type);
+  } else if (to.isIntegerType()) {
+    return isUnsigned(to) ? builder.CreateFPToUI(value, type) : builder.CreateFPToSI(value, type);
+  } else {
+    return builder.CreateFPCast(value, type);
+  }
+}
+
+llvm::Value* LLVMTransformer::transformIndex(const Expr& index, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Value* value = transformExpr(index, current_block);
+  return builder.CreateIntCast(value, llvm::Type::getInt64Ty(context_), !isUnsigned(*index.getType()));
+}
+
+llvm::Value* LLVMTransformer::transformIntrinsicCall(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  StringRef name = call.getFunctionName();
+  std::vector<llvm::Value*> args;
+  for (auto& arg: call.getArguments()) {
+    args.push_back(transformExpr(*arg, current_block));
+  }
+
+  // most intrinsics are overloaded on the type of their first operand, which
+  // may be a vector
+  auto callIntrinsic = [&](llvm::Intrinsic::ID id, std::vector<llvm::Value*> operands) {
+    llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_, id, {args[0]->getType()});
+    return builder.CreateCall(intrinsic, operands);
+  };
+
+  if (name == StringRef{"popcount"}) {
+    return callIntrinsic(llvm::Intrinsic::ctpop, {args[0]});
+  } else if (name == StringRef{"clz"}) {
+    // the count of zero is the bit width rather than undefined
+    return callIntrinsic(llvm::Intrinsic::ctlz, {args[0], builder.getFalse()});
+  } else if (name == StringRef{"ctz"}) {
+    return callIntrinsic(llvm::Intrinsic::cttz, {args[0], builder.getFalse()});
+  } else if (name == StringRef{"bswap"}) {
+    return callIntrinsic(llvm::Intrinsic::bswap, {args[0]});
+  } else if (name == StringRef{"rotl"}) {
+    // a funnel shift of a value with itself is a rotation, and like the
+    // shifts the amount is taken modulo the bit width
+    return callIntrinsic(llvm::Intrinsic::fshl, {args[0], args[0], args[1]});
+  } else if (name == StringRef{"rotr"}) {
+    return callIntrinsic(llvm::Intrinsic::fshr, {args[0], args[0], args[1]});
+  } else if (name == StringRef{"sqrt"}) {
+    return callIntrinsic(llvm::Intrinsic::sqrt, {args[0]});
+  } else if (name == StringRef{"fma"}) {
+    return callIntrinsic(llvm::Intrinsic::fma, {args[0], args[1], args[2]});
+  } else if (name == StringRef{"min"} || name == StringRef{"max"}) {
+    bool is_min = name == StringRef{"min"};
+    if (args[0]->getType()->isFPOrFPVectorTy()) {
+      return callIntrinsic(is_min ? llvm::Intrinsic::minnum : llvm::Intrinsic::maxnum, {args[0], args[1]});
+    }
+    // the backends select a single min or max instruction for this pattern
+    bool is_unsigned = isUnsigned(*call.getArguments()[0]->getType());
+    llvm::Value* is_less = is_unsigned
+      ? builder.CreateICmpULT(args[0], args[1])
+      : builder.CreateICmpSLT(args[0], args[1]);
+    return is_min
+      ? builder.CreateSelect(is_less, args[0], args[1])
+      : builder.CreateSelect(is_less, args[1], args[0]);
+  } else if (name == StringRef{"expect"}) {
+    return callIntrinsic(llvm::Intrinsic::expect, {args[0], args[1]});
+  } else if (name == StringRef{"likely"} || name == StringRef{"unlikely"}) {
+    // conditions of branches are hinted with branch weights instead, see
+    // stripBranchHint
+    return callIntrinsic(llvm::Intrinsic::expect, {args[0], builder.getInt1(name == StringRef{"likely"})});
+  } else if (name == StringRef{"assume"}) {
+    return builder.CreateCall(llvm::Intrinsic::getDeclaration(module_, llvm::Intrinsic::assume), {args[0]});
+  } else if (name == StringRef{"prefetch"}) {
+    // a read with the highest temporal locality from the data cache
+    llvm::Value* address = builder.CreatePointerCast(args[0], builder.getInt8PtrTy());
+    return builder.CreateCall(
+      llvm::Intrinsic::getDeclaration(module_, llvm::Intrinsic::prefetch)
+    , {address, builder.getInt32(0), builder.getInt32(3), builder.getInt32(1)}
+    );
+  }
+
+  std::stringstream ss;
+  ss << "not implemented: intrinsic " << name;
+  throw CompilerException(call.location(), ss.str());
+}
+
+llvm::Value* LLVMTransformer::transformVectorBuiltin(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  StringRef name = call.getFunctionName();
+  const auto& args = call.getArguments();
+  const VectorType* result_type = dynamic_cast<const VectorType*>(call.getType()->getCanonicalType());
+
+  if (name == StringRef{"splat"}) {
+    return builder.CreateVectorSplat(result_type->size(), transformExpr(*args[0], current_block));
+  } else if (name == StringRef{"shuffle"}) {
+    // the mask indexes the lanes of both operands, and a single operand is
+    // shuffled with itself
+    llvm::Value* first = transformExpr(*args[0], current_block);
+    llvm::Value* second = args.size() == 3
+      ? transformExpr(*args[1], current_block)
+      : llvm::UndefValue::get(first->getType());
+    std::vector<uint32_t> mask;
+    for (auto& index: dynamic_cast<const ListExpr&>(*args.back()).elements()) {
+      mask.push_back(dynamic_cast<const IntegerExpr&>(*index).getInt());
+    }
+    return builder.CreateShuffleVector(first, second, mask);
+  } else if (name == StringRef{"select"}) {
+    llvm::Value* mask = transformExpr(*args[0], current_block);
+    llvm::Value* if_true = transformExpr(*args[1], current_block);
+    llvm::Value* if_false = transformExpr(*args[2], current_block);
+    return builder.CreateSelect(mask, if_true, if_false);
+  } else if (name == StringRef{"load"} || name == StringRef{"store"}) {
+    return transformVectorMemoryAccess(call, current_block);
+  }
+
+  // reductions
+  llvm::Value* vector = transformExpr(*args[0], current_block);
+  llvm::Type* lane_type = vector->getType()->getScalarType();
+  bool is_double = lane_type->isFloatingPointTy();
+  bool is_signed = !isUnsigned(*args[0]->getType());
+  if (name == StringRef{"reduce_add"}) {
+    // without fast-math flags the lanes are added in order, so the result
+    // matches a scalar loop exactly
+    return is_double
+      ? builder.CreateFAddReduce(llvm::ConstantFP::getNegativeZero(lane_type), vector)
+      : builder.CreateAddReduce(vector);
+  } else if (name == StringRef{"reduce_mul"}) {
+    return is_double
+      ? builder.CreateFMulReduce(llvm::ConstantFP::get(lane_type, 1.0), vector)
+      : builder.CreateMulReduce(vector);
+  } else if (name == StringRef{"reduce_min"}) {
+    return is_double ? builder.CreateFPMinReduce(vector) : builder.CreateIntMinReduce(vector, is_signed);
+  } else if (name == StringRef{"reduce_max"}) {
+    return is_double ? builder.CreateFPMaxReduce(vector) : builder.CreateIntMaxReduce(vector, is_signed);
+  } else if (name == StringRef{"reduce_and"}) {
+    return builder.CreateAndReduce(vector);
+  } else if (name == StringRef{"reduce_or"}) {
+    return builder.CreateOrReduce(vector);
+  }
+
+  throw CompilerException(call.getFunctionName().start, "unknown function referenced");
+}
+
+llvm::Value* LLVMTransformer::transformVectorMemoryAccess(const FunctionCall& call, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  const auto& args = call.getArguments();
+  const VectorType& vector_type = dynamic_cast<const VectorType&>(*call.getType()->getCanonicalType());
+
+  llvm::Value* data;
+  llvm::Value* length;
+  std::tie(data, length) = transformSequence(*args[0], current_block);
+
+  // both the first and the last accessed element are checked, which also
+  // rejects a last index which wraps around
+  llvm::Type* length_type = llvm::Type::getInt64Ty(context_);
+  llvm::Value* index = transformIndex(*args[1], current_block);
+  if (bounds_checking_) {
+    llvm::Value* last = builder.CreateAdd(index, llvm::ConstantInt::get(length_type, vector_type.size() - 1));
+    transformBoundsCheck(index, length, current_block);
+    transformBoundsCheck(last, length, current_block);
+  }
+
+  // the elements are only guaranteed to be aligned as scalars
+  llvm::Type* llvm_vector_type = transformType(vector_type);
+  llvm::Type* element_type = llvm_vector_type->getVectorElementType();
+  unsigned alignment = module_->getDataLayout().getABITypeAlignment(element_type);
+  llvm::Value* element = builder.CreateInBoundsGEP(data, index);
+  llvm::Value* vector_ptr = builder.CreateBitCast(element, llvm::PointerType::getUnqual(llvm_vector_type));
+
+  if (call.getFunctionName() == StringRef{"load"}) {
+    return builder.CreateAlignedLoad(vector_ptr, alignment);
+  }
+  llvm::Value* vector = transformExpr(*args[2], current_block);
+  builder.CreateAlignedStore(vector, vector_ptr, alignment);
+  return vector;
+}
+
+llvm::Value* LLVMTransformer::transformLaneAccess(const AccessorExpr& accessor, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+  const VectorType& vector_type = dynamic_cast<const VectorType&>(*accessor.identifier().getType()->getCanonicalType());
+  llvm::Value* vector = transformExpr(accessor.identifier(), current_block);
+
+  // literal lane indices are checked during type checking
+  if (accessor.hasStaticIndex()) {
+    return builder.CreateExtractElement(vector, (uint64_t)accessor.getMemberIndex());
+  }
+
+  llvm::Type* length_type = llvm::Type::getInt64Ty(context_);
+  llvm::Value* index = transformIndex(accessor.index(), current_block);
+  if (!accessor.isInBounds()) {
+    transformBoundsCheck(index, llvm::ConstantInt::get(length_type, vector_type.size()), current_block);
+  }
+  return builder.CreateExtractElement(vector, index);
 }
 
 llvm::Value* LLVMTransformer::transformIdentifierExpr(const IdentifierExpr& expr, llvm::BasicBlock* current_block) {
+  if (const ConstDecl *const_decl = dynamic_cast<const ConstDecl*>(expr.getDecl())) {
+    return transformConstantValue(*const_decl->getValue());
+  }
+
   auto map_it = named_values_.find(expr.lexeme());
   if (map_it != named_values_.end()) {
     llvm::IRBuilder<> builder{current_block};
-    if (expr.isLeftValue()) {
+    if (expr.isLeftValue() || indirect_args_.count(map_it->second)) {
       return builder.CreateLoad(map_it->second);
     } else {
       return map_it->second;
@@ -337,8 +1643,44 @@ llvm::Constant* LLVMTransformer::transformConstant(const Expr& expr) {
     return transformConstantListExpr(dynamic_cast<const ListExpr&>(expr));
   } else if (const TupleExpr *tuple_expr = dynamic_cast<const TupleExpr*>(&expr)) {
     return transformConstantTupleExpr(*tuple_expr);
+  } else if (const IdentifierExpr *id_expr = dynamic_cast<const IdentifierExpr*>(&expr)) {
+    if (const ConstDecl *const_decl = dynamic_cast<const ConstDecl*>(id_expr->getDecl())) {
+      return transformConstantValue(*const_decl->getValue());
+    }
+  }
+  throw CompilerException(nullptr, "array initializer only allowed for literals");
+}
+
+llvm::Constant* LLVMTransformer::transformConstantValue(const ConstantValue& value) {
+  const Type &type = *value.getType();
+  llvm::Type *llvm_type = transformType(type);
+  if (type.isDoubleType()) {
+    return llvm::ConstantFP::get(llvm_type, value.getReal());
+  } else if (llvm_type->isIntegerTy()) {
+    return llvm::ConstantInt::get(llvm_type, value.getBits());
+  }
+
+  std::vector<llvm::Constant*> elements;
+  for (const ConstantValue &element: value.elements()) {
+    elements.push_back(transformConstantValue(element));
+  }
+  if (type.getKind() == Type::Kind::VectorType) {
+    return llvm::ConstantVector::get(elements);
+  } else if (type.getKind() == Type::Kind::ListType) {
+    return transformConstantArray(*dynamic_cast<const ListType&>(type).element_type(), elements);
+  } else if (const StructType *struct_type = dynamic_cast<const StructType*>(type.getCanonicalType())) {
+    // members are placed by the layout of the struct, which may add padding
+    llvm::StructType *struct_llvm_type = llvm::cast<llvm::StructType>(llvm_type);
+    std::vector<llvm::Constant*> members;
+    for (llvm::Type *element_type: struct_llvm_type->elements()) {
+      members.push_back(llvm::Constant::getNullValue(element_type));
+    }
+    for (unsigned member = 0; member < elements.size(); member++) {
+      members[memberIndex(*struct_type, member)] = elements[member];
+    }
+    return llvm::ConstantStruct::get(struct_llvm_type, members);
   } else {
-    throw CompilerException(nullptr, "array initializer only allowed for literals");
+    return llvm::ConstantStruct::get(llvm::cast<llvm::StructType>(llvm_type), elements);
   }
 }
 
@@ -366,6 +1708,9 @@ llvm::Value* LLVMTransformer::transformExpr(const Expr& expr, llvm::BasicBlock*
   } else if (const StringExpr *string_expr = dynamic_cast<const StringExpr*>(&expr)) {
     return llvm::ConstantDataArray::getString(context_, string_expr->getString());
   } else if (const AccessorExpr *accessor_expr = dynamic_cast<const AccessorExpr*>(&expr)) {
+    if (accessor_expr->identifier().getType()->getCanonicalType()->getKind() == Type::Kind::VectorType) {
+      return transformLaneAccess(*accessor_expr, current_block);
+    }
     return builder.CreateLoad(transformAccessorExprReference(*accessor_expr, current_block));
   } else if (const TupleExpr *tuple_expr = dynamic_cast<const TupleExpr*>(&expr)) {
     return transformConstantTupleExpr(*tuple_expr);
@@ -388,8 +1733,12 @@ llvm::BasicBlock* LLVMTransformer::transformStmt(Stmt& stmt, llvm::BasicBlock *c
     return current_block;
   } else if (ConditionalBlock* cond_block = dynamic_cast<ConditionalBlock*>(&stmt)) {
     return transformConditionalBlock(*cond_block, current_block);
+  } else if (MatchStmt *match_stmt = dynamic_cast<MatchStmt*>(&stmt)) {
+    return transformMatchStmt(*match_stmt, current_block);
   } else if (WhileLoop *while_loop = dynamic_cast<WhileLoop*>(&stmt)) {
     return transformWhileLoop(*while_loop, current_block);
+  } else if (ForLoop *for_loop = dynamic_cast<ForLoop*>(&stmt)) {
+    return transformForLoop(*for_loop, current_block);
   } else if (CompoundStmt *comp_stmt = dynamic_cast<CompoundStmt*>(&stmt)) {
     return transformCompoundStmt(*comp_stmt, current_block);
   } else {
@@ -398,10 +1747,33 @@ llvm::BasicBlock* LLVMTransformer::transformStmt(Stmt& stmt, llvm::BasicBlock *c
 }
 
 llvm::BasicBlock* LLVMTransformer::transformCompoundStmt(CompoundStmt& tree, llvm::BasicBlock *current_block) {
+  bool has_allocator = tree.getAllocator() != CompoundStmt::Allocator::Inherited;
+  if (has_allocator) {
+    llvm::IRBuilder<> builder{current_block};
+    builder.CreateCall(getAllocationFunction(
+      tree.getAllocator() == CompoundStmt::Allocator::Arena ? "__bulat_push_arena" : "__bulat_push_pool"
+    ));
+    allocator_scopes_++;
+  }
+  size_t outer_owned_maps = owned_maps_.size();
+
   for (auto it = tree.getStmts().begin(); it != tree.getStmts().end(); it++) {
     Stmt* stmt = it->get();
     current_block = transformStmt(*stmt, current_block);
   }
+
+  // a block which returned has already freed its maps
+  if (!current_block->getTerminator()) freeOwnedMaps(outer_owned_maps, current_block);
+  owned_maps_.resize(outer_owned_maps);
+
+  if (has_allocator) {
+    allocator_scopes_--;
+    // a block which returned has already popped its allocator
+    if (!current_block->getTerminator()) {
+      llvm::IRBuilder<> builder{current_block};
+      builder.CreateCall(getAllocationFunction("__bulat_pop_allocator"));
+    }
+  }
   return current_block;
 }
 
@@ -446,6 +1818,53 @@ llvm::BasicBlock* LLVMTransformer::transformConditionalBlock(
   return if_exit;
 }
 
+llvm::BasicBlock* LLVMTransformer::transformMatchStmt(
+  MatchStmt& tree
+, llvm::BasicBlock* current_block
+) {
+  llvm::Value *scrutinee = transformExpr(tree.getScrutinee(), current_block);
+  llvm::IntegerType *type = llvm::cast<llvm::IntegerType>(scrutinee->getType());
+  llvm::BasicBlock *match_exit = llvm::BasicBlock::Create(context_, "match_exit", function_);
+
+  // a match without an else case covers every value, so the default is never
+  // taken
+  llvm::BasicBlock *match_default = llvm::BasicBlock::Create(
+    context_, tree.getElse() ? "match_else" : "match_unreachable", function_
+  );
+  llvm::IRBuilder<> builder{current_block};
+  unsigned case_count = 0;
+  for (auto &match_case: tree.getCases()) case_count += match_case.constants.size();
+  llvm::SwitchInst *switch_inst = builder.CreateSwitch(scrutinee, match_default, case_count);
+
+  for (auto &match_case: tree.getCases()) {
+    llvm::BasicBlock *case_block = llvm::BasicBlock::Create(context_, "match_case", function_);
+    for (uint64_t constant: match_case.constants) {
+      switch_inst->addCase(llvm::ConstantInt::get(type, constant, true), case_block);
+    }
+    llvm::BasicBlock *case_exit = transformCompoundStmt(*match_case.block, case_block);
+    if (!case_exit->getTerminator()) {
+      llvm::IRBuilder<> case_exit_builder{case_exit};
+      case_exit_builder.CreateBr(match_exit);
+    }
+  }
+
+  if (CompoundStmt *else_block = tree.getElse()) {
+    llvm::BasicBlock *else_exit = transformCompoundStmt(*else_block, match_default);
+    if (!else_exit->getTerminator()) {
+      llvm::IRBuilder<> else_exit_builder{else_exit};
+      else_exit_builder.CreateBr(match_exit);
+    }
+  } else {
+    llvm::IRBuilder<> default_builder{match_default};
+    default_builder.CreateUnreachable();
+  }
+
+  if (llvm::pred_begin(match_exit) == llvm::pred_end(match_exit)) {
+    match_exit->removeFromParent();
+  }
+  return match_exit;
+}
+
 llvm::BasicBlock* LLVMTransformer::transformWhileLoop(
   WhileLoop& tree
 , llvm::BasicBlock* entry_block
@@ -455,12 +1874,16 @@ llvm::BasicBlock* LLVMTransformer::transformWhileLoop(
   // creates a block to compute the loop_condition
   llvm::BasicBlock *loop_cond = llvm::BasicBlock::Create(context_, "loop_cond", function_);
   // unconditionally break from the previous block to the entry block
-  entry_builder.CreateBr(loop_cond);
+  llvm::BranchInst *entry_branch = entry_builder.CreateBr(loop_cond);
 
   llvm::IRBuilder<> cond_builder{loop_cond};
 
-  // computes the loop condition in the loop_cond
-  llvm::Value* condition = transformExpr(*tree.getCondition(), loop_cond);
+  // computes the loop condition in the loop_cond. A short circuiting
+  // condition starts in a block in front of loop_cond, which the back edge
+  // must return to.
+  BranchHint hint;
+  llvm::Value* condition = transformExpr(stripBranchHint(*tree.getCondition(), hint), loop_cond);
+  llvm::BasicBlock *loop_start = entry_branch->getSuccessor(0);
 
   // creates the loop_body_entry and the loop_exit block
   llvm::BasicBlock *loop_body_entry = llvm::BasicBlock::Create(context_, "loop_body_entry", function_);
@@ -468,7 +1891,7 @@ llvm::BasicBlock* LLVMTransformer::transformWhileLoop(
 
   // conditonal break to either the loop_body_entry or the loop_exit depending
   // on the condition
-  cond_builder.CreateCondBr(condition, loop_body_entry, loop_exit);
+  cond_builder.CreateCondBr(condition, loop_body_entry, loop_exit, createBranchWeights(hint));
 
   // computes the loop_body starting from loop_body_entry and returning the exit
   llvm::BasicBlock* loop_body_exit = transformCompoundStmt(*tree.getBlock(), loop_body_entry);
@@ -477,13 +1900,398 @@ llvm::BasicBlock* LLVMTransformer::transformWhileLoop(
   // terminator does not already exist
   if (!loop_body_exit->getTerminator()) {
     llvm::IRBuilder<> loop_body_exit_builder{loop_body_exit};
-    loop_body_exit_builder.CreateBr(loop_cond);
+    loop_body_exit_builder.CreateBr(loop_start);
   }
 
   // returns the exit point for the loop
   return loop_exit;
 }
 
+llvm::BasicBlock* LLVMTransformer::transformForLoop(
+  ForLoop& tree
+, llvm::BasicBlock* entry_block
+) {
+  if (tree.isParallel()) return transformParallelForLoop(tree, entry_block);
+
+  llvm::IRBuilder<> entry_builder{entry_block};
+
+  // the bounds are computed once, in a preheader which only branches to the
+  // loop header
+  llvm::BasicBlock *loop_preheader = llvm::BasicBlock::Create(context_, "for_preheader", function_);
+  entry_builder.CreateBr(loop_preheader);
+
+  llvm::Value *start, *end, *data = nullptr;
+  const StructType *soa_type = nullptr;
+  if (tree.isRange()) {
+    start = transformExpr(*tree.getStart(), loop_preheader);
+    end = transformExpr(*tree.getEnd(), loop_preheader);
+  } else {
+    std::tie(data, end) = transformSequence(*tree.getSequence(), loop_preheader);
+    soa_type = soaElementType(tree.getSequence()->getType());
+    start = llvm::ConstantInt::get(end->getType(), 0);
+  }
+
+  llvm::BasicBlock *loop_header = llvm::BasicBlock::Create(context_, "for_cond", function_);
+  llvm::BasicBlock *loop_body_entry = llvm::BasicBlock::Create(context_, "for_body", function_);
+  llvm::BasicBlock *loop_latch = llvm::BasicBlock::Create(context_, "for_latch", function_);
+  llvm::BasicBlock *loop_exit = llvm::BasicBlock::Create(context_, "for_exit", function_);
+
+  llvm::IRBuilder<> preheader_builder{loop_preheader};
+  preheader_builder.CreateBr(loop_header);
+
+  // the induction variable lives in a register, and is only ever incremented
+  // by the latch
+  StringRef name = tree.getDeclaration()->getName();
+  llvm::IRBuilder<> header_builder{loop_header};
+  llvm::PHINode *index = header_builder.CreatePHI(start->getType(), 2, data ? "index" : name.str());
+  index->addIncoming(start, loop_preheader);
+  bool is_unsigned = tree.isRange() && isUnsigned(*tree.getStart()->getType());
+  llvm::Value *in_range = is_unsigned
+    ? header_builder.CreateICmpULT(index, end)
+    : header_builder.CreateICmpSLT(index, end);
+  header_builder.CreateCondBr(in_range, loop_body_entry, loop_exit);
+
+  // the loop variable shadows any outer binding of the same name for the
+  // duration of the body
+  auto shadowed_it = named_values_.find(name);
+  llvm::Value *shadowed = shadowed_it != named_values_.end() ? shadowed_it->second : nullptr;
+
+  if (data) {
+    // elements are read at the start of each iteration. The index is within
+    // [0, length), so the element address is in bounds.
+    llvm::IRBuilder<> body_builder{loop_body_entry};
+    llvm::Value *element = soa_type
+      ? transformSoaElementLoad(data, *soa_type, index, loop_body_entry)
+      : body_builder.CreateLoad(body_builder.CreateInBoundsGEP(data, index), name.str());
+    if (element->getType()->isAggregateType()) {
+      // aggregate elements are copied into memory, so that their members are
+      // accessed like those of parameters passed in memory
+      llvm::AllocaInst *copy = createEntryBlockAlloca(element->getType(), name.str());
+      body_builder.CreateStore(element, copy);
+      indirect_args_.insert(copy);
+      named_values_[name] = copy;
+    } else {
+      named_values_[name] = element;
+    }
+  } else {
+    named_values_[name] = index;
+  }
+
+  llvm::BasicBlock* loop_body_exit = transformCompoundStmt(*tree.getBlock(), loop_body_entry);
+  if (!loop_body_exit->getTerminator()) {
+    llvm::IRBuilder<> loop_body_exit_builder{loop_body_exit};
+    loop_body_exit_builder.CreateBr(loop_latch);
+  }
+
+  if (shadowed) named_values_[name] = shadowed;
+  else named_values_.erase(name);
+
+  // the index is less than the end of the range, so the increment can not
+  // overflow
+  llvm::IRBuilder<> latch_builder{loop_latch};
+  llvm::Value *one = llvm::ConstantInt::get(index->getType(), 1);
+  llvm::Value *next = latch_builder.CreateAdd(index, one, "index.next", is_unsigned, !is_unsigned);
+  index->addIncoming(next, loop_latch);
+  llvm::BranchInst *back_edge = latch_builder.CreateBr(loop_header);
+  back_edge->setMetadata(llvm::LLVMContext::MD_loop, createLoopMetadata());
+
+  return loop_exit;
+}
+
+// collects the names of all identifiers used within the element
+static void collectIdentifiers(const TreeElement& element, std::set<StringRef>& names) {
+  if (const IdentifierExpr* id_expr = dynamic_cast<const IdentifierExpr*>(&element)) {
+    names.insert(id_expr->lexeme());
+  }
+  for (TreeElement* child: element.getChildren()) {
+    if (child) collectIdentifiers(*child, names);
+  }
+}
+
+// returns true if the value is local to the function, e.g. a parameter or a
+// variable
+static bool isLocalTo(const llvm::Value* value, const llvm::Function* function) {
+  if (const llvm::Instruction* inst = llvm::dyn_cast<llvm::Instruction>(value)) {
+    return inst->getFunction() == function;
+  } else if (const llvm::Argument* arg = llvm::dyn_cast<llvm::Argument>(value)) {
+    return arg->getParent() == function;
+  } else return false;
+}
+
+// returns the value every partial result of the reduction starts out with
+static llvm::Constant* reductionIdentity(Reduction::Operator op, const Type& type, llvm::Type* llvm_type) {
+  if (llvm_type->isFloatingPointTy()) {
+    switch (op) {
+      case Reduction::Operator::Add: return llvm::ConstantFP::get(llvm_type, 0.0);
+      case Reduction::Operator::Multiply: return llvm::ConstantFP::get(llvm_type, 1.0);
+      case Reduction::Operator::Min: return llvm::ConstantFP::getInfinity(llvm_type, false);
+      case Reduction::Operator::Max: return llvm::ConstantFP::getInfinity(llvm_type, true);
+    }
+  }
+  unsigned bits = llvm_type->getIntegerBitWidth();
+  bool is_unsigned = isUnsigned(type);
+  switch (op) {
+    case Reduction::Operator::Add:
+      return llvm::ConstantInt::get(llvm_type, 0);
+    case Reduction::Operator::Multiply:
+      return llvm::ConstantInt::get(llvm_type, 1);
+    case Reduction::Operator::Min:
+      return llvm::ConstantInt::get(llvm_type->getContext(), is_unsigned ? llvm::APInt::getMaxValue(bits) : llvm::APInt::getSignedMaxValue(bits));
+    case Reduction::Operator::Max:
+      return llvm::ConstantInt::get(llvm_type->getContext(), is_unsigned ? llvm::APInt::getMinValue(bits) : llvm::APInt::getSignedMinValue(bits));
+  }
+  throw std::logic_error("unsupported reduction operator");
+}
+
+llvm::BasicBlock* LLVMTransformer::transformParallelForLoop(
+  ForLoop& tree
+, llvm::BasicBlock* entry_block
+) {
+  llvm::IRBuilder<> builder{entry_block};
+  llvm::Type* int64_type = builder.getInt64Ty();
+  bool is_unsigned = isUnsigned(*tree.getStart()->getType());
+  llvm::Value* start = transformExpr(*tree.getStart(), entry_block);
+  llvm::Value* end = transformExpr(*tree.getEnd(), entry_block);
+  llvm::Type* index_type = start->getType();
+
+  // the body refers to the values of the enclosing function through the
+  // context, which holds the values themselves, or the addresses of
+  // variables. Reduction variables are always captured, since their partial
+  // results are combined into them.
+  std::set<StringRef> names;
+  collectIdentifiers(*tree.getBlock(), names);
+  for (const Reduction& reduction: tree.getReductions()) {
+    names.insert(reduction.variable->lexeme());
+  }
+  std::vector<StringRef> captures;
+  std::vector<llvm::Type*> capture_types;
+  for (StringRef name: names) {
+    auto value_it = named_values_.find(name);
+    if (value_it == named_values_.end() || !isLocalTo(value_it->second, function_)) continue;
+    captures.push_back(name);
+    capture_types.push_back(value_it->second->getType());
+  }
+  llvm::StructType* context_type = llvm::StructType::get(context_, capture_types);
+  llvm::AllocaInst* context = createEntryBlockAlloca(context_type, "parallel.context");
+  for (unsigned index = 0; index < captures.size(); index++) {
+    builder.CreateStore(named_values_[captures[index]], builder.CreateStructGEP(context, index));
+  }
+
+  // the body is emitted into a function of its own, which is transformed like
+  // any other function and then left for the enclosing function
+  llvm::Type* void_ptr_type = builder.getInt8PtrTy();
+  llvm::FunctionType* body_type = llvm::FunctionType::get(builder.getVoidTy(), {void_ptr_type, int64_type, int64_type}, false);
+  llvm::Function* body = llvm::Function::Create(
+    body_type, llvm::Function::InternalLinkage, function_->getName() + ".parallel", module_);
+  body->addFnAttr(llvm::Attribute::NoUnwind);
+
+  llvm::Function* outer_function = function_;
+  std::map<StringRef, llvm::Value*> outer_values = named_values_;
+  std::set<const llvm::Value*> outer_indirect_args = indirect_args_;
+  unsigned outer_allocator_scopes = allocator_scopes_;
+  std::vector<llvm::Value*> outer_owned_maps = owned_maps_;
+  function_ = body;
+  allocator_scopes_ = 0;
+  owned_maps_.clear();
+
+  auto arg_it = body->arg_begin();
+  llvm::Value* context_arg = &*arg_it++;
+  llvm::Value* begin_arg = &*arg_it++;
+  llvm::Value* end_arg = &*arg_it;
+  context_arg->setName("context");
+  begin_arg->setName("begin");
+  end_arg->setName("end");
+
+  llvm::BasicBlock* body_entry = llvm::BasicBlock::Create(context_, "entry", body);
+  llvm::IRBuilder<> body_builder{body_entry};
+  llvm::Value* body_context = body_builder.CreateBitCast(context_arg, llvm::PointerType::getUnqual(context_type));
+  for (unsigned index = 0; index < captures.size(); index++) {
+    llvm::Value* captured = outer_values[captures[index]];
+    llvm::Value* value = body_builder.CreateLoad(body_builder.CreateStructGEP(body_context, index), captures[index].str());
+    if (outer_indirect_args.count(captured)) indirect_args_.insert(value);
+    named_values_[captures[index]] = value;
+  }
+
+  // every call accumulates into private copies of the reduction variables
+  std::vector<llvm::Value*> partials;
+  for (const Reduction& reduction: tree.getReductions()) {
+    StringRef name = reduction.variable->lexeme();
+    const Type& type = *reduction.variable->getType();
+    llvm::Type* llvm_type = transformType(type);
+    llvm::AllocaInst* partial = body_builder.CreateAlloca(llvm_type, nullptr, name.str() + ".partial");
+    body_builder.CreateStore(reductionIdentity(reduction.op, type, llvm_type), partial);
+    named_values_[name] = partial;
+    partials.push_back(partial);
+  }
+
+  llvm::BasicBlock* loop_header = llvm::BasicBlock::Create(context_, "for_cond", body);
+  llvm::BasicBlock* loop_body_entry = llvm::BasicBlock::Create(context_, "for_body", body);
+  llvm::BasicBlock* loop_latch = llvm::BasicBlock::Create(context_, "for_latch", body);
+  llvm::BasicBlock* loop_exit = llvm::BasicBlock::Create(context_, "for_exit", body);
+
+  // the subrange is within the range of the loop, so it fits the type of the
+  // loop variable
+  llvm::Value* begin = body_builder.CreateTrunc(begin_arg, index_type);
+  llvm::Value* range_end = body_builder.CreateTrunc(end_arg, index_type);
+  body_builder.CreateBr(loop_header);
+
+  StringRef name = tree.getDeclaration()->getName();
+  llvm::IRBuilder<> header_builder{loop_header};
+  llvm::PHINode* index = header_builder.CreatePHI(index_type, 2, name.str());
+  index->addIncoming(begin, body_entry);
+  llvm::Value* in_range = is_unsigned
+    ? header_builder.CreateICmpULT(index, range_end)
+    : header_builder.CreateICmpSLT(index, range_end);
+  header_builder.CreateCondBr(in_range, loop_body_entry, loop_exit);
+
+  named_values_[name] = index;
+  llvm::BasicBlock* loop_body_exit = transformCompoundStmt(*tree.getBlock(), loop_body_entry);
+  if (!loop_body_exit->getTerminator()) {
+    llvm::IRBuilder<> loop_body_exit_builder{loop_body_exit};
+    loop_body_exit_builder.CreateBr(loop_latch);
+  }
+
+  llvm::IRBuilder<> latch_builder{loop_latch};
+  llvm::Value* one = llvm::ConstantInt::get(index_type, 1);
+  llvm::Value* next = latch_builder.CreateAdd(index, one, "index.next", is_unsigned, !is_unsigned);
+  index->addIncoming(next, loop_latch);
+  llvm::BranchInst* back_edge = latch_builder.CreateBr(loop_header);
+  back_edge->setMetadata(llvm::LLVMContext::MD_loop, createLoopMetadata());
+
+  // the partial results are combined into the shared variables, which were
+  // captured by address
+  llvm::BasicBlock* current_block = loop_exit;
+  for (unsigned index = 0; index < partials.size(); index++) {
+    const Reduction& reduction = tree.getReductions()[index];
+    llvm::IRBuilder<> exit_builder{current_block};
+    llvm::Value* partial = exit_builder.CreateLoad(partials[index]);
+    auto capture_it = std::find(captures.begin(), captures.end(), reduction.variable->lexeme());
+    llvm::Value* shared = exit_builder.CreateLoad(exit_builder.CreateStructGEP(body_context, unsigned(capture_it - captures.begin())));
+    combineReduction(reduction.op, *reduction.variable->getType(), shared, partial, current_block);
+  }
+  llvm::IRBuilder<> exit_builder{current_block};
+  exit_builder.CreateRetVoid();
+
+  function_ = outer_function;
+  named_values_ = outer_values;
+  indirect_args_ = outer_indirect_args;
+  allocator_scopes_ = outer_allocator_scopes;
+  owned_maps_ = outer_owned_maps;
+
+  builder.CreateCall(getParallelFunction("__bulat_parallel_for"), {
+    is_unsigned ? builder.CreateZExt(start, int64_type) : builder.CreateSExt(start, int64_type)
+  , is_unsigned ? builder.CreateZExt(end, int64_type) : builder.CreateSExt(end, int64_type)
+  , body
+  , builder.CreateBitCast(context, void_ptr_type)
+  });
+  return entry_block;
+}
+
+void LLVMTransformer::combineReduction(
+  Reduction::Operator op
+, const Type& type
+, llvm::Value* shared
+, llvm::Value* partial
+, llvm::BasicBlock*& current_block
+) {
+  llvm::IRBuilder<> builder{current_block};
+  llvm::Type* value_type = partial->getType();
+  bool is_float = value_type->isFloatingPointTy();
+  bool is_unsigned = !is_float && isUnsigned(type);
+
+  // integer sums and extrema have atomic instructions of their own
+  if (!is_float && op != Reduction::Operator::Multiply) {
+    llvm::AtomicRMWInst::BinOp rmw_op = llvm::AtomicRMWInst::Add;
+    if (op == Reduction::Operator::Min) rmw_op = is_unsigned ? llvm::AtomicRMWInst::UMin : llvm::AtomicRMWInst::Min;
+    if (op == Reduction::Operator::Max) rmw_op = is_unsigned ? llvm::AtomicRMWInst::UMax : llvm::AtomicRMWInst::Max;
+    builder.CreateAtomicRMW(rmw_op, shared, partial, llvm::AtomicOrdering::Monotonic);
+    return;
+  }
+
+  // everything else is combined in a compare and swap loop, which compares
+  // floating point values by their bits
+  llvm::Type* bits_type = builder.getIntNTy(value_type->getPrimitiveSizeInBits());
+  llvm::Value* shared_bits = builder.CreateBitCast(shared, llvm::PointerType::getUnqual(bits_type));
+  llvm::LoadInst* initial = builder.CreateLoad(shared_bits);
+  initial->setAtomic(llvm::AtomicOrdering::Monotonic);
+  initial->setAlignment(value_type->getPrimitiveSizeInBits() / 8);
+
+  llvm::BasicBlock* combine = llvm::BasicBlock::Create(context_, "reduce", function_);
+  llvm::BasicBlock* combined = llvm::BasicBlock::Create(context_, "reduce_done", function_);
+  llvm::BasicBlock* entry = current_block;
+  builder.CreateBr(combine);
+
+  llvm::IRBuilder<> combine_builder{combine};
+  llvm::PHINode* expected = combine_builder.CreatePHI(bits_type, 2);
+  expected->addIncoming(initial, entry);
+  llvm::Value* current = combine_builder.CreateBitCast(expected, value_type);
+  llvm::Value* result = nullptr;
+  switch (op) {
+    case Reduction::Operator::Add:
+      result = combine_builder.CreateFAdd(current, partial);
+      break;
+    case Reduction::Operator::Multiply:
+      result = is_float ? combine_builder.CreateFMul(current, partial) : combine_builder.CreateMul(current, partial);
+      break;
+    case Reduction::Operator::Min:
+      result = combine_builder.CreateSelect(combine_builder.CreateFCmpOLT(partial, current), partial, current);
+      break;
+    case Reduction::Operator::Max:
+      result = combine_builder.CreateSelect(combine_builder.CreateFCmpOGT(partial, current), partial, current);
+      break;
+  }
+  llvm::Value* exchange = combine_builder.CreateAtomicCmpXchg(
+    shared_bits, expected, combine_builder.CreateBitCast(result, bits_type),
+    llvm::AtomicOrdering::Monotonic, llvm::AtomicOrdering::Monotonic);
+  expected->addIncoming(combine_builder.CreateExtractValue(exchange, 0), combine);
+  combine_builder.CreateCondBr(combine_builder.CreateExtractValue(exchange, 1), combined, combine);
+
+  current_block = combined;
+}
+
+llvm::Function* LLVMTransformer::getParallelFunction(const std::string& name) {
+  if (llvm::Function* existing = module_->getFunction(name)) return existing;
+
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(context_);
+  llvm::Type* void_ptr_type = llvm::Type::getInt8PtrTy(context_);
+  llvm::FunctionType* type;
+  if (name == "__bulat_parallel_for") {
+    llvm::FunctionType* body_type = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(context_), {void_ptr_type, int64_type, int64_type}, false);
+    type = llvm::FunctionType::get(llvm::Type::getVoidTy(context_), {
+      int64_type, int64_type, llvm::PointerType::getUnqual(body_type), void_ptr_type
+    }, false);
+  } else {
+    type = llvm::FunctionType::get(int64_type, {}, false);
+  }
+
+  llvm::Function* function = llvm::Function::Create(type, llvm::Function::ExternalLinkage, name, module_);
+  function->addFnAttr(llvm::Attribute::NoUnwind);
+  return function;
+}
+
+llvm::MDNode* LLVMTransformer::createLoopMetadata() {
+  llvm::Metadata *vectorize[] = {
+    llvm::MDString::get(context_, "llvm.loop.vectorize.enable")
+  , llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(context_))
+  };
+  llvm::Metadata *unroll[] = {
+    llvm::MDString::get(context_, "llvm.loop.unroll.enable")
+  };
+
+  // the first operand of a loop id refers to the id itself, which keeps ids
+  // of distinct loops from being uniqued together
+  llvm::TempMDTuple self = llvm::MDNode::getTemporary(context_, llvm::None);
+  llvm::Metadata *operands[] = {
+    self.get()
+  , llvm::MDNode::get(context_, vectorize)
+  , llvm::MDNode::get(context_, unroll)
+  };
+  llvm::MDNode *loop_id = llvm::MDNode::getDistinct(context_, operands);
+  loop_id->replaceOperandWith(0, loop_id);
+  return loop_id;
+}
+
 
 void LLVMTransformer::transformConditionalStmt(
   ConditionalStmt& tree
@@ -494,7 +2302,9 @@ void LLVMTransformer::transformConditionalStmt(
   llvm::IRBuilder<> cond_builder{if_cond};
 
   // computes the condition in the given if_cond block
-  llvm::Value* condition = transformExpr(*tree.getCondition(), if_cond);
+  BranchHint hint;
+  llvm::Value* condition = transformExpr(stripBranchHint(*tree.getCondition(), hint), if_cond);
+  llvm::MDNode* weights = createBranchWeights(hint);
 
   // creates the entry point for the if_body
   llvm::BasicBlock *if_body_entry = llvm::BasicBlock::Create(context_, "if_body_entry", function_);
@@ -502,8 +2312,8 @@ void LLVMTransformer::transformConditionalStmt(
   // creates a conditional break to the if_body_entry, if the condition
   // is true, and either the next_block, or the exit_block, depending on
   // their existence, if the condition is false
-  if (next_block) cond_builder.CreateCondBr(condition, if_body_entry, next_block);
-  else cond_builder.CreateCondBr(condition, if_body_entry, if_exit);
+  if (next_block) cond_builder.CreateCondBr(condition, if_body_entry, next_block, weights);
+  else cond_builder.CreateCondBr(condition, if_body_entry, if_exit, weights);
 
   // generates the body of the conditional stmt, entering at if_body_entry and
   // returns a handle to the body exit.
@@ -523,74 +2333,173 @@ void LLVMTransformer::transformConditionalStmt(
 /// called, then a Compiler exception is thrown with a "not implemented"
 /// exception is thrown.
 llvm::Value* LLVMTransformer::transformBinaryExpr(const BinaryExpr& expr, llvm::BasicBlock* current_block) {
-  llvm::IRBuilder<> builder{current_block};
-
   // assignment is special
-  if (expr.getOperator() == StringRef{"="}) {
+  if (expr.isAssignment()) {
     return transformAssignmentStmt(expr, current_block);
   }
+  if ((expr.getOperator() == "&&" || expr.getOperator() == "||") && expr.getType()->isBooleanType()) {
+    return transformLogicalExpr(expr, current_block);
+  }
 
   llvm::Value *lval = transformExpr(expr.getLeft(), current_block);
   llvm::Value *rval = transformExpr(expr.getRight(), current_block);
+  return transformBinaryOperator(expr.getOperator(), lval, rval, *expr.getLeft().getType(), current_block);
+}
 
-  if (lval->getType()->isIntegerTy() && rval->getType()->isIntegerTy()) {
-    if (expr.getOperator() == "+") {
+// Expressions are generated into a single block, which the caller keeps
+// appending to after the expression. The right operand is only evaluated if
+// the left operand does not decide the result, so the instructions emitted so
+// far, along with the left operand, are moved to a block in front of
+// current_block, which then continues with the result.
+//
+//   and_lhs:  ...; br %left, %and_rhs, %current
+//   and_rhs:  ...; br %current
+//   current:  %result = phi [false, %and_lhs], [%right, %and_rhs]
+llvm::Value* LLVMTransformer::transformLogicalExpr(const BinaryExpr& expr, llvm::BasicBlock* current_block) {
+  bool is_and = expr.getOperator() == "&&";
+  llvm::Value *lval = transformExpr(expr.getLeft(), current_block);
+  llvm::BasicBlock *lhs_block = splitBlockBefore(current_block, is_and ? "and_lhs" : "or_lhs");
+  llvm::BasicBlock *rhs_block = llvm::BasicBlock::Create(
+    context_, is_and ? "and_rhs" : "or_rhs", function_, current_block
+  );
+
+  llvm::IRBuilder<> lhs_builder{lhs_block};
+  if (is_and) lhs_builder.CreateCondBr(lval, rhs_block, current_block);
+  else lhs_builder.CreateCondBr(lval, current_block, rhs_block);
+
+  llvm::Value *rval = transformExpr(expr.getRight(), rhs_block);
+  llvm::IRBuilder<> rhs_builder{rhs_block};
+  rhs_builder.CreateBr(current_block);
+
+  llvm::IRBuilder<> builder{current_block};
+  llvm::PHINode *result = builder.CreatePHI(lval->getType(), 2);
+  result->addIncoming(is_and ? builder.getFalse() : builder.getTrue(), lhs_block);
+  result->addIncoming(rval, rhs_block);
+  return result;
+}
+
+llvm::BasicBlock* LLVMTransformer::splitBlockBefore(llvm::BasicBlock* block, const std::string& name) {
+  llvm::BasicBlock *front = llvm::BasicBlock::Create(context_, name, function_, block);
+  front->getInstList().splice(front->end(), block->getInstList());
+
+  // the front takes over the predecessors of the block. Phi nodes may already
+  // name the block as the predecessor it will be once it is terminated, so
+  // only branches are redirected.
+  std::vector<llvm::BasicBlock*> predecessors(llvm::pred_begin(block), llvm::pred_end(block));
+  for (llvm::BasicBlock *predecessor: predecessors) {
+    predecessor->getTerminator()->replaceUsesOfWith(block, front);
+  }
+  return front;
+}
+
+// likely(c) and unlikely(c) are the identity, but hint which way a branch on
+// c goes
+const Expr& LLVMTransformer::stripBranchHint(const Expr& condition, BranchHint& hint) {
+  hint = BranchHint::None;
+  const FunctionCall *call = dynamic_cast<const FunctionCall*>(&condition);
+  if (!call || !dynamic_cast<const BasicDecl*>(call->getDecl())) return condition;
+  if (call->getFunctionName() == StringRef{"likely"}) {
+    hint = BranchHint::Likely;
+  } else if (call->getFunctionName() == StringRef{"unlikely"}) {
+    hint = BranchHint::Unlikely;
+  } else {
+    return condition;
+  }
+  return *call->getArguments()[0];
+}
+
+llvm::MDNode* LLVMTransformer::createBranchWeights(BranchHint hint) {
+  // the weights of __builtin_expect in clang
+  const uint32_t likely_weight = 2000;
+  const uint32_t unlikely_weight = 1;
+  llvm::MDBuilder md_builder{context_};
+  switch (hint) {
+    case BranchHint::None: return nullptr;
+    case BranchHint::Likely: return md_builder.createBranchWeights(likely_weight, unlikely_weight);
+    case BranchHint::Unlikely: return md_builder.createBranchWeights(unlikely_weight, likely_weight);
+  }
+  return nullptr;
+}
+
+llvm::Value* LLVMTransformer::transformBinaryOperator(StringRef op, llvm::Value* lval, llvm::Value* rval,
+                                                      const Type& operand_type, llvm::BasicBlock* current_block) {
+  llvm::IRBuilder<> builder{current_block};
+
+  // vectors use the same instructions as their lanes
+  if (lval->getType()->isIntOrIntVectorTy() && rval->getType()->isIntOrIntVectorTy()) {
+    bool is_unsigned = isUnsigned(operand_type);
+    if (op == "<<" || op == ">>") {
+      // shifting by the bit width or more is poison in LLVM, so the shift
+      // amount is taken modulo the bit width, which is free on common targets
+      unsigned bits = rval->getType()->getScalarSizeInBits();
+      rval = builder.CreateAnd(rval, llvm::ConstantInt::get(rval->getType(), bits - 1));
+    }
+    if (op == "+") {
       return  builder.CreateAdd(lval, rval);
-    } else if (expr.getOperator() == "-") {
+    } else if (op == "-") {
       return builder.CreateSub(lval, rval);
-    } else if (expr.getOperator() == "*") {
+    } else if (op == "*") {
       return builder.CreateMul(lval, rval);
-    } else if (expr.getOperator() == "/") {
-      return builder.CreateSDiv(lval, rval);
-    } else if (expr.getOperator() == "%") {
-      return builder.CreateSRem(lval, rval);
-    } else if (expr.getOperator() == "==") {
+    } else if (op == "/") {
+      return is_unsigned ? builder.CreateUDiv(lval, rval) : builder.CreateSDiv(lval, rval);
+    } else if (op == "%") {
+      return is_unsigned ? builder.CreateURem(lval, rval) : builder.CreateSRem(lval, rval);
+    } else if (op == "==") {
       return builder.CreateICmpEQ(lval, rval);
-    } else if (expr.getOperator() == "!=") {
+    } else if (op == "!=") {
       return builder.CreateICmpNE(lval, rval);
-    } else if (expr.getOperator() == ">=") {
-      return builder.CreateICmpSGE(lval, rval);
-    } else if (expr.getOperator() == "<=") {
-      return builder.CreateICmpSLE(lval, rval);
-    } else if (expr.getOperator() == ">") {
-      return builder.CreateICmpSGT(lval, rval);
-    } else if (expr.getOperator() == "<") {
-      return builder.CreateICmpSLT(lval, rval);
-    }
-  } else if (lval->getType()->isDoubleTy() && rval->getType()->isDoubleTy()) {
-    if (expr.getOperator() == "+") {
+    } else if (op == ">=") {
+      return is_unsigned ? builder.CreateICmpUGE(lval, rval) : builder.CreateICmpSGE(lval, rval);
+    } else if (op == "<=") {
+      return is_unsigned ? builder.CreateICmpULE(lval, rval) : builder.CreateICmpSLE(lval, rval);
+    } else if (op == ">") {
+      return is_unsigned ? builder.CreateICmpUGT(lval, rval) : builder.CreateICmpSGT(lval, rval);
+    } else if (op == "<") {
+      return is_unsigned ? builder.CreateICmpULT(lval, rval) : builder.CreateICmpSLT(lval, rval);
+    } else if (op == "&&") {
+      return builder.CreateAnd(lval, rval);
+    } else if (op == "||") {
+      return builder.CreateOr(lval, rval);
+    } else if (op == "&") {
+      return builder.CreateAnd(lval, rval);
+    } else if (op == "|") {
+      return builder.CreateOr(lval, rval);
+    } else if (op == "^") {
+      return builder.CreateXor(lval, rval);
+    } else if (op == "<<") {
+      return builder.CreateShl(lval, rval);
+    } else if (op == ">>") {
+      return is_unsigned ? builder.CreateLShr(lval, rval) : builder.CreateAShr(lval, rval);
+    }
+  } else if (lval->getType()->isFPOrFPVectorTy() && rval->getType()->isFPOrFPVectorTy()) {
+    if (op == "+") {
       return builder.CreateFAdd(lval, rval);
-    } else if (expr.getOperator() == "-") {
+    } else if (op == "-") {
       return builder.CreateFSub(lval, rval);
-    } else if (expr.getOperator() == "*") {
+    } else if (op == "*") {
       return builder.CreateFMul(lval, rval);
-    } else if (expr.getOperator() == "/") {
+    } else if (op == "/") {
       return builder.CreateFDiv(lval, rval);
-    } else if (expr.getOperator() == "==") {
+    } else if (op == "%") {
+      return builder.CreateFRem(lval, rval);
+    } else if (op == "==") {
       return builder.CreateFCmpOEQ(lval, rval);
-    } else if (expr.getOperator() == "!=") {
+    } else if (op == "!=") {
       return builder.CreateFCmpONE(lval, rval);
-    } else if (expr.getOperator() == ">=") {
+    } else if (op == ">=") {
       return builder.CreateFCmpOGE(lval, rval);
-    } else if (expr.getOperator() == "<=") {
+    } else if (op == "<=") {
       return builder.CreateFCmpOLE(lval, rval);
-    } else if (expr.getOperator() == ">") {
+    } else if (op == ">") {
       return builder.CreateFCmpOGT(lval, rval);
-    } else if (expr.getOperator() == "<") {
+    } else if (op == "<") {
       return builder.CreateFCmpOLT(lval, rval);
     }
-  } else if (expr.getType()->isBooleanType()) {
-    if (expr.getOperator() == "&&") {
-      return builder.CreateAnd(lval, rval);
-    } else if (expr.getOperator() == "||") {
-      return builder.CreateOr(lval, rval);
-    }
   }
 
   std::stringstream ss;
-  ss << "not implemented: binary operator " << expr.getOperator() << "(";
-  ss << expr.getLeft().getType()->toString() << ", ";
-  ss << expr.getRight().getType()->toString() << ")";
+  ss << "not implemented: binary operator " << op << "(";
+  ss << operand_type.toString() << ", " << operand_type.toString() << ")";
   throw CompilerException(nullptr, ss.str());
 }
 
@@ -606,13 +2515,15 @@ llvm::Value* LLVMTransformer::transformUnaryExpr(const UnaryExpr& expr, llvm::Ba
 
   llvm::Value *val = transformExpr(expr.getExpr(), current_block);
 
-  if (val->getType()->isIntegerTy() && val->getType()->isIntegerTy()) {
+  if (val->getType()->isIntOrIntVectorTy()) {
     if (expr.getOperator() == "+") {
       return val;
     } else if (expr.getOperator() == "-") {
       return builder.CreateNeg(val);
+    } else if (expr.getOperator() == "!" || expr.getOperator() == "~") {
+      return builder.CreateNot(val);
     }
-  } else if (val->getType()->isDoubleTy() && val->getType()->isDoubleTy()) {
+  } else if (val->getType()->isFPOrFPVectorTy()) {
     if (expr.getOperator() == "+") {
       return val;
     } else if (expr.getOperator() == "-") {
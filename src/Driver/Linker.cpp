@@ -0,0 +1,79 @@
+#include "Driver/Linker.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+// returns the path of the C compiler which runs the linker, or an empty
+// string if none is found
+static std::string findLinker(const LinkOptions &options) {
+  if (!options.linker.empty()) return options.linker;
+  // only clang links bitcode, since the optimizer of the linker must be the
+  // LLVM which wrote it
+  std::vector<std::string> candidates{"clang", "cc", "gcc"};
+  if (options.lto) candidates = {"clang"};
+  for (auto &candidate: candidates) {
+    llvm::ErrorOr<std::string> path = llvm::sys::findProgramByName(candidate);
+    if (path) return *path;
+  }
+  return "";
+}
+
+int linkExecutable(const LinkOptions &options) {
+  std::string linker = findLinker(options);
+  if (linker.empty()) {
+    llvm::errs() << (options.lto ? "error: -flto needs clang to link" : "error: no C compiler found to link with") << "\n";
+    return 1;
+  }
+  llvm::Triple triple{llvm::sys::getProcessTriple()};
+
+  std::vector<std::string> args{linker, "-o", options.output};
+  switch (options.mode) {
+    case LinkOptions::Mode::PIE:
+      args.push_back("-pie");
+      break;
+    case LinkOptions::Mode::NoPIE:
+      args.push_back("-no-pie");
+      break;
+    case LinkOptions::Mode::Static:
+      args.push_back("-static");
+      break;
+  }
+  if (options.gc_sections) {
+    args.push_back(triple.isOSDarwin() ? "-Wl,-dead_strip" : "-Wl,--gc-sections");
+  }
+  if (options.lto) {
+    // the linker of Darwin links bitcode itself, elsewhere lld is needed
+    args.push_back("-flto=thin");
+    if (!triple.isOSDarwin()) args.push_back("-fuse-ld=lld");
+  }
+  for (auto &symbol: options.undefined_symbols) {
+    args.push_back("-Wl,-u," + symbol);
+  }
+  for (auto &input: options.inputs) {
+    args.push_back(input);
+  }
+  for (auto &path: options.library_paths) {
+    args.push_back("-L" + path);
+  }
+  for (auto &library: options.libraries) {
+    args.push_back("-l" + library);
+  }
+  // the parallel loops of the runtime library run on threads
+  args.push_back("-pthread");
+
+  std::vector<llvm::StringRef> arg_refs{args.begin(), args.end()};
+  std::string error;
+  bool failed_to_run = false;
+  int result = llvm::sys::ExecuteAndWait(linker, arg_refs, llvm::None, {}, 0, 0, &error, &failed_to_run);
+  if (failed_to_run) {
+    llvm::errs() << "error: could not run " << linker << ": " << error << "\n";
+    return 1;
+  } else if (result != 0) {
+    llvm::errs() << "error: linking " << options.output << " failed\n";
+    return 1;
+  }
+  return 0;
+}
@@ -9,6 +9,8 @@
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Analysis/ModuleSummaryAnalysis.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -23,17 +25,22 @@
 
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
 
 // #include "CodeGen/KaleidoscopeJIT.h"
 #include "CodeGen/IRGenWalker.h"
+#include "Driver/Linker.h"
 
 #include "Basic/SourceCode.h"
 #include "Basic/CompilerException.h"
@@ -52,18 +59,58 @@ bool printScope = false;
 bool printIR = false;
 bool Onone = false;
 bool JIT = false;
-std::string output_file_name = "./output.o";
+bool noBoundsCheck = false;
+bool profileGenerate = false;
+std::string profileGenerateFile;
+std::string profileUseFile;
+bool LTO = false;
+std::vector<std::string> input_paths;
+std::string output_file_name;
+bool has_output_file_name = false;
+
+/// The kind of file each unit is compiled to, or an executable which the
+/// units are linked into
+enum class EmitKind {
+  Object, Assembly, LLVMIR, Bitcode, Executable
+};
+EmitKind emit_kind = EmitKind::Object;
+bool has_emit_kind = false;
+
+/// The inputs other than sources, and how the executable is linked
+LinkOptions link_options;
+bool is_pic = false;
 
 void compileAST(CompilationUnit& unit);
-int compile_to_object_code(CompilationUnit& unit, std::string output_file_name);
-
-int main(int argc, char const *argv[]) {
-  if (argc < 2) {
-    std::cout << "error: no file found" << std::endl;
-    exit(1);
+int compile_to_file(CompilationUnit& unit, std::string source_path, std::string output_file_name, EmitKind kind);
+int compile_and_link(std::vector<std::unique_ptr<CompilationUnit>>& units,
+                     std::vector<std::shared_ptr<SourceFile>>& sources, const char* argv0);
+
+// the extension of the files of the kind which is emitted
+std::string outputExtension() {
+  switch (emit_kind) {
+    case EmitKind::Object: return ".o";
+    case EmitKind::Assembly: return ".s";
+    case EmitKind::LLVMIR: return ".ll";
+    case EmitKind::Bitcode: return LTO ? ".o" : ".bc";
+    case EmitKind::Executable: return "";
   }
+  return ".o";
+}
 
-  for (int i=2; i<argc; i++) {
+// returns true if the input is linked rather than compiled
+bool isLinkerInput(llvm::StringRef path) {
+  llvm::StringRef extension = llvm::sys::path::extension(path);
+  return extension == ".o" || extension == ".a" || extension == ".so" || extension == ".bc";
+}
+
+// the output file of a source when several sources are compiled at once, e.g.
+// lib/vector.bul is compiled to vector.o in the working directory
+std::string outputFileName(const std::string &source_path) {
+  return llvm::sys::path::stem(source_path).str() + outputExtension();
+}
+
+int main(int argc, char const *argv[]) {
+  for (int i=1; i<argc; i++) {
     if (argv[i] == std::string("--printAST")) {
       printAST = true;
     } else if (argv[i] == std::string("--printIR")) {
@@ -74,43 +121,173 @@ int main(int argc, char const *argv[]) {
       Onone = true;
     } else if (argv[i] == std::string("--JIT")) {
       JIT = true;
+    } else if (argv[i] == std::string("--noBoundsCheck")) {
+      noBoundsCheck = true;
+    } else if (argv[i] == std::string("--profile-generate")) {
+      profileGenerate = true;
+    } else if (llvm::StringRef(argv[i]).startswith("--profile-generate=")) {
+      profileGenerate = true;
+      profileGenerateFile = llvm::StringRef(argv[i]).split('=').second.str();
+    } else if (llvm::StringRef(argv[i]).startswith("--profile-use=")) {
+      profileUseFile = llvm::StringRef(argv[i]).split('=').second.str();
+    } else if (argv[i] == std::string("-flto")) {
+      LTO = true;
+    } else if (llvm::StringRef(argv[i]).startswith("--emit=")) {
+      llvm::StringRef kind = llvm::StringRef(argv[i]).split('=').second;
+      has_emit_kind = true;
+      if (kind == "obj") emit_kind = EmitKind::Object;
+      else if (kind == "asm") emit_kind = EmitKind::Assembly;
+      else if (kind == "llvm-ir") emit_kind = EmitKind::LLVMIR;
+      else if (kind == "llvm-bc") emit_kind = EmitKind::Bitcode;
+      else if (kind == "exe") emit_kind = EmitKind::Executable;
+      else {
+        std::cout << "error: unknown --emit kind '" << kind.str() << "', expected obj, asm, llvm-ir, llvm-bc or exe" << std::endl;
+        exit(1);
+      }
+    } else if (argv[i] == std::string("-static")) {
+      link_options.mode = LinkOptions::Mode::Static;
+    } else if (argv[i] == std::string("-pie")) {
+      link_options.mode = LinkOptions::Mode::PIE;
+      is_pic = true;
+    } else if (argv[i] == std::string("-no-pie")) {
+      link_options.mode = LinkOptions::Mode::NoPIE;
+    } else if (argv[i] == std::string("--gc-sections")) {
+      link_options.gc_sections = true;
+    } else if (llvm::StringRef(argv[i]).startswith("--linker=")) {
+      link_options.linker = llvm::StringRef(argv[i]).split('=').second.str();
+    } else if (llvm::StringRef(argv[i]).startswith("-L") && argv[i][2]) {
+      link_options.library_paths.push_back(argv[i] + 2);
+    } else if (llvm::StringRef(argv[i]).startswith("-l") && argv[i][2]) {
+      link_options.libraries.push_back(argv[i] + 2);
     } else if (argv[i] == std::string("-o")) {
       if (i + 1 < argc) {
         output_file_name = argv[i + 1];
+        has_output_file_name = true;
         i++;
       }
+    } else if (argv[i][0] != '-' && isLinkerInput(argv[i])) {
+      link_options.inputs.push_back(argv[i]);
+    } else if (argv[i][0] != '-') {
+      input_paths.push_back(argv[i]);
     }
   }
 
-  std::string path = argv[1];
-  SourceManager::currentSource = std::make_shared<SourceFile>(path);
-  auto parser = Parser{SourceManager::currentSource};
+  if (input_paths.empty()) {
+    std::cout << "error: no file found" << std::endl;
+    exit(1);
+  }
+  bool is_executable = emit_kind == EmitKind::Executable;
+  if (input_paths.size() > 1 && has_output_file_name && !is_executable) {
+    std::cout << "error: -o can not be used with several input files" << std::endl;
+    exit(1);
+  }
+  if (!link_options.inputs.empty() && !is_executable) {
+    std::cout << "error: object files and libraries can only be linked with --emit=exe" << std::endl;
+    exit(1);
+  }
+  // the linker optimizes the bitcode of a program compiled with -flto, which
+  // may still be looked at as text
+  if (LTO && !has_emit_kind) emit_kind = EmitKind::Bitcode;
+  if (LTO && (emit_kind == EmitKind::Object || emit_kind == EmitKind::Assembly)) {
+    std::cout << "error: -flto can only emit llvm-bc, llvm-ir or exe" << std::endl;
+    exit(1);
+  }
+  // executables are position independent unless they are linked otherwise
+  if (is_executable) is_pic = link_options.mode == LinkOptions::Mode::PIE;
+  if (!has_output_file_name) output_file_name = is_executable ? "a.out" : "./output" + outputExtension();
 
+  // the tokens of a unit point into its source, which must outlive the unit
+  std::vector<std::shared_ptr<SourceFile>> sources;
+  std::vector<std::unique_ptr<CompilationUnit>> units;
+  DeclContext program_context;
 
   try {
-    std::unique_ptr<CompilationUnit> unit = parser.parseCompilationUnit();
-    ScopeBuilder().buildCompilationUnitScope(*unit);
+    for (auto &path: input_paths) {
+      SourceManager::currentSource = std::make_shared<SourceFile>(path);
+      sources.push_back(SourceManager::currentSource);
+      units.push_back(Parser{SourceManager::currentSource}.parseCompilationUnit());
+    }
+    // every unit may use the declarations of the units given before it
+    for (size_t index = 0; index < units.size(); index++) {
+      SourceManager::currentSource = sources[index];
+      ScopeBuilder().buildCompilationUnitScope(*units[index], program_context);
+    }
     if (printAST) {
       std::ofstream myfile;
       myfile.open ("./visualizer/tree.json");
-      ASTPrintWalker{myfile}.traverse(unit.get());
+      ASTPrintWalker{myfile}.traverse(units.front().get());
       myfile.seekp((int)myfile.tellp()-1);
       myfile << " ";
       myfile.close();
     }
-    if (printScope) ASTScopePrinter(std::cout).traverse(unit.get());
-    if (JIT) compileAST(*unit); else return compile_to_object_code(*unit, output_file_name);
+    if (printScope) {
+      for (auto &unit: units) ASTScopePrinter(std::cout).traverse(unit.get());
+    }
+    if (JIT) {
+      compileAST(*units.front());
+      return 0;
+    }
+    if (is_executable) return compile_and_link(units, sources, argv[0]);
+    // each unit is compiled to its own file, which with -flto is a bitcode
+    // file that the linker optimizes along with the others
+    for (size_t index = 0; index < units.size(); index++) {
+      SourceManager::currentSource = sources[index];
+      std::string output = units.size() == 1 ? output_file_name : outputFileName(input_paths[index]);
+      if (int result = compile_to_file(*units[index], input_paths[index], output, emit_kind)) return result;
+      if (output != "-") llvm::outs() << "Wrote " << output << "\n";
+    }
   } catch (CompilerException e) {
       ErrorReporter{std::cout, *SourceManager::currentSource}.report(e);
+      return 1;
   }
   return 0;
 }
 
+// the runtime library which `make runtime` builds next to the compiler
+std::string runtimeLibraryPath(const char* argv0) {
+  std::string compiler = llvm::sys::fs::getMainExecutable(argv0, (void*)&runtimeLibraryPath);
+  llvm::SmallString<128> path{llvm::sys::path::parent_path(compiler)};
+  llvm::sys::path::append(path, "libbulat.a");
+  return path.str().str();
+}
+
 // instructions for compilation
-// 1 ./bin/tomscript test/test_data/MathLibTest
-// 2 ld output.o -e _main -macosx_version_min 10.13 -lSystem -lc
-// 3 ./a.out
-int compile_to_object_code(CompilationUnit& unit, std::string output_file_name) {
+// 1 ./bin/tomscript test/test_data/MathLibTest --emit=exe
+// 2 ./a.out
+int compile_and_link(std::vector<std::unique_ptr<CompilationUnit>>& units,
+                     std::vector<std::shared_ptr<SourceFile>>& sources, const char* argv0) {
+  // the units are compiled to temporary files, which are passed to the linker
+  // before the other inputs, so that they may use the libraries given
+  LinkOptions options = link_options;
+  options.output = output_file_name;
+  options.lto = LTO;
+  std::vector<std::string> unit_files;
+  int result = 0;
+  for (size_t index = 0; index < units.size() && result == 0; index++) {
+    SourceManager::currentSource = sources[index];
+    llvm::SmallString<128> path;
+    if (std::error_code EC = llvm::sys::fs::createTemporaryFile(llvm::sys::path::stem(input_paths[index]), "o", path)) {
+      llvm::errs() << "Could not create temporary file: " << EC.message() << "\n";
+      result = 1;
+      break;
+    }
+    unit_files.push_back(path.str().str());
+    result = compile_to_file(*units[index], input_paths[index], path.str().str(), LTO ? EmitKind::Bitcode : EmitKind::Object);
+  }
+  options.inputs.insert(options.inputs.begin(), unit_files.begin(), unit_files.end());
+
+  std::string runtime_library = runtimeLibraryPath(argv0);
+  if (llvm::sys::fs::exists(runtime_library)) options.inputs.push_back(runtime_library);
+  // nothing in an instrumented program refers to the profile runtime
+  if (profileGenerate) options.undefined_symbols.push_back("__llvm_profile_runtime");
+
+  if (result == 0) result = linkExecutable(options);
+  for (auto &file: unit_files) llvm::sys::fs::remove(file);
+  if (result == 0) llvm::outs() << "Wrote " << options.output << "\n";
+  return result;
+}
+
+int compile_to_file(CompilationUnit& unit, std::string source_path, std::string output_file_name, EmitKind kind) {
   // Initialize the target registry etc.
  llvm::InitializeAllTargetInfos();
  llvm::InitializeAllTargets();
@@ -119,25 +296,10 @@ int compile_to_object_code(CompilationUnit& unit, std::string output_file_name)
  llvm::InitializeAllAsmPrinters();
 
  llvm::LLVMContext TheContext;
- std::unique_ptr<llvm::Module> TheModule = llvm::make_unique<llvm::Module>("test", TheContext);
-
- LLVMTransformer transformer{TheContext, TheModule.get()};
- llvm::Function *llvmFunction;
-
- for (auto &stmt: unit.stmts()) {
-   if (const DeclStmt *declStmt = dynamic_cast<const DeclStmt*>(stmt.get())) {
-     if (const FuncDecl *func_decl = dynamic_cast<const FuncDecl*>(declStmt->getDecl())) {
-       llvmFunction = transformer.transformFunction(*func_decl);
-       verifyFunction(*llvmFunction);
-     } else if (const ExternFuncDecl *func_decl = dynamic_cast<const ExternFuncDecl*>(declStmt->getDecl())) {
-       llvmFunction = transformer.transformExternalFunctionDecl(*func_decl);
-     } else if (const StructDecl *struct_decl = dynamic_cast<const StructDecl*>(declStmt->getDecl())) {
-       //transformer.transformStructDecl(*struct_decl);
-     } else throw CompilerException(nullptr, "only func decl allowed in top level code");
-   } else throw CompilerException(nullptr, "only func decl allowed in top level code");
-
- }
+ std::unique_ptr<llvm::Module> TheModule = llvm::make_unique<llvm::Module>(source_path, TheContext);
 
+ // the target must be known before codegen, since the calling convention
+ // used for aggregates depends on the target triple and data layout
  auto TargetTriple = llvm::sys::getDefaultTargetTriple();
  TheModule->setTargetTriple(TargetTriple);
 
@@ -155,39 +317,128 @@ int compile_to_object_code(CompilationUnit& unit, std::string output_file_name)
  auto CPU = "generic";
  auto Features = "";
 
+ // with --gc-sections, every function and global has its own section, which
+ // the linker removes if nothing refers to it
  llvm::TargetOptions opt;
- auto RM = llvm::Optional<llvm::Reloc::Model>();
+ opt.FunctionSections = link_options.gc_sections;
+ opt.DataSections = link_options.gc_sections;
+ auto RM = is_pic ? llvm::Optional<llvm::Reloc::Model>(llvm::Reloc::PIC_) : llvm::Optional<llvm::Reloc::Model>();
  auto TheTargetMachine =
      Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
 
  TheModule->setDataLayout(TheTargetMachine->createDataLayout());
+ if (is_pic) {
+   TheModule->setPICLevel(llvm::PICLevel::BigPIC);
+   TheModule->setPIELevel(llvm::PIELevel::Large);
+ }
 
- auto Filename = output_file_name;
- std::error_code EC;
- llvm::raw_fd_ostream dest(Filename, EC, llvm::sys::fs::F_None);
+ LLVMTransformer transformer{TheContext, TheModule.get()};
+ transformer.setBoundsChecking(!noBoundsCheck);
+ llvm::Function *llvmFunction;
 
- std::error_code err_code;
- llvm::raw_fd_ostream ir_stream{llvm::StringRef{"/Users/thomasbarrett/Desktop/app/tree.txt"}, err_code,  llvm::sys::fs::F_None };
- if (printIR) TheModule->print(ir_stream, nullptr);
+ for (auto &stmt: unit.stmts()) {
+   if (const DeclStmt *declStmt = dynamic_cast<const DeclStmt*>(stmt.get())) {
+     if (const FuncDecl *func_decl = dynamic_cast<const FuncDecl*>(declStmt->getDecl())) {
+       // a generic function is only compiled for the type arguments it is
+       // called with
+       if (func_decl->isGeneric()) {
+         for (auto &instance: func_decl->getInstances()) {
+           verifyFunction(*transformer.transformFunction(*instance));
+         }
+         continue;
+       }
+       llvmFunction = transformer.transformFunction(*func_decl);
+       verifyFunction(*llvmFunction);
+     } else if (const ExternFuncDecl *func_decl = dynamic_cast<const ExternFuncDecl*>(declStmt->getDecl())) {
+       llvmFunction = transformer.transformExternalFunctionDecl(*func_decl);
+     } else if (const StructDecl *struct_decl = dynamic_cast<const StructDecl*>(declStmt->getDecl())) {
+       //transformer.transformStructDecl(*struct_decl);
+     } else if (dynamic_cast<const ConstDecl*>(declStmt->getDecl())) {
+       // constants are emitted where they are used
+     } else throw CompilerException(nullptr, "only func decl allowed in top level code");
+   } else throw CompilerException(nullptr, "only func decl allowed in top level code");
 
- if (EC) {
-   llvm::errs() << "Could not open file: " << EC.message();
+ }
+ transformer.transformReferencedFunctions();
+
+ // functions marked inline are always inlined, even with --Onone. Otherwise
+ // the module is optimized, and small functions are inlined by their cost.
+ llvm::legacy::PassManager optimizer;
+ llvm::PassManagerBuilder optimizer_builder;
+ optimizer_builder.OptLevel = Onone ? 0 : 2;
+ optimizer_builder.Inliner = Onone
+   ? llvm::createAlwaysInlinerLegacyPass()
+   : llvm::createFunctionInliningPass(optimizer_builder.OptLevel, optimizer_builder.SizeLevel, false);
+ // with --profile-generate, counters are added to every function before it is
+ // optimized, and written to a .profraw file by the profile runtime in
+ // libbulat.a when the program exits. With --profile-use, the counts of
+ // earlier runs merged by llvm-profdata are attached to the functions and
+ // branches, which guides inlining, block placement and unrolling.
+ optimizer_builder.EnablePGOInstrGen = profileGenerate;
+ optimizer_builder.PGOInstrGen = profileGenerateFile;
+ optimizer_builder.PGOInstrUse = profileUseFile;
+ // with -flto, the optimizations which are better done once the whole
+ // program is known, like unrolling and vectorization, are left to the linker
+ optimizer_builder.PrepareForThinLTO = LTO;
+ if (!profileUseFile.empty() && !llvm::sys::fs::exists(profileUseFile)) {
+   llvm::errs() << "Could not open profile: " << profileUseFile << "\n";
    return 1;
  }
+ TheTargetMachine->adjustPassManager(optimizer_builder);
+ optimizer_builder.populateModulePassManager(optimizer);
+ optimizer.run(*TheModule);
 
- llvm::legacy::PassManager pass;
- auto FileType = llvm::TargetMachine::CGFT_ObjectFile;
+ if (printIR) TheModule->print(llvm::errs(), nullptr);
 
- if (TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType)) {
-   llvm::errs() << "TheTargetMachine can't emit a file of this type";
+ // "-" is standard output. The stream is buffered, and an object file, which
+ // is written out of order, is kept in memory if the output can not seek.
+ auto Filename = output_file_name;
+ std::error_code EC;
+ bool is_text = kind == EmitKind::Assembly || kind == EmitKind::LLVMIR;
+ llvm::raw_fd_ostream dest(Filename, EC, is_text ? llvm::sys::fs::F_Text : llvm::sys::fs::F_None);
+ if (EC) {
+   llvm::errs() << "Could not open file: " << EC.message();
    return 1;
  }
 
- pass.run(*TheModule);
+ switch (kind) {
+   case EmitKind::LLVMIR:
+     TheModule->print(dest, nullptr);
+     break;
+   case EmitKind::Bitcode: {
+     // with -flto, the bitcode carries a summary of the functions of the
+     // module and their references, so that the linker can pick the functions
+     // worth importing into each module without loading the others, and
+     // optimize the modules in parallel. Modules whose summary did not change
+     // are cached by the linker.
+     llvm::ModuleSummaryIndex summary = llvm::buildModuleSummaryIndex(*TheModule, nullptr, nullptr);
+     llvm::WriteBitcodeToFile(*TheModule, dest, false, LTO ? &summary : nullptr);
+     break;
+   }
+   case EmitKind::Assembly:
+   case EmitKind::Object:
+   case EmitKind::Executable: {
+     std::unique_ptr<llvm::buffer_ostream> buffered_dest;
+     llvm::raw_pwrite_stream *code_dest = &dest;
+     if (kind != EmitKind::Assembly && !dest.supportsSeeking()) {
+       buffered_dest = llvm::make_unique<llvm::buffer_ostream>(dest);
+       code_dest = buffered_dest.get();
+     }
+
+     llvm::legacy::PassManager pass;
+     auto FileType = kind == EmitKind::Assembly
+       ? llvm::TargetMachine::CGFT_AssemblyFile
+       : llvm::TargetMachine::CGFT_ObjectFile;
+     if (TheTargetMachine->addPassesToEmitFile(pass, *code_dest, nullptr, FileType)) {
+       llvm::errs() << "TheTargetMachine can't emit a file of this type";
+       return 1;
+     }
+     pass.run(*TheModule);
+     break;
+   }
+ }
  dest.flush();
 
- llvm::outs() << "Wrote " << Filename << "\n";
-
  return 0;
 }
 
@@ -223,9 +474,7 @@ void compileAST(CompilationUnit& unit) {
         if (!Onone) TheFPM->run(*llvmFunction);
       }
 
-      std::error_code err_code;
-      llvm::raw_fd_ostream ir_stream{llvm::StringRef{"/Users/thomasbarrett/Desktop/app/tree.txt"}, err_code,  llvm::sys::fs::F_None };
-      if (printIR) TheModule->print(ir_stream, nullptr);
+      if (printIR) TheModule->print(llvm::errs(), nullptr);
       auto moduleHandle = TheJIT->addModule(std::move(TheModule));
       auto mainFunctionSymbol = TheJIT->findSymbol("main");
       int (*mainFunction)() = (int (*)())(intptr_t)cantFail(mainFunctionSymbol.getAddress());
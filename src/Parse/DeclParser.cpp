@@ -20,7 +20,12 @@ std::unique_ptr<Decl> Parser::parseDecl() {
   switch(token_.type()) {
   case Token::kw_var: return parseVarDecl();
   case Token::kw_let: return parseLetDecl();
-  case Token::kw_func: return parseFuncDecl();
+  case Token::kw_const: return parseConstDecl();
+  case Token::kw_func:
+  case Token::kw_inline: return parseFuncDecl();
+  case Token::at:
+    if (isStructAttribute()) return parseStructDecl();
+    return parseFuncDecl();
   case Token::kw_extern: return parseExternFuncDecl();
   case Token::kw_struct: return parseStructDecl();
   case Token::kw_typealias: return parseTypeAlias();
@@ -36,10 +41,75 @@ std::unique_ptr<TypeAlias> Parser::parseTypeAlias() {
 }
 
 std::unique_ptr<StructDecl> Parser::parseStructDecl() {
+  const char* start = token_.location();
+  auto layout = parseStructAttributes();
   expectToken(Token::kw_struct, "struct");
   auto name = expectToken(Token::identifier, "identifier");
+  auto type_params = acceptToken(Token::l_square) ? parseTypeParamList() : std::vector<Token>();
   auto type = parseStructType();
-  return std::make_unique<StructDecl>(name, type);
+  type->setLayout(layout);
+  auto decl = std::make_unique<StructDecl>(name, type);
+  if (!type_params.empty()) decl->setTypeParams(std::move(type_params), source, start);
+  return decl;
+}
+
+bool Parser::isStructAttribute() {
+  if (!token_.is(Token::at)) return false;
+  Lexer saved_lexer = *lexer;
+  Token saved_token = token_;
+  consume();
+  bool is_struct_attribute = token_.is(Token::identifier) && (
+       token_.lexeme() == StringRef{"packed"}
+    || token_.lexeme() == StringRef{"align"}
+    || token_.lexeme() == StringRef{"reorder"}
+    || token_.lexeme() == StringRef{"soa"});
+  *lexer = saved_lexer;
+  token_ = saved_token;
+  return is_struct_attribute;
+}
+
+StructLayout Parser::parseStructAttributes() {
+  StructLayout layout;
+  while (token_.is(Token::at)) {
+    expectToken(Token::at, "@");
+    Token attribute = expectToken(Token::identifier, "attribute");
+    if (attribute.lexeme() == StringRef{"packed"}) layout.is_packed = true;
+    else if (attribute.lexeme() == StringRef{"reorder"}) layout.is_reordered = true;
+    else if (attribute.lexeme() == StringRef{"soa"}) layout.is_soa = true;
+    else if (attribute.lexeme() == StringRef{"align"}) {
+      expectToken(Token::l_paren, "left parenthesis");
+      auto align = parseIntegerExpr();
+      expectToken(Token::r_paren, "right parenthesis");
+      int64_t value = align->getInt();
+      if (value <= 0 || (value & (value - 1)) != 0) {
+        throw CompilerException(align->location(), "struct alignment must be a power of two");
+      }
+      layout.align = (uint64_t)value;
+    } else {
+      std::stringstream ss;
+      ss << "unknown struct attribute @" << attribute.lexeme();
+      throw CompilerException(attribute.location(), ss.str());
+    }
+    // attributes may be written on the lines before the struct
+    while (token_.is(Token::new_line)) consume();
+  }
+
+  if (layout.is_packed && layout.align) {
+    throw CompilerException(token_.location(), "a struct can not be both @packed and @align");
+  }
+  return layout;
+}
+
+std::vector<Token> Parser::parseTypeParamList() {
+  expectToken(Token::l_square, "left square bracket");
+  std::vector<Token> params{expectToken(Token::identifier, "type parameter")};
+  while (consumeToken(Token::comma)) {
+    params.push_back(expectToken(Token::identifier, "type parameter"));
+  }
+  expectToken(Token::r_square, "right square bracket");
+  // an instance is parsed with its parameters replaced by its arguments
+  if (!type_args_.empty()) return {};
+  return params;
 }
 
 std::unique_ptr<Decl> Parser::parseVarDecl() {
@@ -64,6 +134,16 @@ std::unique_ptr<LetDecl> Parser::parseLetDecl() {
   } else throw CompilerException(token_.location(),  "constants must be initialized at declaration");
 }
 
+std::unique_ptr<ConstDecl> Parser::parseConstDecl() {
+  expectToken(Token::kw_const, "const");
+  auto name = expectToken(Token::identifier, "identifier");
+  expectToken(Token::colon, "colon");
+  Type* type = parseType();
+  if (!consumeOperator("=")) throw CompilerException(token_.location(),  "constants must be initialized at declaration");
+  auto expr = parseExpr();
+  return std::make_unique<ConstDecl>(name, type, std::move(expr));
+}
+
 std::unique_ptr<ParamDecl> Parser::parseParamDecl() {
   auto name = expectToken(Token::identifier, "identifier");
   expectToken(Token::colon, "colon");
@@ -81,17 +161,53 @@ std::vector<std::unique_ptr<ParamDecl>> Parser::parseParamDeclList() {
 }
 
 std::unique_ptr<FuncDecl> Parser::parseFuncDecl() {
+  const char* start = token_.location();
+  auto attributes = parseFuncAttributes();
   expectToken(Token::kw_func, "func");
   auto name = expectToken({Token::identifier, Token::operator_id}, "identifier");
+  auto type_params = acceptToken(Token::l_square) ? parseTypeParamList() : std::vector<Token>();
   expectToken(Token::l_paren, "left parenthesis");
   auto param = acceptToken(Token::r_paren) ? std::vector<std::unique_ptr<ParamDecl>>() : parseParamDeclList();
   expectToken(Token::r_paren, "right parenthesis");
   if (!consumeOperator("->")) throw CompilerException(token_.location(),  "error: expected ->");
   auto type = parseType();
   auto stmt = parseCompoundStmt();
-  return std::make_unique<FuncDecl>(name, std::move(param), type, std::move(stmt));
+  auto decl = std::make_unique<FuncDecl>(name, std::move(param), type, std::move(stmt));
+  decl->setFuncAttributes(attributes);
+  if (!type_params.empty()) decl->setTypeParams(std::move(type_params), source, start);
+  return decl;
 }
 
+FuncAttributes Parser::parseFuncAttributes() {
+  FuncAttributes attributes;
+  while (token_.is(Token::kw_inline) || token_.is(Token::at)) {
+    if (consumeToken(Token::kw_inline)) {
+      attributes.is_inline = true;
+    } else {
+      expectToken(Token::at, "@");
+      Token attribute = expectToken(Token::identifier, "attribute");
+      if (attribute.lexeme() == StringRef{"noinline"}) attributes.is_noinline = true;
+      else if (attribute.lexeme() == StringRef{"hot"}) attributes.is_hot = true;
+      else if (attribute.lexeme() == StringRef{"cold"}) attributes.is_cold = true;
+      else if (attribute.lexeme() == StringRef{"tailcall"}) attributes.is_tailcall = true;
+      else {
+        std::stringstream ss;
+        ss << "unknown function attribute @" << attribute.lexeme();
+        throw CompilerException(attribute.location(), ss.str());
+      }
+    }
+    // attributes may be written on the lines before the function
+    while (token_.is(Token::new_line)) consume();
+  }
+
+  if (attributes.is_inline && attributes.is_noinline) {
+    throw CompilerException(token_.location(), "a function can not be both inline and @noinline");
+  }
+  if (attributes.is_hot && attributes.is_cold) {
+    throw CompilerException(token_.location(), "a function can not be both @hot and @cold");
+  }
+  return attributes;
+}
 
 std::unique_ptr<ExternFuncDecl> Parser::parseExternFuncDecl() {
   expectToken(Token::kw_extern, "extern");
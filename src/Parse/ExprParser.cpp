@@ -117,16 +117,19 @@ unique_ptr<Expr> Parser::parseValueExpr() {
 
 std::unique_ptr<Expr> Parser::parseAccessorExpr() {
   std::unique_ptr<Expr> expr = parseValueExpr();
-  if (acceptToken(Token::dot)) {
-    consume();
-    auto index = parseAccessorExpr();
-    return std::make_unique<AccessorExpr>(std::move(expr), std::move(index));
-  } else if (acceptToken(Token::l_square)) {
-    expectToken(Token::l_square, "[");
-    auto index = parseValueExpr();
-    expectToken(Token::r_square, "]");
-    return std::make_unique<AccessorExpr>(std::move(expr), std::move(index));
-  } else return expr;
+  // accessors apply from left to right, e.g. `a[i].x` is the member x of the
+  // element i of a
+  while (true) {
+    if (consumeToken(Token::dot)) {
+      auto member = parseValueExpr();
+      expr = std::make_unique<AccessorExpr>(std::move(expr), std::move(member));
+    } else if (acceptToken(Token::l_square)) {
+      expectToken(Token::l_square, "[");
+      auto index = parseValueExpr();
+      expectToken(Token::r_square, "]");
+      expr = std::make_unique<AccessorExpr>(std::move(expr), std::move(index));
+    } else return expr;
+  }
 }
 
 unique_ptr<Expr> Parser::parseUnaryExpr() {
@@ -5,6 +5,9 @@ using std::string;
 
 Lexer::Lexer(std::shared_ptr<SourceFile> src) : source{src}, source_iterator{src->begin()} {}
 
+Lexer::Lexer(std::shared_ptr<SourceFile> src, const char* start)
+: source{src}, source_iterator{src->begin() + (start - &*src->begin())} {}
+
 Token Lexer::lexIdentifier()  {
   const char *start = current_loc();
 
@@ -21,6 +24,8 @@ Token Lexer::lexIdentifier()  {
     return Token(Token::kw_let, str_ref);
   } else if (str_ref == StringRef{"func"}) {
     return Token(Token::kw_func, str_ref);
+  } else if (str_ref == StringRef{"inline"}) {
+    return Token(Token::kw_inline, str_ref);
   } else if (str_ref == StringRef{"if"}) {
     return Token(Token::kw_if, str_ref);
   } else if (str_ref == StringRef{"else"}) {
@@ -29,6 +34,16 @@ Token Lexer::lexIdentifier()  {
     return Token(Token::kw_then, str_ref);
   } else if (str_ref == StringRef{"while"}) {
     return Token(Token::kw_while, str_ref);
+  } else if (str_ref == StringRef{"for"}) {
+    return Token(Token::kw_for, str_ref);
+  } else if (str_ref == StringRef{"parallel"}) {
+    return Token(Token::kw_parallel, str_ref);
+  } else if (str_ref == StringRef{"match"}) {
+    return Token(Token::kw_match, str_ref);
+  } else if (str_ref == StringRef{"case"}) {
+    return Token(Token::kw_case, str_ref);
+  } else if (str_ref == StringRef{"in"}) {
+    return Token(Token::kw_in, str_ref);
   } else if (str_ref == StringRef{"return"}) {
     return Token(Token::kw_return, str_ref);
   } else if (str_ref == StringRef{"true"}) {
@@ -43,6 +58,8 @@ Token Lexer::lexIdentifier()  {
     return Token(Token::kw_typedef, str_ref);
   } else if (str_ref == StringRef{"typealias"}) {
     return Token(Token::kw_typealias, str_ref);
+  } else if (str_ref == StringRef{"const"}) {
+    return Token(Token::kw_const, str_ref);
   } else {
     return Token(Token::identifier, str_ref);
   }
@@ -62,8 +79,13 @@ Token Lexer::lexNumber() {
 
   // lex post-radix mantissa
   if (*source_iterator == '.') {
-    floating_point = true;
     source_iterator++;
+    // the integer is the start of a range such as '0..n'
+    if (source_iterator != source->end() && *source_iterator == '.') {
+      source_iterator--;
+      return Token(Token::integer_literal, start, current_loc() - start);
+    }
+    floating_point = true;
     if (source_iterator == source->end()) {
       return Token(Token::double_literal, start, current_loc() - start);
     }
@@ -266,6 +288,9 @@ Token Lexer::lexPunctuation() {
   case '\\':
     tok = Token(Token::backslash, current_loc(), 1);
     break;
+  case '@':
+    tok = Token(Token::at, current_loc(), 1);
+    break;
   case '\n':
     tok = Token(Token::new_line, current_loc(), 1);
     break;
@@ -294,14 +319,14 @@ Token Lexer::next() {
         if (*source_iterator == '.') {
           source_iterator++;
           return Token(Token::elipses, start, current_loc() - start);
-        } else throw CompilerException(start, "invalid lexeme '..'");
+        } else return Token(Token::range, start, current_loc() - start);
       } else return Token(Token::dot, start, current_loc() - start);
     }
 
     // Punctuation Characters
     case '\n': case '{': case '[': case '(':
     case '}': case ']': case ')': case ',':
-    case ';': case ':': case '\\':
+    case ';': case ':': case '\\': case '@':
       return lexPunctuation();
 
     case '/':
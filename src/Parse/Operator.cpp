@@ -7,16 +7,16 @@ OperatorTable::OperatorTable(std::vector<PrecedenceGroup> groups) {
 
 OperatorTable* OperatorTable::globalInstance = new OperatorTable({
   {"Prefix", Associativity::none, Fixity::prefix, false, {
-    "+","-","!","&","*"
+    "+","-","!","&","*","~"
   }},
   {"BitwiseShift", Associativity::none, Fixity::infix, false, {
     "<<",">>"
   }},
   {"Multiplication", Associativity::left, Fixity::infix, false, {
-    "*","/","%"
+    "*","/","%","&"
   }},
   {"Addition", Associativity::left, Fixity::infix, false, {
-    "+","-"
+    "+","-","|","^"
   }},
   {"Comparative", Associativity::none, Fixity::infix, false, {
     "==","!=",">","<",">=","<="
@@ -28,7 +28,7 @@ OperatorTable* OperatorTable::globalInstance = new OperatorTable({
     "||"
   }},
   {"Assignment", Associativity::right, Fixity::infix, true, {
-    "=","+=","-=","*=","/=","%=",">>=","<<="
+    "=","+=","-=","*=","/=","%=",">>=","<<=","&=","|=","^="
   }}
 });
 
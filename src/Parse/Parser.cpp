@@ -14,6 +14,12 @@ Parser::Parser(std::shared_ptr<SourceFile> src) : source{src} {
   token_ = lexer->next();
 }
 
+Parser::Parser(std::shared_ptr<SourceFile> src, const char* start, std::map<std::string, Type*> type_args)
+: source{src}, type_args_{std::move(type_args)} {
+  lexer = std::make_unique<Lexer>(src, start);
+  token_ = lexer->next();
+}
+
 
 //=*****************************************************************************
 //  # Utility
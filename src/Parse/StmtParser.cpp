@@ -10,12 +10,18 @@ std::unique_ptr<Stmt> Parser::parseStmt()  {
     case Token::kw_if: return parseConditionalBlock();
     case Token::kw_return: return parseReturnStmt();
     case Token::kw_while: return parseWhileLoop();
+    case Token::kw_match: return parseMatchStmt();
+    case Token::kw_parallel:
+    case Token::kw_for: return parseForLoop();
     case Token::kw_var:
     case Token::kw_let:
+    case Token::kw_const:
     case Token::kw_func:
+    case Token::kw_inline:
     case Token::kw_extern:
     case Token::kw_struct:
     case Token::kw_typealias: return parseDeclStmt();
+    case Token::at: return parseAttributedStmt();
     case Token::identifier:
     case Token::integer_literal:
     case Token::double_literal:
@@ -29,6 +35,31 @@ std::unique_ptr<Stmt> Parser::parseStmt()  {
   }
 }
 
+// An attribute either names the allocator of a block, as in `@arena { ... }`,
+// or starts the attributes of a function or struct declaration, which are then
+// parsed again from the start.
+std::unique_ptr<Stmt> Parser::parseAttributedStmt() {
+  Lexer saved_lexer = *lexer;
+  Token saved_token = token_;
+  expectToken(Token::at, "@");
+  Token attribute = expectToken(Token::identifier, "attribute");
+
+  CompoundStmt::Allocator allocator;
+  if (attribute.lexeme() == StringRef{"arena"}) {
+    allocator = CompoundStmt::Allocator::Arena;
+  } else if (attribute.lexeme() == StringRef{"pool"}) {
+    allocator = CompoundStmt::Allocator::Pool;
+  } else {
+    *lexer = saved_lexer;
+    token_ = saved_token;
+    return parseDeclStmt();
+  }
+
+  auto block = parseCompoundStmt();
+  block->setAllocator(allocator);
+  return block;
+}
+
 std::unique_ptr<CompoundStmt> Parser::parseCompoundStmt()  {
   expectToken(Token::l_brace, "left brace");
   while(token_.is(Token::new_line)) consume();
@@ -73,6 +104,41 @@ std::unique_ptr<ConditionalBlock> Parser::parseConditionalBlock()  {
   return std::make_unique<ConditionalBlock>(std::move(stmts));
 }
 
+std::unique_ptr<MatchStmt> Parser::parseMatchStmt() {
+  expectToken(Token::kw_match, "match");
+  auto scrutinee = parseExpr();
+  expectToken(Token::l_brace, "left brace");
+  while(token_.is(Token::new_line)) consume();
+
+  std::vector<MatchCase> cases;
+  while (consumeToken(Token::kw_case)) {
+    MatchCase match_case;
+    do {
+      match_case.values.push_back(parseExpr());
+    } while (consumeToken(Token::comma));
+    match_case.block = parseCaseBlock();
+    cases.push_back(std::move(match_case));
+    while(token_.is(Token::new_line)) consume();
+  }
+
+  std::unique_ptr<CompoundStmt> else_block;
+  if (consumeToken(Token::kw_else)) {
+    else_block = parseCaseBlock();
+    while(token_.is(Token::new_line)) consume();
+  }
+  expectToken(Token::r_brace, "right brace");
+  return std::make_unique<MatchStmt>(std::move(scrutinee), std::move(cases), std::move(else_block));
+}
+
+std::unique_ptr<CompoundStmt> Parser::parseCaseBlock() {
+  if (consumeToken(Token::kw_then)) {
+    std::vector<std::unique_ptr<Stmt>> stmts;
+    stmts.push_back(parseStmt());
+    return std::make_unique<CompoundStmt>(std::move(stmts));
+  }
+  return parseCompoundStmt();
+}
+
 std::unique_ptr<DeclStmt> Parser::parseDeclStmt()  {
   auto decl = parseDecl();
   expectToken(Token::new_line, "new line");
@@ -106,6 +172,53 @@ std::unique_ptr<WhileLoop> Parser::parseWhileLoop()  {
   return std::make_unique<WhileLoop>(std::move(expr), std::move(stmt));
 }
 
+std::unique_ptr<ForLoop> Parser::parseForLoop()  {
+  bool is_parallel = consumeToken(Token::kw_parallel);
+  expectToken(Token::kw_for, "for");
+  Token name = expectToken(Token::identifier, "loop variable");
+  auto decl = std::make_unique<LoopVarDecl>(name);
+  expectToken(Token::kw_in, "in");
+  auto expr = parseExpr();
+  if (consumeToken(Token::range)) {
+    auto end = parseExpr();
+    auto reductions = is_parallel ? parseReductionClause() : std::vector<Reduction>();
+    auto stmt = parseCompoundStmt();
+    auto loop = std::make_unique<ForLoop>(std::move(decl), std::move(expr), std::move(end), std::move(stmt));
+    if (is_parallel) loop->setParallel(std::move(reductions));
+    return loop;
+  } else {
+    if (is_parallel) throw CompilerException(expr->location(), "a parallel loop must iterate over a range");
+    auto stmt = parseCompoundStmt();
+    return std::make_unique<ForLoop>(std::move(decl), std::move(expr), std::move(stmt));
+  }
+}
+
+std::vector<Reduction> Parser::parseReductionClause() {
+  std::vector<Reduction> reductions;
+  if (!token_.is(Token::identifier) || token_.lexeme() != StringRef{"reduce"}) return reductions;
+  consume();
+  expectToken(Token::l_paren, "left parenthesis");
+  do {
+    Token op = token_;
+    Reduction::Operator reduction_op;
+    if (op.lexeme() == StringRef{"+"}) reduction_op = Reduction::Operator::Add;
+    else if (op.lexeme() == StringRef{"*"}) reduction_op = Reduction::Operator::Multiply;
+    else if (op.lexeme() == StringRef{"min"}) reduction_op = Reduction::Operator::Min;
+    else if (op.lexeme() == StringRef{"max"}) reduction_op = Reduction::Operator::Max;
+    else {
+      std::stringstream ss;
+      ss << "expected a reduction operator, i.e. +, *, min or max, but found " << op.lexeme();
+      throw CompilerException(op.location(), ss.str());
+    }
+    consume();
+    expectToken(Token::colon, "colon");
+    Token variable = expectToken(Token::identifier, "reduction variable");
+    reductions.push_back(Reduction{reduction_op, std::make_unique<IdentifierExpr>(variable)});
+  } while (consumeToken(Token::comma));
+  expectToken(Token::r_paren, "right parenthesis");
+  return reductions;
+}
+
 std::unique_ptr<ReturnStmt> Parser::parseReturnStmt() {
   expectToken(Token::kw_return, "return");
   if (consumeToken(Token::new_line)) return std::make_unique<ReturnStmt>(nullptr);
@@ -23,13 +23,42 @@ Type* Parser::parseType() {
 
 Type* Parser::parseTypeIdentifier() {
   auto token = expectToken(Token::identifier, "type identifier");
-  if (token.lexeme() == StringRef{"i64"}) return IntegerType::getInstance();
-  else if (token.lexeme()== StringRef{"bool"}) return BooleanType::getInstance();
-  else if (token.lexeme()== StringRef{"f64"}) return DoubleType::getInstance();
-  else if (token.lexeme()== StringRef{"char"}) return CharacterType::getInstance();
+  auto type_arg = type_args_.find(token.lexeme().str());
+  if (type_arg != type_args_.end()) return type_arg->second;
+  if (Type *builtin_type = Type::getBuiltinType(token.lexeme())) return builtin_type;
+  else if (token.lexeme()== StringRef{"vec"} && token_.is(Token::l_square)) return parseVectorType();
+  else if (token.lexeme()== StringRef{"atomic"} && token_.is(Token::l_square)) return parseAtomicType();
+  else if (consumeToken(Token::l_square)) {
+    // the type arguments of a generic struct
+    std::vector<Type*> args{parseType()};
+    while (consumeToken(Token::comma)) {
+      args.push_back(parseType());
+    }
+    expectToken(Token::r_square, "right square bracket");
+    return TypeIdentifier::getInstance(token.lexeme().str(), std::move(args));
+  }
   else return TypeIdentifier::getInstance(token.lexeme().str());
 }
 
+VectorType* Parser::parseVectorType() {
+  expectToken(Token::l_square, "left square bracket");
+  auto type = parseType();
+  expectToken(Token::comma, "comma");
+  auto size = parseIntegerExpr();
+  expectToken(Token::r_square, "right square bracket");
+  if (size->getInt() <= 0) {
+    throw CompilerException(size->location(), "error: vector types must have at least one lane");
+  }
+  return VectorType::getInstance(type, size->getInt());
+}
+
+AtomicType* Parser::parseAtomicType() {
+  expectToken(Token::l_square, "left square bracket");
+  auto type = parseType();
+  expectToken(Token::r_square, "right square bracket");
+  return AtomicType::getInstance(type);
+}
+
 std::vector<Type*> Parser::parseTupleTypeElementList() {
   std::vector<Type*> elements;
   elements.push_back(parseType());
@@ -82,15 +111,6 @@ Type* Parser::parseTupleOrFunctionType() {
   return FunctionType::getInstance(std::move(list), type, false);
 }
 
-ListType* Parser::parseListType() {
-  expectToken(Token::l_square, "left square bracket");
-  auto type = parseType();
-  expectToken(Token::comma, "comma");
-  auto size = parseIntegerExpr();
-  expectToken(Token::r_square, "right square bracket");
-  return ListType::getInstance(type, size->getInt());
-}
-
 PointerType* Parser::parsePointerType() {
   expectToken(Token::operator_id, "*");
   auto type = parseType();
@@ -140,6 +160,12 @@ Type* Parser::parseListOrMapType() {
     return MapType::getInstance(keyType, valueType);
   }
   if (consumeToken(Token::comma)) {
+    // the size may be named by a constant, which is resolved in Sema
+    if (token_.is(Token::identifier)) {
+      auto size_name = expectToken(Token::identifier, "identifier");
+      expectToken(Token::r_square, "right square bracket");
+      return ListType::getInstance(keyType, size_name.lexeme().str());
+    }
     auto size = parseIntegerExpr();
     expectToken(Token::r_square, "right square bracket");
     return ListType::getInstance(keyType, size->getInt());
@@ -0,0 +1,158 @@
+#include "Sema/BoundsCheckEliminator.h"
+
+#include "AST/Decl.h"
+#include "AST/Stmt.h"
+#include "AST/Expr.h"
+#include "AST/Type.h"
+
+#include <functional>
+
+// calls the visitor on the given element and all of its descendants in
+// preorder.
+static void walk(TreeElement &element, const std::function<void(TreeElement&)> &visit) {
+  visit(element);
+  for (TreeElement *child: element.getChildren()) {
+    if (child) walk(*child, visit);
+  }
+}
+
+// returns the declaration referenced by the expression if it is a plain
+// identifier, otherwise nullptr.
+static const Decl* identifierDecl(Expr &expr) {
+  if (IdentifierExpr *id_expr = expr.as<IdentifierExpr>()) {
+    return id_expr->getDecl();
+  } else return nullptr;
+}
+
+// returns true if the expression is the integer literal 1
+static bool isOne(Expr &expr) {
+  IntegerExpr *int_expr = expr.as<IntegerExpr>();
+  return int_expr && int_expr->lexeme() == StringRef{"1"};
+}
+
+// returns true if the given element contains an assignment to decl
+static bool assigns(TreeElement &element, const Decl *decl) {
+  bool found = false;
+  walk(element, [&found, decl](TreeElement &child) {
+    if (BinaryExpr *bin_expr = dynamic_cast<BinaryExpr*>(&child)) {
+      if (bin_expr->isAssignment() && identifierDecl(bin_expr->getLeft()) == decl) {
+        found = true;
+      }
+    }
+  });
+  return found;
+}
+
+// returns true if the length of the aggregate can not change during the
+// lifetime of the declaration. The length of an array is part of its type.
+// The length of a slice is only stable if the slice can not be reassigned,
+// which is the case for parameters.
+static bool hasStableLength(const Decl *decl) {
+  Type *type = decl->getType()->getCanonicalType();
+  if (type->is<ListType>()) {
+    return true;
+  } else if (ReferenceType *ref_type = type->as<ReferenceType>()) {
+    return ref_type->getReferencedType()->getCanonicalType()->is<ListType>();
+  } else if (type->is<SliceType>()) {
+    return decl->getKind() == Decl::Kind::ParamDecl;
+  } else return false;
+}
+
+void BoundsCheckEliminator::eliminate(FuncDecl& func) {
+  induction_variables_.clear();
+  findInductionVariables(func);
+  eliminateInElement(func.getBlockStmt());
+}
+
+void BoundsCheckEliminator::findInductionVariables(FuncDecl& func) {
+  // candidates are integer variables initialized with a literal, which is
+  // always non-negative because the sign is parsed as a unary operator.
+  walk(func.getBlockStmt(), [this](TreeElement &element) {
+    if (VarDecl *var_decl = dynamic_cast<VarDecl*>(&element)) {
+      if (var_decl->getType()->isIntegerType() && var_decl->getExpr().is<IntegerExpr>()) {
+        induction_variables_.insert(var_decl);
+      }
+    }
+  });
+
+  // a candidate remains non-negative as long as it is only incremented by
+  // one, and can not be modified through a reference. Larger steps could
+  // wrap around to a negative value past the bound of the loop.
+  walk(func.getBlockStmt(), [this](TreeElement &element) {
+    if (BinaryExpr *bin_expr = dynamic_cast<BinaryExpr*>(&element)) {
+      if (!bin_expr->isAssignment()) return;
+      const Decl *decl = identifierDecl(bin_expr->getLeft());
+      if (!induction_variables_.count(decl)) return;
+      BinaryExpr *rhs = bin_expr->getRight().as<BinaryExpr>();
+      bool is_increment = bin_expr->isCompoundAssignment()
+        ? bin_expr->getOperator() == StringRef{"+="} && isOne(bin_expr->getRight())
+        : rhs && rhs->getOperator() == StringRef{"+"} && (
+            (identifierDecl(rhs->getLeft()) == decl && isOne(rhs->getRight()))
+          || (identifierDecl(rhs->getRight()) == decl && isOne(rhs->getLeft()))
+          );
+      if (!is_increment) induction_variables_.erase(decl);
+    } else if (UnaryExpr *unary_expr = dynamic_cast<UnaryExpr*>(&element)) {
+      if (unary_expr->getOperator() == StringRef{"&"}) {
+        induction_variables_.erase(identifierDecl(unary_expr->getExpr()));
+      }
+    }
+  });
+}
+
+void BoundsCheckEliminator::eliminateInElement(TreeElement& element) {
+  walk(element, [this](TreeElement &child) {
+    if (WhileLoop *loop = dynamic_cast<WhileLoop*>(&child)) {
+      eliminateInLoop(*loop);
+    } else if (ForLoop *loop = dynamic_cast<ForLoop*>(&child)) {
+      eliminateInLoop(*loop);
+    }
+  });
+}
+
+void BoundsCheckEliminator::eliminateInLoop(WhileLoop& loop) {
+  // the loop condition must be of the form 'i < len(s)'
+  BinaryExpr *condition = loop.getCondition() ? loop.getCondition()->as<BinaryExpr>() : nullptr;
+  if (!condition || condition->getOperator() != StringRef{"<"}) return;
+
+  const Decl *index = identifierDecl(condition->getLeft());
+  if (!induction_variables_.count(index)) return;
+
+  FunctionCall *call = condition->getRight().as<FunctionCall>();
+  if (!call || call->getDecl() || call->getFunctionName() != StringRef{"len"} || call->getArguments().size() != 1) return;
+
+  const Decl *aggregate = identifierDecl(*call->getArguments()[0]);
+  if (!aggregate || !hasStableLength(aggregate)) return;
+
+  // the condition holds until the first statement which assigns the index
+  for (auto &stmt: loop.getBlock()->getStmts()) {
+    if (assigns(*stmt, index)) break;
+    markAccesses(*stmt, aggregate, index);
+  }
+}
+
+void BoundsCheckEliminator::eliminateInLoop(ForLoop& loop) {
+  // the range must be of the form 'n..len(s)', where n is a literal and
+  // therefore non-negative
+  if (!loop.isRange() || !loop.getStart()->is<IntegerExpr>()) return;
+
+  FunctionCall *call = loop.getEnd()->as<FunctionCall>();
+  if (!call || call->getDecl() || call->getFunctionName() != StringRef{"len"} || call->getArguments().size() != 1) return;
+
+  const Decl *aggregate = identifierDecl(*call->getArguments()[0]);
+  if (!aggregate || !hasStableLength(aggregate)) return;
+
+  // the loop variable can not be assigned, so the range holds for the whole
+  // body
+  markAccesses(*loop.getBlock(), aggregate, loop.getDeclaration());
+}
+
+void BoundsCheckEliminator::markAccesses(TreeElement& element, const Decl *aggregate, const Decl *index) {
+  walk(element, [aggregate, index](TreeElement &child) {
+    if (AccessorExpr *accessor = dynamic_cast<AccessorExpr*>(&child)) {
+      if (identifierDecl(accessor->identifier()) == aggregate
+      && identifierDecl(accessor->index()) == index) {
+        accessor->setInBounds(true);
+      }
+    }
+  });
+}
@@ -1,7 +1,10 @@
 #include "Sema/BuiltinDecl.h"
 #include "AST/Decl.h"
 #include "AST/Type.h"
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <vector>
 
 BasicDecl BuiltinDecl::add_int{
   Token{Token::operator_id, StringRef{"+"}}
@@ -217,3 +220,106 @@ BasicDecl BuiltinDecl::double_to_int{
   , IntegerType::getInstance()
   )
 };
+
+// the operators of the sized types and the intrinsics only differ in their
+// operand types, so they are generated from tables rather than declared one
+// by one
+static std::vector<std::unique_ptr<BasicDecl>> generated_decls;
+
+static void addBuiltin(DeclContext *context, const char *name, std::vector<Type*> params, Type *result) {
+  generated_decls.push_back(std::make_unique<BasicDecl>(
+    Token{Token::operator_id, StringRef{name}}
+  , FunctionType::getInstance(std::move(params), result)
+  ));
+  context->addDecl(generated_decls.back().get());
+}
+
+// returns all integer types, i.e. signed and unsigned of each width
+static std::vector<Type*> getIntegerTypes() {
+  std::vector<Type*> types;
+  for (int bits: {8, 16, 32, 64}) {
+    for (bool is_signed: {true, false}) {
+      types.push_back(IntegerType::getInstance(bits, is_signed));
+    }
+  }
+  return types;
+}
+
+void BuiltinDecl::addSizedOperators(DeclContext *context) {
+  std::vector<Type*> types{DoubleType::getInstance(32)};
+  for (Type *type: getIntegerTypes()) {
+    if (type != IntegerType::getInstance()) types.push_back(type);
+  }
+
+  auto add = [context](const char *op, std::vector<Type*> params, Type *result) {
+    addBuiltin(context, op, std::move(params), result);
+  };
+
+  for (Type *type: types) {
+    for (const char *op: {"+", "-", "*", "/", "%"}) {
+      add(op, {type, type}, type);
+    }
+    for (const char *op: {"==", "!=", "<", "<=", ">", ">="}) {
+      add(op, {type, type}, BooleanType::getInstance());
+    }
+    // unsigned values can not be negated
+    IntegerType *int_type = type->as<IntegerType>();
+    if (!int_type || int_type->isSigned()) {
+      add("-", {type}, type);
+    }
+  }
+}
+
+void BuiltinDecl::addBitwiseOperators(DeclContext *context) {
+  for (Type *type: getIntegerTypes()) {
+    for (const char *op: {"&", "|", "^", "<<", ">>"}) {
+      addBuiltin(context, op, {type, type}, type);
+    }
+    addBuiltin(context, "~", {type}, type);
+  }
+}
+
+void BuiltinDecl::addLogicalOperators(DeclContext *context) {
+  Type *boolean = BooleanType::getInstance();
+  for (const char *op: {"&&", "||"}) {
+    addBuiltin(context, op, {boolean, boolean}, boolean);
+  }
+}
+
+void BuiltinDecl::addIntrinsics(DeclContext *context) {
+  for (Type *type: getIntegerTypes()) {
+    for (const char *name: {"popcount", "clz", "ctz"}) {
+      addBuiltin(context, name, {type}, type);
+    }
+    // swapping the bytes of a single byte is meaningless
+    if (type->as<IntegerType>()->bits() > 8) {
+      addBuiltin(context, "bswap", {type}, type);
+    }
+    for (const char *name: {"rotl", "rotr", "min", "max", "expect"}) {
+      addBuiltin(context, name, {type, type}, type);
+    }
+  }
+
+  for (Type *type: {DoubleType::getInstance(32), DoubleType::getInstance()}) {
+    addBuiltin(context, "sqrt", {type}, type);
+    addBuiltin(context, "fma", {type, type, type}, type);
+    addBuiltin(context, "min", {type, type}, type);
+    addBuiltin(context, "max", {type, type}, type);
+  }
+
+  Type *boolean = BooleanType::getInstance();
+  addBuiltin(context, "expect", {boolean, boolean}, boolean);
+  addBuiltin(context, "likely", {boolean}, boolean);
+  addBuiltin(context, "unlikely", {boolean}, boolean);
+  addBuiltin(context, "assume", {boolean}, TupleType::getInstance({}));
+}
+
+bool BuiltinDecl::isIntrinsic(StringRef name) {
+  static const std::array<const char*, 15> intrinsics{{
+    "popcount", "clz", "ctz", "bswap", "rotl", "rotr", "min", "max"
+  , "sqrt", "fma", "expect", "likely", "unlikely", "assume", "prefetch"
+  }};
+  return std::any_of(intrinsics.begin(), intrinsics.end(), [&name](const char *intrinsic) {
+    return name == StringRef{intrinsic};
+  });
+}
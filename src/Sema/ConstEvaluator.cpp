@@ -0,0 +1,556 @@
+#include "Sema/ConstEvaluator.h"
+
+#include "AST/Decl.h"
+#include "AST/Expr.h"
+#include "AST/Stmt.h"
+#include "AST/Type.h"
+#include "Basic/CompilerException.h"
+
+#include <bitset>
+#include <cmath>
+
+// functions may call each other this deep before evaluation is aborted
+static const size_t max_call_depth = 1000;
+
+// statements and loop iterations executed before evaluation is aborted
+static const uint64_t max_steps = 10000000;
+
+// returns the bit width of an integer type. Characters and booleans are
+// compared by all their bits.
+static int bitWidth(Type *type) {
+  IntegerType *int_type = type->as<IntegerType>();
+  return int_type ? int_type->bits() : 64;
+}
+
+static bool isSigned(Type *type) {
+  IntegerType *int_type = type->as<IntegerType>();
+  return int_type && int_type->isSigned();
+}
+
+// returns the bits of an integer without their extension to 64 bits
+static uint64_t lowBits(const ConstantValue &value) {
+  int bits = bitWidth(value.getType());
+  return bits == 64 ? value.getBits() : value.getBits() & ((uint64_t{1} << bits) - 1);
+}
+
+// returns a floating point value, which is rounded to single precision if the
+// type is f32 so that each operation rounds as it does at runtime
+static ConstantValue getRealValue(Type *type, double real) {
+  if (type->as<DoubleType>()->bits() == 32) real = static_cast<float>(real);
+  return ConstantValue::getReal(type, real);
+}
+
+static ConstantValue getBoolValue(bool value) {
+  return ConstantValue::getScalar(BooleanType::getInstance(), value);
+}
+
+static CompilerException notConstant(const char *location, const std::string &what) {
+  return CompilerException(location, what + " can not be evaluated at compile time");
+}
+
+static ConstantValue applyUnaryOperator(StringRef op, const ConstantValue &value, const char *location) {
+  Type *type = value.getType();
+
+  // operators on vectors apply to each lane
+  if (type->is<VectorType>()) {
+    std::vector<ConstantValue> lanes;
+    for (const ConstantValue &lane: value.elements()) {
+      lanes.push_back(applyUnaryOperator(op, lane, location));
+    }
+    return ConstantValue::getAggregate(type, std::move(lanes));
+  }
+
+  if (op == StringRef{"+"} && !type->is<BooleanType>()) return value;
+  if (type->is<DoubleType>() && op == StringRef{"-"}) {
+    return getRealValue(type, -value.getReal());
+  } else if (type->is<IntegerType>() && op == StringRef{"-"}) {
+    return ConstEvaluator::getInteger(type, 0 - value.getBits());
+  } else if (type->is<IntegerType>() && op == StringRef{"~"}) {
+    return ConstEvaluator::getInteger(type, ~value.getBits());
+  } else if (type->is<BooleanType>() && op == StringRef{"!"}) {
+    return getBoolValue(!value.getBool());
+  }
+  throw notConstant(location, "operator '" + op.str() + "'");
+}
+
+static ConstantValue applyBinaryOperator(StringRef op, const ConstantValue &left, const ConstantValue &right, Type *result_type, const char *location) {
+  Type *type = left.getType();
+
+  // operators on vectors apply to each pair of lanes
+  if (VectorType *vector_type = result_type->as<VectorType>()) {
+    Type *lane_type = vector_type->element_type()->getCanonicalType();
+    std::vector<ConstantValue> lanes;
+    for (size_t i = 0; i < left.elements().size(); i++) {
+      lanes.push_back(applyBinaryOperator(op, left.elements()[i], right.elements()[i], lane_type, location));
+    }
+    return ConstantValue::getAggregate(result_type, std::move(lanes));
+  }
+
+  if (type->is<DoubleType>()) {
+    double l = left.getReal(), r = right.getReal();
+    if (op == StringRef{"+"}) return getRealValue(type, l + r);
+    if (op == StringRef{"-"}) return getRealValue(type, l - r);
+    if (op == StringRef{"*"}) return getRealValue(type, l * r);
+    if (op == StringRef{"/"}) return getRealValue(type, l / r);
+    if (op == StringRef{"%"}) return getRealValue(type, std::fmod(l, r));
+    if (op == StringRef{"=="}) return getBoolValue(l == r);
+    if (op == StringRef{"!="}) return getBoolValue(l != r);
+    if (op == StringRef{"<"}) return getBoolValue(l < r);
+    if (op == StringRef{"<="}) return getBoolValue(l <= r);
+    if (op == StringRef{">"}) return getBoolValue(l > r);
+    if (op == StringRef{">="}) return getBoolValue(l >= r);
+    throw notConstant(location, "operator '" + op.str() + "'");
+  }
+
+  // integers, characters and booleans are operated on as their bits, which
+  // wrap around at the width of the type like they do at runtime
+  uint64_t l = left.getBits(), r = right.getBits();
+  int64_t signed_l = left.getInt(), signed_r = right.getInt();
+  bool is_signed = isSigned(type);
+  bool is_integer = type->is<IntegerType>();
+  int bits = bitWidth(type);
+
+  if (op == StringRef{"=="}) return getBoolValue(l == r);
+  if (op == StringRef{"!="}) return getBoolValue(l != r);
+  if (op == StringRef{"<"}) return getBoolValue(is_signed ? signed_l < signed_r : l < r);
+  if (op == StringRef{"<="}) return getBoolValue(is_signed ? signed_l <= signed_r : l <= r);
+  if (op == StringRef{">"}) return getBoolValue(is_signed ? signed_l > signed_r : l > r);
+  if (op == StringRef{">="}) return getBoolValue(is_signed ? signed_l >= signed_r : l >= r);
+
+  if (type->is<BooleanType>()) {
+    if (op == StringRef{"&&"} || op == StringRef{"&"}) return getBoolValue(l && r);
+    if (op == StringRef{"||"} || op == StringRef{"|"}) return getBoolValue(l || r);
+    if (op == StringRef{"^"}) return getBoolValue(l != r);
+  }
+
+  if (is_integer) {
+    if (op == StringRef{"+"}) return ConstEvaluator::getInteger(type, l + r);
+    if (op == StringRef{"-"}) return ConstEvaluator::getInteger(type, l - r);
+    if (op == StringRef{"*"}) return ConstEvaluator::getInteger(type, l * r);
+    if (op == StringRef{"&"}) return ConstEvaluator::getInteger(type, l & r);
+    if (op == StringRef{"|"}) return ConstEvaluator::getInteger(type, l | r);
+    if (op == StringRef{"^"}) return ConstEvaluator::getInteger(type, l ^ r);
+
+    if (op == StringRef{"/"} || op == StringRef{"%"}) {
+      if (r == 0) throw CompilerException(location, "division by zero in constant expression");
+      if (!is_signed) return ConstEvaluator::getInteger(type, op == StringRef{"/"} ? l / r : l % r);
+
+      // the quotient of the smallest integer and -1 is not representable
+      int64_t min = bits == 64 ? INT64_MIN : -(int64_t{1} << (bits - 1));
+      if (signed_l == min && signed_r == -1) {
+        throw CompilerException(location, "signed division overflows in constant expression");
+      }
+      int64_t result = op == StringRef{"/"} ? signed_l / signed_r : signed_l % signed_r;
+      return ConstEvaluator::getInteger(type, static_cast<uint64_t>(result));
+    }
+
+    // the shift amount is taken modulo the bit width, as in codegen
+    uint64_t amount = r & (bits - 1);
+    if (op == StringRef{"<<"}) return ConstEvaluator::getInteger(type, l << amount);
+    if (op == StringRef{">>"}) {
+      uint64_t result = is_signed ? static_cast<uint64_t>(signed_l >> amount) : l >> amount;
+      return ConstEvaluator::getInteger(type, result);
+    }
+  }
+  throw notConstant(location, "operator '" + op.str() + "'");
+}
+
+// converts between integer and floating point types like the conversion
+// builtins, e.g. `u8(x)` or `f64(n)`
+static ConstantValue convertNumber(const ConstantValue &value, Type *target, const char *location) {
+  Type *source = value.getType();
+  if (target->is<DoubleType>()) {
+    if (source->is<DoubleType>()) return getRealValue(target, value.getReal());
+    double real = isSigned(source) ? static_cast<double>(value.getInt()) : static_cast<double>(value.getBits());
+    return getRealValue(target, real);
+  } else if (!source->is<DoubleType>()) {
+    return ConstEvaluator::getInteger(target, value.getBits());
+  }
+
+  // floating point values are rounded towards zero, and the result must be
+  // representable in the target type
+  double real = std::trunc(value.getReal());
+  int bits = bitWidth(target);
+  double min = isSigned(target) ? -std::ldexp(1, bits - 1) : 0;
+  double max = isSigned(target) ? std::ldexp(1, bits - 1) : std::ldexp(1, bits);
+  if (!(real >= min && real < max)) {
+    throw CompilerException(location, "value does not fit in " + target->toString() + " in constant expression");
+  }
+  uint64_t result = isSigned(target)
+    ? static_cast<uint64_t>(static_cast<int64_t>(real))
+    : static_cast<uint64_t>(real);
+  return ConstEvaluator::getInteger(target, result);
+}
+
+static ConstantValue applyIntrinsic(StringRef name, const std::vector<ConstantValue> &args, Type *result_type, const char *location) {
+  if (name == StringRef{"expect"} || name == StringRef{"likely"} || name == StringRef{"unlikely"}) return args[0];
+  if (name == StringRef{"assume"}) {
+    if (!args[0].getBool()) throw CompilerException(location, "assumption does not hold in constant expression");
+    return ConstantValue::getAggregate(result_type, {});
+  }
+
+  Type *type = args[0].getType();
+
+  // all other intrinsics apply to each lane of vectors
+  if (VectorType *vector_type = result_type->as<VectorType>()) {
+    Type *lane_type = vector_type->element_type()->getCanonicalType();
+    std::vector<ConstantValue> lanes;
+    for (size_t i = 0; i < args[0].elements().size(); i++) {
+      std::vector<ConstantValue> lane_args;
+      for (const ConstantValue &arg: args) lane_args.push_back(arg.elements()[i]);
+      lanes.push_back(applyIntrinsic(name, lane_args, lane_type, location));
+    }
+    return ConstantValue::getAggregate(result_type, std::move(lanes));
+  }
+
+  if (type->is<DoubleType>()) {
+    double x = args[0].getReal();
+    if (name == StringRef{"sqrt"}) return getRealValue(type, std::sqrt(x));
+    if (name == StringRef{"fma"}) return getRealValue(type, std::fma(x, args[1].getReal(), args[2].getReal()));
+    if (name == StringRef{"min"}) return getRealValue(type, std::fmin(x, args[1].getReal()));
+    if (name == StringRef{"max"}) return getRealValue(type, std::fmax(x, args[1].getReal()));
+  } else if (type->is<IntegerType>()) {
+    int bits = bitWidth(type);
+    uint64_t x = lowBits(args[0]);
+
+    if (name == StringRef{"popcount"}) {
+      return ConstEvaluator::getInteger(type, std::bitset<64>(x).count());
+    } else if (name == StringRef{"clz"}) {
+      uint64_t count = 0;
+      for (int i = bits - 1; i >= 0 && !((x >> i) & 1); i--) count++;
+      return ConstEvaluator::getInteger(type, count);
+    } else if (name == StringRef{"ctz"}) {
+      uint64_t count = 0;
+      for (int i = 0; i < bits && !((x >> i) & 1); i++) count++;
+      return ConstEvaluator::getInteger(type, count);
+    } else if (name == StringRef{"bswap"}) {
+      uint64_t result = 0;
+      for (int i = 0; i < bits; i += 8) result = (result << 8) | ((x >> i) & 0xff);
+      return ConstEvaluator::getInteger(type, result);
+    } else if (name == StringRef{"rotl"} || name == StringRef{"rotr"}) {
+      // the rotation amount is taken modulo the bit width
+      uint64_t amount = lowBits(args[1]) % bits;
+      if (name == StringRef{"rotr"}) amount = (bits - amount) % bits;
+      uint64_t result = amount == 0 ? x : (x << amount) | (x >> (bits - amount));
+      return ConstEvaluator::getInteger(type, result);
+    } else if (name == StringRef{"min"} || name == StringRef{"max"}) {
+      bool less = isSigned(type) ? args[0].getInt() < args[1].getInt() : args[0].getBits() < args[1].getBits();
+      return (name == StringRef{"min"}) == less ? args[0] : args[1];
+    }
+  }
+  throw notConstant(location, "'" + name.str() + "'");
+}
+
+// returns the value of a variable declared without initializer. Its value is
+// undefined at runtime, but evaluation must be deterministic, so it is zero.
+static ConstantValue getZeroValue(Type *type) {
+  if (type->is<DoubleType>()) return ConstantValue::getReal(type, 0);
+
+  std::vector<ConstantValue> elements;
+  if (ListType *list_type = type->as<ListType>()) {
+    elements.assign(list_type->size(), getZeroValue(list_type->element_type()->getCanonicalType()));
+  } else if (VectorType *vector_type = type->as<VectorType>()) {
+    elements.assign(vector_type->size(), getZeroValue(vector_type->element_type()->getCanonicalType()));
+  } else if (TupleType *tuple_type = type->as<TupleType>()) {
+    for (Type *element: tuple_type->elements()) elements.push_back(getZeroValue(element->getCanonicalType()));
+  } else if (StructType *struct_type = type->as<StructType>()) {
+    for (Type *element: struct_type->elements()) elements.push_back(getZeroValue(element->getCanonicalType()));
+  } else {
+    return ConstantValue::getScalar(type, 0);
+  }
+  return ConstantValue::getAggregate(type, std::move(elements));
+}
+
+ConstantValue ConstEvaluator::getInteger(Type *type, uint64_t value) {
+  int bits = bitWidth(type);
+  if (bits < 64) {
+    uint64_t mask = (uint64_t{1} << bits) - 1;
+    value &= mask;
+    if (isSigned(type) && ((value >> (bits - 1)) & 1)) value |= ~mask;
+  }
+  return ConstantValue::getScalar(type, value);
+}
+
+ConstantValue ConstEvaluator::evaluate(Expr &expr) {
+  if (!location_) location_ = expr.location();
+
+  Type *type = expr.getType()->getCanonicalType();
+  switch (expr.getKind()) {
+    case Expr::Kind::IntegerExpr:
+      return getInteger(type, static_cast<IntegerExpr&>(expr).getInt());
+    case Expr::Kind::DoubleExpr:
+      return getRealValue(type, static_cast<DoubleExpr&>(expr).getDouble());
+    case Expr::Kind::BoolExpr:
+      return ConstantValue::getScalar(type, static_cast<BoolExpr&>(expr).getBool());
+    case Expr::Kind::CharacterExpr:
+      return ConstantValue::getScalar(type, static_cast<uint64_t>(static_cast<CharacterExpr&>(expr).getChar()));
+    case Expr::Kind::ListExpr: {
+      std::vector<ConstantValue> elements;
+      for (auto &element: static_cast<ListExpr&>(expr).elements()) {
+        elements.push_back(evaluate(*element));
+      }
+      return ConstantValue::getAggregate(type, std::move(elements));
+    }
+    case Expr::Kind::TupleExpr: {
+      std::vector<ConstantValue> elements;
+      for (auto &element: static_cast<TupleExpr&>(expr).elements()) {
+        elements.push_back(evaluate(*element));
+      }
+      return ConstantValue::getAggregate(type, std::move(elements));
+    }
+    case Expr::Kind::IdentifierExpr:
+      return evaluateIdentifierExpr(static_cast<IdentifierExpr&>(expr));
+    case Expr::Kind::UnaryExpr:
+      return evaluateUnaryExpr(static_cast<UnaryExpr&>(expr));
+    case Expr::Kind::BinaryExpr:
+      return evaluateBinaryExpr(static_cast<BinaryExpr&>(expr));
+    case Expr::Kind::AccessorExpr:
+      return evaluateAccessorExpr(static_cast<AccessorExpr&>(expr));
+    case Expr::Kind::FunctionCall:
+      return evaluateFunctionCall(static_cast<FunctionCall&>(expr));
+    case Expr::Kind::StringExpr:
+      break;
+  }
+  throw notConstant(expr.location(), "string");
+}
+
+const ConstantValue& ConstEvaluator::evaluateIdentifierExpr(IdentifierExpr &expr) {
+  const Decl *decl = expr.getDecl();
+  if (const ConstDecl *const_decl = dynamic_cast<const ConstDecl*>(decl)) {
+    if (const ConstantValue *value = const_decl->getValue()) return *value;
+  } else if (!frames_.empty()) {
+    auto value_it = frames_.back().find(decl);
+    if (value_it != frames_.back().end()) return value_it->second;
+  }
+
+  // globals and variables of enclosing functions are runtime values
+  throw notConstant(expr.location(), "'" + expr.lexeme().str() + "'");
+}
+
+ConstantValue ConstEvaluator::evaluateUnaryExpr(UnaryExpr &expr) {
+  return applyUnaryOperator(expr.getOperator(), evaluate(expr.getExpr()), expr.location());
+}
+
+ConstantValue ConstEvaluator::evaluateBinaryExpr(BinaryExpr &expr) {
+  if (expr.isAssignment()) return evaluateAssignment(expr);
+
+  // the right operand of a logical operator is only evaluated if it decides
+  // the result, so that it may e.g. guard an array access
+  StringRef op = expr.getOperator();
+  ConstantValue left = evaluate(expr.getLeft());
+  if (left.getType()->is<BooleanType>()) {
+    if (op == StringRef{"&&"} && !left.getBool()) return left;
+    if (op == StringRef{"||"} && left.getBool()) return left;
+  }
+
+  ConstantValue right = evaluate(expr.getRight());
+  return applyBinaryOperator(op, left, right, expr.getType()->getCanonicalType(), expr.location());
+}
+
+ConstantValue ConstEvaluator::evaluateAssignment(BinaryExpr &expr) {
+  // the assigned value is computed before the location, since evaluating it
+  // may call functions which change the frames
+  ConstantValue value = evaluate(expr.getRight());
+  ConstantValue &location = evaluateLocation(expr.getLeft());
+  if (expr.isCompoundAssignment()) {
+    value = applyBinaryOperator(expr.getCompoundOperator(), location, value, location.getType(), expr.location());
+  }
+  location = value;
+  return value;
+}
+
+// returns the index of the accessed element or member, which must be within
+// the bounds of the aggregate
+static size_t elementIndex(AccessorExpr &expr, const ConstantValue &index, size_t size) {
+  bool is_negative = isSigned(index.getType()) && index.getInt() < 0;
+  if (is_negative || index.getBits() >= size) {
+    throw CompilerException(expr.location(), "index out of bounds in constant expression");
+  }
+  return index.getBits();
+}
+
+ConstantValue ConstEvaluator::evaluateIndex(AccessorExpr &expr) {
+  if (expr.hasStaticIndex()) return getInteger(IntegerType::getInstance(), expr.getMemberIndex());
+  return evaluate(expr.index());
+}
+
+ConstantValue ConstEvaluator::evaluateAccessorExpr(AccessorExpr &expr) {
+  ConstantValue index = evaluateIndex(expr);
+
+  // elements of bindings are read in place rather than copying the aggregate
+  if (IdentifierExpr *id_expr = expr.identifier().as<IdentifierExpr>()) {
+    const ConstantValue &aggregate = evaluateIdentifierExpr(*id_expr);
+    return aggregate.elements()[elementIndex(expr, index, aggregate.elements().size())];
+  }
+  ConstantValue aggregate = evaluate(expr.identifier());
+  return aggregate.elements()[elementIndex(expr, index, aggregate.elements().size())];
+}
+
+ConstantValue& ConstEvaluator::evaluateLocation(Expr &expr) {
+  if (IdentifierExpr *id_expr = expr.as<IdentifierExpr>()) {
+    if (!frames_.empty()) {
+      auto value_it = frames_.back().find(id_expr->getDecl());
+      if (value_it != frames_.back().end()) return value_it->second;
+    }
+    throw notConstant(expr.location(), "assignment to '" + id_expr->lexeme().str() + "'");
+  } else if (AccessorExpr *accessor = expr.as<AccessorExpr>()) {
+    // the index is computed before the aggregate is located, as above
+    ConstantValue index = evaluateIndex(*accessor);
+    ConstantValue &aggregate = evaluateLocation(accessor->identifier());
+    return aggregate.elements()[elementIndex(*accessor, index, aggregate.elements().size())];
+  }
+  throw notConstant(expr.location(), "assignment");
+}
+
+ConstantValue ConstEvaluator::evaluateFunctionCall(FunctionCall &call) {
+  std::vector<ConstantValue> args;
+  for (auto &arg: call.getArguments()) {
+    args.push_back(evaluate(*arg));
+  }
+
+  const Decl *decl = call.getDecl();
+  StringRef name = call.getFunctionName();
+  Type *type = call.getType()->getCanonicalType();
+
+  if (const FuncDecl *func = dynamic_cast<const FuncDecl*>(decl)) {
+    return callFunction(*func, std::move(args), call.location());
+  } else if (!decl && name == StringRef{"len"}) {
+    return getInteger(type, args[0].elements().size());
+  } else if (!decl && Type::getBuiltinType(name)) {
+    return convertNumber(args[0], type, call.location());
+  } else if (dynamic_cast<const BasicDecl*>(decl) && (name == StringRef{"Double"} || name == StringRef{"Int"})) {
+    return convertNumber(args[0], type, call.location());
+  } else if (!decl && name == StringRef{"prefetch"}) {
+    return ConstantValue::getAggregate(type, {});
+  } else if (dynamic_cast<const BasicDecl*>(decl) && !dynamic_cast<const ExternFuncDecl*>(decl)) {
+    return applyIntrinsic(name, args, type, call.location());
+  }
+
+  // extern functions and the vector, map and allocation builtins, which access
+  // memory, are only available at runtime
+  throw notConstant(call.location(), "call to '" + name.str() + "'");
+}
+
+ConstantValue ConstEvaluator::callFunction(const FuncDecl &func, std::vector<ConstantValue> args, const char *location) {
+  if (frames_.size() >= max_call_depth) {
+    throw CompilerException(location, "constant evaluation exceeds the maximum call depth");
+  }
+
+  std::map<const Decl*, ConstantValue> frame;
+  for (size_t i = 0; i < args.size(); i++) {
+    frame[func.getParams()[i].get()] = std::move(args[i]);
+  }
+  frames_.push_back(std::move(frame));
+
+  returned_ = false;
+  result_ = ConstantValue::getAggregate(TupleType::getInstance({}), {});
+  executeBlock(func.getBlockStmt());
+  returned_ = false;
+
+  frames_.pop_back();
+  return std::move(result_);
+}
+
+void ConstEvaluator::countStep() {
+  if (++steps_ > max_steps) {
+    throw CompilerException(location_, "constant evaluation takes too many steps");
+  }
+}
+
+void ConstEvaluator::executeBlock(CompoundStmt &block) {
+  for (auto &stmt: block.getStmts()) {
+    execute(*stmt);
+    if (returned_) return;
+  }
+}
+
+void ConstEvaluator::execute(Stmt &stmt) {
+  countStep();
+
+  switch (stmt.getKind()) {
+    case Stmt::Kind::CompoundStmt:
+      return executeBlock(static_cast<CompoundStmt&>(stmt));
+    case Stmt::Kind::ExprStmt:
+      evaluate(*static_cast<ExprStmt&>(stmt).getExpr());
+      return;
+    case Stmt::Kind::ReturnStmt: {
+      ReturnStmt &return_stmt = static_cast<ReturnStmt&>(stmt);
+      if (Expr *expr = return_stmt.getExpr()) result_ = evaluate(*expr);
+      returned_ = true;
+      return;
+    }
+    case Stmt::Kind::DeclStmt: {
+      Decl *decl = static_cast<DeclStmt&>(stmt).getDecl();
+      if (LetDecl *let_decl = dynamic_cast<LetDecl*>(decl)) {
+        frames_.back()[decl] = evaluate(let_decl->getExpr());
+      } else if (VarDecl *var_decl = dynamic_cast<VarDecl*>(decl)) {
+        frames_.back()[decl] = evaluate(var_decl->getExpr());
+      } else if (dynamic_cast<UninitializedVarDecl*>(decl)) {
+        // maps live in the runtime library
+        if (decl->getType()->getCanonicalType()->is<MapType>()) throw notConstant(location_, "map");
+        frames_.back()[decl] = getZeroValue(decl->getType()->getCanonicalType());
+      }
+      // the values of local constants are computed during semantic analysis
+      return;
+    }
+    case Stmt::Kind::ConditionalBlock:
+      for (auto &branch: static_cast<ConditionalBlock&>(stmt).getStmts()) {
+        ConditionalStmt *cond_stmt = dynamic_cast<ConditionalStmt*>(branch.get());
+        if (!cond_stmt) return execute(*branch);
+        if (!cond_stmt->getCondition()) throw notConstant(location_, "conditional binding");
+        if (evaluate(*cond_stmt->getCondition()).getBool()) return executeBlock(cond_stmt->getBlock());
+      }
+      return;
+    case Stmt::Kind::MatchStmt: {
+      MatchStmt &match_stmt = static_cast<MatchStmt&>(stmt);
+      uint64_t bits = evaluate(match_stmt.getScrutinee()).getBits();
+      for (auto &match_case: match_stmt.getCases()) {
+        for (uint64_t constant: match_case.constants) {
+          if (constant == bits) return executeBlock(*match_case.block);
+        }
+      }
+      if (CompoundStmt *else_block = match_stmt.getElse()) return executeBlock(*else_block);
+      return;
+    }
+    case Stmt::Kind::WhileLoop: {
+      WhileLoop &loop = static_cast<WhileLoop&>(stmt);
+      if (!loop.getCondition()) throw notConstant(location_, "conditional binding");
+      while (evaluate(*loop.getCondition()).getBool()) {
+        countStep();
+        executeBlock(*loop.getBlock());
+        if (returned_) return;
+      }
+      return;
+    }
+    case Stmt::Kind::ForLoop: {
+      ForLoop &loop = static_cast<ForLoop&>(stmt);
+      const Decl *loop_var = loop.getDeclaration();
+      if (loop.isRange()) {
+        // the bounds are computed once, like in codegen
+        ConstantValue start = evaluate(*loop.getStart());
+        ConstantValue end = evaluate(*loop.getEnd());
+        Type *type = start.getType();
+        bool is_signed = isSigned(type);
+        for (uint64_t i = start.getBits(); is_signed ? static_cast<int64_t>(i) < end.getInt() : i < end.getBits(); i++) {
+          countStep();
+          frames_.back()[loop_var] = ConstantValue::getScalar(type, i);
+          executeBlock(*loop.getBlock());
+          if (returned_) return;
+        }
+      } else {
+        ConstantValue sequence = evaluate(*loop.getSequence());
+        for (const ConstantValue &element: sequence.elements()) {
+          countStep();
+          frames_.back()[loop_var] = element;
+          executeBlock(*loop.getBlock());
+          if (returned_) return;
+        }
+      }
+      return;
+    }
+    case Stmt::Kind::ConditionalStmt:
+    case Stmt::Kind::CompilationUnit:
+      break;
+  }
+  throw notConstant(location_, "statement");
+}
@@ -0,0 +1,295 @@
+#include "Sema/EffectAnalyzer.h"
+
+#include "AST/Decl.h"
+#include "AST/Stmt.h"
+#include "AST/Expr.h"
+#include "AST/Type.h"
+#include "Sema/TypeChecker.h"
+
+// returns the declaration referenced by the expression if it is a plain
+// identifier, otherwise nullptr.
+static const Decl* identifierDecl(Expr &expr) {
+  if (IdentifierExpr *id_expr = expr.as<IdentifierExpr>()) {
+    return id_expr->getDecl();
+  } else return nullptr;
+}
+
+// returns true if values of the type refer to memory
+static bool isPointerLike(Type *type) {
+  Type *canonical = type->getCanonicalType();
+  return canonical->is<ReferenceType>() || canonical->is<SliceType>();
+}
+
+// returns true if the accessor names a struct member, in which case its index
+// is the member name rather than an expression.
+static bool isPropertyAccess(AccessorExpr &accessor) {
+  return accessor.hasStaticIndex() && accessor.index().is<IdentifierExpr>();
+}
+
+// returns true if the call is to the 'load' or 'store' vector builtin, which
+// access the memory referenced by their first argument
+static bool isVectorMemoryAccess(const FunctionCall &call) {
+  return !call.getDecl() && !call.getArguments().empty()
+    && (call.getFunctionName() == StringRef{"load"} || call.getFunctionName() == StringRef{"store"});
+}
+
+// returns true if the call is to the 'prefetch' builtin, which reads the memory
+// referenced by its argument into the cache
+static bool isPrefetch(const FunctionCall &call) {
+  return !call.getDecl() && call.getFunctionName() == StringRef{"prefetch"};
+}
+
+// returns true if the call is to one of the map builtins or the length of a
+// map, which access the table of the map in the runtime library
+static bool isMapAccess(const FunctionCall &call) {
+  if (call.getDecl() || call.getArguments().empty()) return false;
+  StringRef name = call.getFunctionName();
+  return call.getArguments()[0]->getType()->getCanonicalType()->is<MapType>()
+    && (name == StringRef{"insert"} || name == StringRef{"find"} || name == StringRef{"contains"}
+    || name == StringRef{"erase"} || name == StringRef{"len"});
+}
+
+// returns true if the call is to one of the allocation builtins, which
+// change the state of the allocator of the thread
+static bool isAllocation(const FunctionCall &call) {
+  StringRef name = call.getFunctionName();
+  return !call.getDecl()
+    && (name == StringRef{"new"} || name == StringRef{"alloc"} || name == StringRef{"free"});
+}
+
+// returns true if the call is to one of the atomic builtins, which access
+// memory shared with other threads
+static bool isAtomicAccess(const FunctionCall &call) {
+  return !call.getDecl() && TypeChecker::isAtomicBuiltin(call.getFunctionName());
+}
+
+// returns true if the identifier is used in a way which does not copy the
+// reference, i.e. as the aggregate of an access, dereferenced, as the argument
+// of the 'len' or 'prefetch' builtins, as the sequence of a for loop, or as the
+// memory accessed by a vector load or store.
+static bool isTrackedUse(IdentifierExpr &id_expr, TreeElement *parent) {
+  if (AccessorExpr *accessor = dynamic_cast<AccessorExpr*>(parent)) {
+    return &accessor->identifier() == &id_expr;
+  } else if (ForLoop *loop = dynamic_cast<ForLoop*>(parent)) {
+    return loop->getSequence() == &id_expr;
+  } else if (UnaryExpr *unary_expr = dynamic_cast<UnaryExpr*>(parent)) {
+    return unary_expr->getOperator() == StringRef{"*"};
+  } else if (FunctionCall *call = dynamic_cast<FunctionCall*>(parent)) {
+    if (isVectorMemoryAccess(*call)) return call->getArguments()[0].get() == &id_expr;
+    return (call->getFunctionName() == StringRef{"len"} && !call->getDecl()) || isPrefetch(*call);
+  } else return false;
+}
+
+void EffectAnalyzer::analyze(FuncDecl& func) {
+  params_.clear();
+  reads_unknown_ = false;
+  writes_unknown_ = false;
+  will_return_ = true;
+
+  for (auto &param: func.getParams()) {
+    if (isPointerLike(param->getType())) params_[param.get()] = ParamUsage{};
+  }
+
+  analyzeElement(func.getBlockStmt(), nullptr);
+
+  bool reads = reads_unknown_;
+  bool writes = writes_unknown_;
+  for (auto &entry: params_) {
+    reads = reads || entry.second.reads;
+    writes = writes || entry.second.writes;
+  }
+  func.setMemoryEffects(reads, writes, !reads_unknown_ && !writes_unknown_);
+  func.setWillReturn(will_return_);
+
+  for (auto &param: func.getParams()) {
+    auto usage_it = params_.find(param.get());
+    if (usage_it == params_.end() || usage_it->second.escapes) continue;
+    param->setReadOnly(!usage_it->second.writes);
+
+    // the referenced memory can not be modified through another pointer if
+    // the function writes no memory at all, or if no other memory is accessed
+    bool only_access = !reads_unknown_ && !writes_unknown_;
+    for (auto &other: params_) {
+      if (other.first == param.get()) continue;
+      if (other.second.reads || other.second.writes) only_access = false;
+    }
+    param->setNoAlias(!writes || only_access);
+  }
+}
+
+void EffectAnalyzer::analyzeElement(TreeElement& element, TreeElement* parent) {
+  if (IdentifierExpr *id_expr = dynamic_cast<IdentifierExpr*>(&element)) {
+    auto usage_it = params_.find(id_expr->getDecl());
+    if (usage_it != params_.end() && !isTrackedUse(*id_expr, parent)) {
+      usage_it->second.escapes = true;
+    }
+    return;
+  }
+
+  if (BinaryExpr *bin_expr = dynamic_cast<BinaryExpr*>(&element)) {
+    if (bin_expr->isAssignment()) {
+      // a compound assignment also reads the assigned location
+      AccessorExpr *target = bin_expr->getLeft().as<AccessorExpr>();
+      if (target && bin_expr->isCompoundAssignment()) analyzeAccess(*target, false);
+      analyzeAssignmentTarget(bin_expr->getLeft());
+      analyzeElement(bin_expr->getRight(), bin_expr);
+      return;
+    }
+  } else if (AccessorExpr *accessor = dynamic_cast<AccessorExpr*>(&element)) {
+    analyzeAccess(*accessor, false);
+    analyzeElement(accessor->identifier(), accessor);
+    if (!isPropertyAccess(*accessor)) analyzeElement(accessor->index(), accessor);
+    return;
+  } else if (UnaryExpr *unary_expr = dynamic_cast<UnaryExpr*>(&element)) {
+    if (unary_expr->getOperator() == StringRef{"*"}) {
+      markAccess(unary_expr->getExpr(), false);
+    } else if (unary_expr->getOperator() == StringRef{"&"}) {
+      // a reference to a member or element of a parameter is a copy of the
+      // parameter which can not be tracked
+      Expr *root = &unary_expr->getExpr();
+      while (AccessorExpr *root_accessor = root->as<AccessorExpr>()) {
+        root = &root_accessor->identifier();
+      }
+      auto usage_it = params_.find(identifierDecl(*root));
+      if (usage_it != params_.end()) usage_it->second.escapes = true;
+    }
+  } else if (FunctionCall *call = dynamic_cast<FunctionCall*>(&element)) {
+    analyzeCall(*call);
+  } else if (dynamic_cast<WhileLoop*>(&element)) {
+    will_return_ = false;
+  } else if (CompoundStmt *block = dynamic_cast<CompoundStmt*>(&element)) {
+    // a block with its own allocator pushes it when it is entered
+    if (block->getAllocator() != CompoundStmt::Allocator::Inherited) {
+      reads_unknown_ = true;
+      writes_unknown_ = true;
+      will_return_ = false;
+    }
+  } else if (UninitializedVarDecl *var_decl = dynamic_cast<UninitializedVarDecl*>(&element)) {
+    // a map variable allocates a new table, which aborts if memory is
+    // exhausted
+    if (var_decl->getType()->getCanonicalType()->is<MapType>()) {
+      writes_unknown_ = true;
+      will_return_ = false;
+    }
+  } else if (ForLoop *loop = dynamic_cast<ForLoop*>(&element)) {
+    // the elements of the sequence are read, but a for loop always terminates
+    Expr *sequence = loop->getSequence();
+    if (sequence && isPointerLike(sequence->getType())) markAccess(*sequence, false);
+
+    // the body of a parallel loop is run by the thread pool of the runtime,
+    // and the parameters it uses are passed to the threads
+    if (loop->isParallel()) {
+      reads_unknown_ = true;
+      writes_unknown_ = true;
+      will_return_ = false;
+      markCaptures(*loop->getBlock());
+    }
+  }
+
+  for (TreeElement *child: element.getChildren()) {
+    if (child) analyzeElement(*child, &element);
+  }
+}
+
+void EffectAnalyzer::markCaptures(TreeElement& element) {
+  if (IdentifierExpr *id_expr = dynamic_cast<IdentifierExpr*>(&element)) {
+    auto usage_it = params_.find(id_expr->getDecl());
+    if (usage_it != params_.end()) usage_it->second.escapes = true;
+  }
+  for (TreeElement *child: element.getChildren()) {
+    if (child) markCaptures(*child);
+  }
+}
+
+void EffectAnalyzer::analyzeAccess(AccessorExpr& accessor, bool is_write) {
+  Expr &aggregate = accessor.identifier();
+  if (isPointerLike(aggregate.getType())) {
+    markAccess(aggregate, is_write);
+  } else if (AccessorExpr *inner = aggregate.as<AccessorExpr>()) {
+    // a member of a value is stored wherever the value itself is stored
+    analyzeAccess(*inner, is_write);
+  }
+
+  // runtime indices which are not proven in bounds are checked, and the
+  // check traps if it fails
+  if (!accessor.hasStaticIndex() && !accessor.isInBounds()) {
+    will_return_ = false;
+  }
+}
+
+void EffectAnalyzer::analyzeAssignmentTarget(Expr& target) {
+  AccessorExpr *accessor = target.as<AccessorExpr>();
+  if (!accessor) {
+    analyzeElement(target, nullptr);
+    return;
+  }
+
+  analyzeAccess(*accessor, true);
+
+  // the assigned location is computed but never read, so only the indices
+  // and the pointer it is accessed through are evaluated
+  while (accessor) {
+    if (!isPropertyAccess(*accessor)) analyzeElement(accessor->index(), accessor);
+    Expr &aggregate = accessor->identifier();
+    AccessorExpr *inner = aggregate.as<AccessorExpr>();
+    if (inner && !isPointerLike(aggregate.getType())) {
+      accessor = inner;
+    } else {
+      analyzeElement(aggregate, accessor);
+      accessor = nullptr;
+    }
+  }
+}
+
+void EffectAnalyzer::analyzeCall(FunctionCall& call) {
+  const Decl *decl = call.getDecl();
+
+  if (const FuncDecl *callee = dynamic_cast<const FuncDecl*>(decl)) {
+    reads_unknown_ = reads_unknown_ || callee->readsMemory();
+    writes_unknown_ = writes_unknown_ || callee->writesMemory();
+    will_return_ = will_return_ && callee->willReturn();
+  } else if (dynamic_cast<const ExternFuncDecl*>(decl)) {
+    reads_unknown_ = true;
+    writes_unknown_ = true;
+    will_return_ = false;
+  } else if (isVectorMemoryAccess(call)) {
+    Expr &sequence = *call.getArguments()[0];
+    if (isPointerLike(sequence.getType())) {
+      markAccess(sequence, call.getFunctionName() == StringRef{"store"});
+    }
+    // the accessed lanes are checked against the length of the sequence
+    will_return_ = false;
+  } else if (isPrefetch(call)) {
+    markAccess(*call.getArguments()[0], false);
+  } else if (isAtomicAccess(call)) {
+    // an atomic access may synchronize with another thread, which makes the
+    // writes of that thread visible
+    reads_unknown_ = true;
+    writes_unknown_ = true;
+  } else if (isMapAccess(call)) {
+    reads_unknown_ = true;
+    if (call.getFunctionName() == StringRef{"insert"} || call.getFunctionName() == StringRef{"erase"}) {
+      writes_unknown_ = true;
+    }
+    // inserting aborts if the table can not grow
+    if (call.getFunctionName() == StringRef{"insert"}) will_return_ = false;
+  } else if (isAllocation(call)) {
+    reads_unknown_ = true;
+    writes_unknown_ = true;
+    // allocating aborts if memory is exhausted
+    if (call.getFunctionName() != StringRef{"free"}) will_return_ = false;
+  }
+
+  // all other calls are builtins and intrinsics, which do not access memory
+}
+
+void EffectAnalyzer::markAccess(Expr& aggregate, bool is_write) {
+  auto usage_it = params_.find(identifierDecl(aggregate));
+  if (usage_it != params_.end()) {
+    if (is_write) usage_it->second.writes = true;
+    else usage_it->second.reads = true;
+  } else {
+    if (is_write) writes_unknown_ = true;
+    else reads_unknown_ = true;
+  }
+}
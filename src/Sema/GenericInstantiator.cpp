@@ -0,0 +1,77 @@
+#include "Sema/GenericInstantiator.h"
+#include "Sema/ScopeBuilder.h"
+#include "Sema/TypeResolver.h"
+
+#include "Basic/CompilerException.h"
+
+#include "AST/Decl.h"
+#include "AST/Type.h"
+#include "Parse/Parser.h"
+
+// Instances which refer to other instances of the same declaration with
+// different type arguments, e.g. `f[T]` calling `f` with `&T`, would create
+// instances forever, so the nesting of instantiations is limited.
+static const int max_instantiation_depth = 64;
+static int instantiation_depth = 0;
+
+// returns the substitution of the type parameters by the type arguments, after
+// checking that there is one argument for each parameter.
+template <typename D>
+static std::map<std::string, Type*> getSubstitution(const D& generic, const std::vector<Type*>& type_args) {
+  const std::vector<Token>& params = generic.getTypeParams();
+  if (params.size() != type_args.size()) {
+    std::stringstream ss;
+    ss << generic.getName() << " expects " << params.size() << " type arguments but got " << type_args.size();
+    throw CompilerException(generic.location(), ss.str());
+  }
+
+  std::map<std::string, Type*> substitution;
+  for (size_t i = 0; i < params.size(); i++) {
+    substitution[params[i].lexeme().str()] = type_args[i];
+  }
+  return substitution;
+}
+
+// keeps track of the nesting of instantiations while an instance is checked
+class InstantiationScope {
+public:
+  InstantiationScope(const char* location) {
+    if (instantiation_depth >= max_instantiation_depth) {
+      throw CompilerException(location, "generic instantiations are nested too deeply");
+    }
+    instantiation_depth++;
+  }
+  ~InstantiationScope() {
+    instantiation_depth--;
+  }
+};
+
+FuncDecl& GenericInstantiator::instantiate(FuncDecl& generic, const std::vector<Type*>& type_args) {
+  if (FuncDecl *instance = generic.getInstance(type_args)) return *instance;
+
+  InstantiationScope scope{generic.location()};
+  Parser parser{generic.getSource(), generic.getStart(), getSubstitution(generic, type_args)};
+  std::unique_ptr<FuncDecl> parsed = parser.parseFuncDecl();
+  parsed->setTypeArgs(type_args);
+
+  // the instance is declared where its generic function is, but it is not
+  // added to the scope, so that calls always refer to the generic function
+  FuncDecl *instance = generic.addInstance(std::move(parsed));
+  instance->setParentContext(generic.getDeclContext()->getParentContext());
+  ScopeBuilder{}.buildFuncDeclScope(*instance);
+  return *instance;
+}
+
+StructDecl& GenericInstantiator::instantiate(StructDecl& generic, const std::vector<Type*>& type_args) {
+  if (StructDecl *instance = generic.getInstance(type_args)) return *instance;
+
+  InstantiationScope scope{generic.location()};
+  Parser parser{generic.getSource(), generic.getStart(), getSubstitution(generic, type_args)};
+  std::unique_ptr<StructDecl> parsed = parser.parseStructDecl();
+  parsed->setTypeArgs(type_args);
+
+  StructDecl *instance = generic.addInstance(std::move(parsed));
+  instance->setParentContext(generic.getDeclContext());
+  TypeResolver{*generic.getDeclContext()}.resolve(*instance->getType());
+  return *instance;
+}
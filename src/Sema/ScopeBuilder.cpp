@@ -2,6 +2,10 @@
 #include "Sema/TypeChecker.h"
 #include "Sema/BuiltinDecl.h"
 #include "Sema/TypeResolver.h"
+#include "Sema/BoundsCheckEliminator.h"
+#include "Sema/EffectAnalyzer.h"
+#include "Sema/TailCallAnalyzer.h"
+#include "Sema/ConstEvaluator.h"
 
 #include "Basic/CompilerException.h"
 
@@ -10,8 +14,15 @@
 #include "AST/Decl.h"
 #include "AST/Expr.h"
 
+#include <set>
+
 void ScopeBuilder::buildGlobalScope() {
   DeclContext* global_context = DeclContext::getGlobalContext();
+
+  // the builtins are shared by all compilation units, and adding them again
+  // would make their lookup ambiguous
+  if (!global_context->getDeclMap().empty()) return;
+
   global_context->addDecl(&BuiltinDecl::add_int);
   global_context->addDecl(&BuiltinDecl::sub_int);
   global_context->addDecl(&BuiltinDecl::mul_int);
@@ -42,15 +53,73 @@ void ScopeBuilder::buildGlobalScope() {
 
   global_context->addDecl(&BuiltinDecl::int_to_double);
   global_context->addDecl(&BuiltinDecl::double_to_int);
+
+  BuiltinDecl::addSizedOperators(global_context);
+  BuiltinDecl::addBitwiseOperators(global_context);
+  BuiltinDecl::addLogicalOperators(global_context);
+  BuiltinDecl::addIntrinsics(global_context);
+}
+
+// returns true if the declaration is a generic function or struct, which is
+// only checked for each of its instances
+static bool isGenericDecl(const Decl &decl) {
+  if (const FuncDecl *func_decl = dynamic_cast<const FuncDecl*>(&decl)) {
+    return func_decl->isGeneric();
+  } else if (const StructDecl *struct_decl = dynamic_cast<const StructDecl*>(&decl)) {
+    return struct_decl->isGeneric();
+  } else return false;
 }
 
 void ScopeBuilder::buildCompilationUnitScope(CompilationUnit &unit) {
   buildGlobalScope();
   DeclContext* unitContext = unit.getDeclContext();
   unitContext->setParentContext(DeclContext::getGlobalContext());
+  buildUnitDeclScopes(unit);
+}
+
+// returns true if both declarations are extern functions of the same type,
+// which refer to the same external symbol
+static bool isSameExternFunc(Decl &decl1, Decl &decl2) {
+  return dynamic_cast<ExternFuncDecl*>(&decl1) && dynamic_cast<ExternFuncDecl*>(&decl2)
+      && decl1.getType()->getCanonicalType() == decl2.getType()->getCanonicalType();
+}
+
+void ScopeBuilder::buildCompilationUnitScope(CompilationUnit &unit, DeclContext &program) {
+  buildGlobalScope();
+  program.setParentContext(DeclContext::getGlobalContext());
+  DeclContext* unitContext = unit.getDeclContext();
+  unitContext->setParentContext(&program);
+  buildUnitDeclScopes(unit);
+
+  for (auto &entry: unitContext->getDeclMap()) {
+    Decl* decl = entry.second;
+    auto existing = program.getDeclMap().equal_range(entry.first);
+    bool is_duplicate = false;
+    for (auto it = existing.first; it != existing.second; it++) {
+      // functions may be overloaded across units as they are within one
+      const Type* type1 = decl->getType()->getCanonicalType();
+      const Type* type2 = it->second->getType()->getCanonicalType();
+      bool is_overload = type1->is<FunctionType>() && type2->is<FunctionType>() && type1 != type2;
+      if (is_overload) continue;
+      if (!isSameExternFunc(*decl, *it->second)) {
+        throw CompilerException(decl->location(), "'" + entry.first.str() + "' is already declared by another compilation unit");
+      }
+      is_duplicate = true;
+    }
+    if (!is_duplicate) program.addDecl(decl);
+  }
+}
+
+void ScopeBuilder::buildUnitDeclScopes(CompilationUnit &unit) {
+  DeclContext* unitContext = unit.getDeclContext();
   for (auto &stmt: unit.stmts()) {
     if (DeclStmt *decl_stmt = dynamic_cast<DeclStmt*>(stmt.get())) {
       Decl* decl = decl_stmt->getDecl();
+      if (isGenericDecl(*decl)) {
+        decl->setParentContext(unitContext);
+        unitContext->addDecl(decl);
+        continue;
+      }
       TypeResolver{*unitContext}.resolve(*decl->getType());
       if (FuncDecl *funcDecl = dynamic_cast<FuncDecl*>(decl)) {
         decl->setParentContext(unitContext);
@@ -66,6 +135,7 @@ void ScopeBuilder::buildCompilationUnitScope(CompilationUnit &unit) {
 
 
 void ScopeBuilder::buildDeclScope(class Decl& decl) {
+  if (isGenericDecl(decl)) return;
 
   TypeResolver{*decl.getDeclContext()}.resolve(*decl.getType());
 
@@ -73,6 +143,12 @@ void ScopeBuilder::buildDeclScope(class Decl& decl) {
     case Decl::Kind::LetDecl:
       buildLetDeclScope(static_cast<LetDecl&>(decl));
       break;
+    case Decl::Kind::ConstDecl:
+      buildConstDeclScope(static_cast<ConstDecl&>(decl));
+      break;
+    case Decl::Kind::LoopVarDecl:
+      // loop variables are declared by their loop in buildForLoopScope
+      break;
     case Decl::Kind::VarDecl:
       buildVarDeclScope(static_cast<VarDecl&>(decl));
       break;
@@ -98,8 +174,17 @@ void ScopeBuilder::buildDeclScope(class Decl& decl) {
 }
 
 void ScopeBuilder::buildLetDeclScope(LetDecl& decl) {
+  if (decl.getType()->getCanonicalType()->is<AtomicType>()) {
+    throw CompilerException(nullptr, "atomic " + decl.getName().str() + " must be declared with var");
+  }
   if (Expr *expr = &decl.getExpr()) {
     TypeChecker{decl.getDeclContext()}.checkExpr(*expr);
+    TypeChecker{decl.getDeclContext()}.convertLiteral(*expr, decl.getType()->getCanonicalType());
+
+    // slices are initialized from a reference to an array of known length
+    if (decl.getType()->getCanonicalType()->is<SliceType>()) {
+      if (TypeChecker{decl.getDeclContext()}.is_implicitly_assignable_to(decl.getType(), expr->getType())) return;
+    }
 
     if (decl.getType()->getKind() == Type::Kind::ReferenceType) {
       const ReferenceType *ref_type = dynamic_cast<const ReferenceType*>(decl.getType());
@@ -115,7 +200,7 @@ void ScopeBuilder::buildLetDeclScope(LetDecl& decl) {
       }
     }
 
-    if (decl.getType() != expr->getType()) {
+    if (decl.getType()->getCanonicalType() != expr->getType()->getCanonicalType()) {
       std::stringstream ss;
       ss << decl.getName() << " is declared as `";
       ss << decl.getType()->toString() << "` but initialized as `";
@@ -125,10 +210,50 @@ void ScopeBuilder::buildLetDeclScope(LetDecl& decl) {
   }
 }
 
+void ScopeBuilder::buildConstDeclScope(ConstDecl& decl) {
+  Expr &expr = decl.getExpr();
+  Type *type = decl.getType()->getCanonicalType();
+  TypeChecker{decl.getDeclContext()}.checkExpr(expr);
+  TypeChecker{decl.getDeclContext()}.convertLiteral(expr, type);
+
+  // the value of a constant is computed at compile time, so it can not refer
+  // to memory, and is never written
+  if (type->is<ReferenceType>() || type->is<SliceType>() || type->is<PointerType>() || type->is<MapType>()
+      || type->is<AtomicType>()) {
+    std::stringstream ss;
+    ss << "constant " << decl.getName() << " can not be of type `" << type->toString() << "`";
+    throw CompilerException(decl.location(), ss.str());
+  }
+
+  if (type != expr.getType()->getCanonicalType()) {
+    std::stringstream ss;
+    ss << decl.getName() << " is declared as `";
+    ss << decl.getType()->toString() << "` but initialized as `";
+    ss << expr.getType()->toString() << "`";
+    throw CompilerException(decl.location(), ss.str());
+  }
+
+  decl.setValue(ConstEvaluator{}.evaluate(expr));
+}
+
 void ScopeBuilder::buildVarDeclScope(VarDecl& decl) {
   if (Expr *expr = &decl.getExpr()) {
     TypeChecker{decl.getDeclContext()}.checkExpr(*expr);
 
+    // an atomic is initialized with a value before it can be shared
+    if (AtomicType *atomic_type = decl.getType()->getCanonicalType()->as<AtomicType>()) {
+      Type *value_type = atomic_type->getValueType()->getCanonicalType();
+      TypeChecker{decl.getDeclContext()}.convertLiteral(*expr, value_type);
+      if (expr->getType()->getCanonicalType() == value_type) return;
+    }
+
+    TypeChecker{decl.getDeclContext()}.convertLiteral(*expr, decl.getType()->getCanonicalType());
+
+    // slices are initialized from a reference to an array of known length
+    if (decl.getType()->getCanonicalType()->is<SliceType>()) {
+      if (TypeChecker{decl.getDeclContext()}.is_implicitly_assignable_to(decl.getType(), expr->getType())) return;
+    }
+
     if (decl.getType()->getKind() == Type::Kind::ReferenceType) {
       const ReferenceType *ref_type = dynamic_cast<const ReferenceType*>(decl.getType());
       if (ref_type->getReferencedType() == expr->getType()) {
@@ -175,9 +300,14 @@ void ScopeBuilder::buildFuncDeclScope(FuncDecl& decl) {
 
   decl.getBlockStmt().getDeclContext()->setParentContext(functionScope);
   buildCompoundStmtScope(decl.getBlockStmt());
+  checkMapUses(decl.getBlockStmt(), nullptr);
+  checkAtomicAccesses(decl.getBlockStmt(), nullptr);
   if (!decl.getBlockStmt().returns()) {
     throw CompilerException(decl.getName().start, "function is not guarenteed to return");
   }
+  BoundsCheckEliminator{}.eliminate(decl);
+  EffectAnalyzer{}.analyze(decl);
+  TailCallAnalyzer{}.analyze(decl);
 }
 
 void ScopeBuilder::buildBasicDeclScope(BasicDecl& decl) {
@@ -199,14 +329,24 @@ void ScopeBuilder::buildStmtScope(Stmt& stmt, DeclContext *parent) {
   } else if (WhileLoop *loop = dynamic_cast<WhileLoop*>(&stmt)) {
     loop->setParentContext(parent);
     buildWhileLoopScope(*loop);
+  } else if (ForLoop *loop = dynamic_cast<ForLoop*>(&stmt)) {
+    loop->setParentContext(parent);
+    buildForLoopScope(*loop);
   } else if (ReturnStmt *ret_stmt = dynamic_cast<ReturnStmt*>(&stmt)) {
     if (Expr *expr = ret_stmt->getExpr()) {
       TypeChecker{parent}.checkExpr(*expr);
       Type* ret_type = dynamic_cast<const FunctionType*>(function_->getType())->getReturnType();
+      TypeChecker{parent}.convertLiteral(*expr, ret_type->getCanonicalType());
       if (expr->getType()->getCanonicalType() != ret_type->getCanonicalType()) {
         throw CompilerException(nullptr, "type of returned expression does not match declaration");
       }
     }
+  } else if (CompoundStmt *block_stmt = dynamic_cast<CompoundStmt*>(&stmt)) {
+    // blocks within blocks, e.g. those marked `@arena`
+    block_stmt->setParentContext(parent);
+    buildCompoundStmtScope(*block_stmt);
+  } else if (MatchStmt *match_stmt = dynamic_cast<MatchStmt*>(&stmt)) {
+    buildMatchStmtScope(*match_stmt, parent);
   } else if (ConditionalBlock *cond_stmt = dynamic_cast<ConditionalBlock*>(&stmt)) {
     for (auto &stmt: cond_stmt->getStmts()) {
       if (ConditionalStmt *cond_stmt = dynamic_cast<ConditionalStmt*>(stmt.get())) {
@@ -249,6 +389,156 @@ void ScopeBuilder::buildWhileLoopScope(class WhileLoop &while_loop) {
   buildCompoundStmtScope(*while_loop.getBlock());
 }
 
+void ScopeBuilder::buildForLoopScope(class ForLoop &for_loop) {
+  DeclContext *loop_scope = for_loop.getDeclContext();
+  LoopVarDecl *loop_var = for_loop.getDeclaration();
+
+  // the bounds are checked before the loop variable is declared, so they may
+  // not refer to it
+  if (for_loop.isRange()) {
+    Expr *start = for_loop.getStart();
+    Expr *end = for_loop.getEnd();
+    TypeChecker{loop_scope}.checkExpr(*start);
+    TypeChecker{loop_scope}.checkExpr(*end);
+    // a literal bound takes the type of the other bound, e.g. in `0..n`
+    if (!TypeChecker{loop_scope}.convertLiteral(*start, end->getType()->getCanonicalType())) {
+      TypeChecker{loop_scope}.convertLiteral(*end, start->getType()->getCanonicalType());
+    }
+    if (!start->getType()->isIntegerType() || start->getType()->getCanonicalType() != end->getType()->getCanonicalType()) {
+      throw CompilerException(
+        start->location()
+      , "error: range bounds must be integers of the same type"
+      );
+    }
+    loop_var->setType(start->getType()->getCanonicalType());
+  } else {
+    Expr *sequence = for_loop.getSequence();
+    TypeChecker{loop_scope}.checkExpr(*sequence);
+    Type *sequence_type = sequence->getType()->getCanonicalType();
+    if (ReferenceType *ref_type = sequence_type->as<ReferenceType>()) {
+      sequence_type = ref_type->getReferencedType()->getCanonicalType();
+    }
+    if (ListType *list_type = sequence_type->as<ListType>()) {
+      loop_var->setType(list_type->element_type());
+    } else if (SliceType *slice_type = sequence_type->as<SliceType>()) {
+      loop_var->setType(slice_type->element());
+    } else {
+      throw CompilerException(
+        sequence->location()
+      , "error: unable to iterate over `" + sequence->getType()->toString() + "`"
+      );
+    }
+  }
+
+  // reduction variables are declared outside of the loop, so they are looked
+  // up before the loop variable can shadow them
+  if (for_loop.isParallel()) checkReductions(for_loop);
+
+  loop_scope->addDecl(loop_var);
+  loop_var->setParentContext(loop_scope);
+  for_loop.getBlock()->setParentContext(loop_scope);
+  buildCompoundStmtScope(*for_loop.getBlock());
+
+  if (for_loop.isParallel()) checkParallelBody(*for_loop.getBlock(), for_loop, false);
+}
+
+void ScopeBuilder::checkReductions(ForLoop &for_loop) {
+  std::set<const Decl*> reduced;
+  for (Reduction &reduction: for_loop.getReductions()) {
+    IdentifierExpr &variable = *reduction.variable;
+    TypeChecker{for_loop.getDeclContext()}.checkExpr(variable);
+    const Decl *decl = variable.getDecl();
+    if (decl->getKind() != Decl::Kind::VarDecl && decl->getKind() != Decl::Kind::UninitializedVarDecl) {
+      throw CompilerException(
+        variable.location()
+      , "error: `" + variable.lexeme().str() + "` must be a variable to be reduced"
+      );
+    }
+    Type *type = variable.getType();
+    if (!type->isIntegerType() && !type->isDoubleType()) {
+      throw CompilerException(
+        variable.location()
+      , "error: unable to reduce `" + variable.lexeme().str() + "` of type `" + type->toString() + "`"
+      );
+    }
+    if (!reduced.insert(decl).second) {
+      throw CompilerException(
+        variable.location()
+      , "error: `" + variable.lexeme().str() + "` is reduced more than once"
+      );
+    }
+  }
+}
+
+// returns true if the declaration is made within the scope
+static bool isDeclaredIn(const Decl *decl, const DeclContext *scope) {
+  for (const DeclContext *context = decl->getDeclContext(); context; context = context->getParentContext()) {
+    if (context == scope) return true;
+  }
+  return false;
+}
+
+void ScopeBuilder::checkParallelBody(TreeElement &element, ForLoop &for_loop, bool has_allocator) {
+  if (dynamic_cast<ReturnStmt*>(&element)) {
+    throw CompilerException(nullptr, "error: unable to return from a parallel loop");
+  }
+
+  // the allocator stack is per thread, so the workers running the body do not
+  // see the allocators of the blocks around the loop
+  CompoundStmt *block = dynamic_cast<CompoundStmt*>(&element);
+  if (block && block->getAllocator() != CompoundStmt::Allocator::Inherited) has_allocator = true;
+  FunctionCall *call = dynamic_cast<FunctionCall*>(&element);
+  if (call && !call->getDecl() && TypeChecker::isAllocationBuiltin(call->getFunctionName()) && !has_allocator) {
+    throw CompilerException(
+      call->location()
+    , "error: `" + call->getFunctionName().str() + "` in a parallel loop must be within an @arena or @pool block of the loop"
+    );
+  }
+
+  // iterations run concurrently, so variables declared outside of the loop
+  // may only be written through a reduction
+  BinaryExpr *binary_expr = dynamic_cast<BinaryExpr*>(&element);
+  if (binary_expr && binary_expr->isAssignment()) {
+    IdentifierExpr *target = binary_expr->getLeft().as<IdentifierExpr>();
+    const Decl *decl = target ? target->getDecl() : nullptr;
+    if (decl && !isDeclaredIn(decl, for_loop.getDeclContext())) {
+      bool is_reduced = false;
+      for (Reduction &reduction: for_loop.getReductions()) {
+        if (reduction.variable->getDecl() == decl) is_reduced = true;
+      }
+      if (!is_reduced) {
+        throw CompilerException(
+          target->location()
+        , "error: `" + target->lexeme().str() + "` is assigned in a parallel loop but not reduced"
+        );
+      }
+    }
+  }
+
+  for (TreeElement *child: element.getChildren()) {
+    if (child) checkParallelBody(*child, for_loop, has_allocator);
+  }
+}
+
+void ScopeBuilder::checkAtomicAccesses(TreeElement &element, TreeElement *parent) {
+  // the builtins take a reference to the atomic, so any other use of it
+  // would read or write it without an atomic instruction
+  Expr *expr = dynamic_cast<Expr*>(&element);
+  if (expr && expr->getType() && expr->getType()->getCanonicalType()->is<AtomicType>()) {
+    UnaryExpr *unary_expr = dynamic_cast<UnaryExpr*>(parent);
+    if (!unary_expr || unary_expr->getOperator() != StringRef{"&"}) {
+      throw CompilerException(
+        expr->location()
+      , "error: atomics may only be accessed through the atomic builtins, e.g. atomic_load(&x)"
+      );
+    }
+  }
+
+  for (TreeElement *child: element.getChildren()) {
+    if (child) checkAtomicAccesses(*child, &element);
+  }
+}
+
 void ScopeBuilder::buildConditionalStmtScope(class ConditionalStmt &cond_stmt) {
   DeclContext *cond_scope = cond_stmt.getDeclContext();
   // if conditional statement is not a 'else' stmt - check its expression
@@ -269,3 +559,74 @@ void ScopeBuilder::buildConditionalStmtScope(class ConditionalStmt &cond_stmt) {
   cond_stmt.getBlock().setParentContext(cond_scope);
   buildCompoundStmtScope(cond_stmt.getBlock());
 }
+
+void ScopeBuilder::buildMatchStmtScope(MatchStmt &match_stmt, DeclContext *parent) {
+  Expr &scrutinee = match_stmt.getScrutinee();
+  TypeChecker{parent}.checkExpr(scrutinee);
+  Type *type = scrutinee.getType()->getCanonicalType();
+  if (!type->isIntegerType() && !type->is<CharacterType>()) {
+    std::stringstream ss;
+    ss << "can not match a value of type `" << type->toString() << "`, only integers and characters";
+    throw CompilerException(scrutinee.location(), ss.str());
+  }
+
+  std::set<uint64_t> seen;
+  for (auto &match_case: match_stmt.getCases()) {
+    match_case.constants.clear();
+    for (auto &value: match_case.values) {
+      TypeChecker{parent}.checkExpr(*value);
+      TypeChecker{parent}.convertLiteral(*value, type);
+      if (value->getType()->getCanonicalType() != type) {
+        std::stringstream ss;
+        ss << "case of type `" << value->getType()->toString() << "` does not match a value of type `";
+        ss << type->toString() << "`";
+        throw CompilerException(value->location(), ss.str());
+      }
+      // the constants are extended to 64 bits, so equal values have the same bits
+      uint64_t bits = ConstEvaluator{}.evaluate(*value).getBits();
+      if (!seen.insert(bits).second) {
+        throw CompilerException(value->location(), "duplicate case in match statement");
+      }
+      match_case.constants.push_back(bits);
+    }
+    match_case.block->setParentContext(parent);
+    buildCompoundStmtScope(*match_case.block);
+  }
+
+  if (CompoundStmt *else_block = match_stmt.getElse()) {
+    else_block->setParentContext(parent);
+    buildCompoundStmtScope(*else_block);
+    return;
+  }
+
+  IntegerType *int_type = type->as<IntegerType>();
+  int bits = int_type ? int_type->bits() : 8;
+  if (bits > 8 || seen.size() < (size_t{1} << bits)) {
+    std::stringstream ss;
+    ss << "match over `" << type->toString() << "` does not cover every value, add an else case";
+    throw CompilerException(scrutinee.location(), ss.str());
+  }
+}
+
+void ScopeBuilder::checkMapUses(TreeElement &element, TreeElement *parent) {
+  // a map is lent to the builtins and to the functions it is passed to. Any
+  // other use, such as returning, assigning or referencing it, would copy the
+  // handle of a table which is freed when the variable goes out of scope.
+  Expr *expr = dynamic_cast<Expr*>(&element);
+  if (expr && expr->getType() && expr->getType()->getCanonicalType()->is<MapType>()) {
+    FunctionCall *call = dynamic_cast<FunctionCall*>(parent);
+    bool is_map_argument = call && !call->getArguments().empty() && call->getArguments()[0].get() == expr
+      && (TypeChecker::isMapBuiltin(call->getFunctionName()) || call->getFunctionName() == StringRef{"len"});
+    bool is_function_argument = call && call->getDecl() && dynamic_cast<const FuncDecl*>(call->getDecl());
+    if (!expr->is<IdentifierExpr>() || !(is_map_argument || is_function_argument)) {
+      throw CompilerException(
+        expr->location()
+      , "a map may only be passed to the map builtins and to functions, since its table is freed when the block declaring it exits"
+      );
+    }
+  }
+
+  for (TreeElement *child: element.getChildren()) {
+    if (child) checkMapUses(*child, &element);
+  }
+}
@@ -0,0 +1,147 @@
+#include "Sema/TailCallAnalyzer.h"
+
+#include "AST/Decl.h"
+#include "AST/Stmt.h"
+#include "AST/Expr.h"
+#include "AST/Type.h"
+#include "Basic/CompilerException.h"
+
+#include <functional>
+
+// calls the visitor on the given element and all of its descendants in
+// preorder.
+static void walk(TreeElement &element, const std::function<void(TreeElement&)> &visit) {
+  visit(element);
+  for (TreeElement *child: element.getChildren()) {
+    if (child) walk(*child, visit);
+  }
+}
+
+// returns true if values of the type may refer to memory, e.g. a struct with
+// a reference member
+static bool containsPointers(Type *type) {
+  Type *canonical = type->getCanonicalType();
+  if (canonical->is<ReferenceType>() || canonical->is<SliceType>() || canonical->is<PointerType>()) {
+    return true;
+  } else if (ListType *list_type = canonical->as<ListType>()) {
+    return containsPointers(list_type->element_type());
+  } else if (TupleType *tuple_type = canonical->as<TupleType>()) {
+    for (Type *element: tuple_type->elements()) {
+      if (containsPointers(element)) return true;
+    }
+  } else if (StructType *struct_type = canonical->as<StructType>()) {
+    for (Type *element: struct_type->elements()) {
+      if (containsPointers(element)) return true;
+    }
+  }
+  return false;
+}
+
+// returns true if the declaration is made within the scope
+static bool isDeclaredIn(const Decl *decl, const DeclContext *scope) {
+  for (const DeclContext *context = decl->getDeclContext(); context; context = context->getParentContext()) {
+    if (context == scope) return true;
+  }
+  return false;
+}
+
+void TailCallAnalyzer::analyze(FuncDecl &func) {
+  function_ = &func;
+  allocator_scopes_ = 0;
+  owned_maps_ = 0;
+  analyzeElement(func.getBlockStmt());
+  if (func.getFuncAttributes().is_tailcall) checkRecursiveCalls(func.getBlockStmt());
+}
+
+void TailCallAnalyzer::analyzeElement(TreeElement &element) {
+  if (ReturnStmt *stmt = dynamic_cast<ReturnStmt*>(&element)) {
+    analyzeReturn(*stmt);
+    return;
+  }
+
+  if (UninitializedVarDecl *var_decl = dynamic_cast<UninitializedVarDecl*>(&element)) {
+    if (var_decl->getType()->getCanonicalType()->is<MapType>()) owned_maps_++;
+  }
+
+  CompoundStmt *block = dynamic_cast<CompoundStmt*>(&element);
+  bool has_allocator = block && block->getAllocator() != CompoundStmt::Allocator::Inherited;
+  unsigned outer_owned_maps = owned_maps_;
+  if (has_allocator) allocator_scopes_++;
+  for (TreeElement *child: element.getChildren()) {
+    if (child) analyzeElement(*child);
+  }
+  if (has_allocator) allocator_scopes_--;
+  if (block) owned_maps_ = outer_owned_maps;
+}
+
+void TailCallAnalyzer::analyzeReturn(ReturnStmt &stmt) {
+  FunctionCall *call = stmt.getExpr() ? stmt.getExpr()->as<FunctionCall>() : nullptr;
+  if (!call) return;
+
+  // builtins and intrinsics are not calls
+  const Decl *callee = call->getDecl();
+  if (!dynamic_cast<const FuncDecl*>(callee) && !dynamic_cast<const ExternFuncDecl*>(callee)) return;
+
+  bool is_recursive = callee == function_ && function_->getFuncAttributes().is_tailcall;
+  auto reject = [call, is_recursive](const char *reason) {
+    if (!is_recursive) return;
+    std::stringstream ss;
+    ss << "recursive call to @tailcall function " << call->getFunctionName() << " " << reason;
+    throw CompilerException(call->location(), ss.str());
+  };
+
+  if (allocator_scopes_ > 0) {
+    return reject("is not a tail call, since the allocator of the enclosing block is popped after it");
+  }
+  if (owned_maps_ > 0) {
+    return reject("is not a tail call, since the maps declared before it are freed after it");
+  }
+
+  const FunctionType *callee_type = dynamic_cast<const FunctionType*>(callee->getType()->getCanonicalType());
+  const auto &args = call->getArguments();
+  for (size_t i = 0; i < args.size(); i++) {
+    Type *param_type = i < callee_type->getParamTypes().size() ? callee_type->getParam(static_cast<int>(i)) : args[i]->getType();
+    if (mayReferToFrame(*args[i], param_type)) {
+      return reject("is not a tail call, since an argument may refer to a local variable of the caller");
+    }
+  }
+
+  call->setTailCall(
+    callee_type == function_->getType()->getCanonicalType()
+      ? FunctionCall::TailCall::Guaranteed
+      : FunctionCall::TailCall::Tail
+  );
+}
+
+// A reference, slice or pointer argument refers to memory of the caller if it
+// is taken from a local variable, or if it is an array of the caller which is
+// passed as a slice. Parameters refer to memory of the callers further up.
+bool TailCallAnalyzer::mayReferToFrame(Expr &arg, Type *param_type) {
+  if (!containsPointers(arg.getType()) && !containsPointers(param_type)) return false;
+  if (arg.getType()->getCanonicalType() != param_type->getCanonicalType()) return true;
+
+  bool refers = false;
+  DeclContext *scope = function_->getDeclContext();
+  walk(arg, [&refers, scope](TreeElement &element) {
+    if (UnaryExpr *unary = dynamic_cast<UnaryExpr*>(&element)) {
+      if (unary->getOperator() == StringRef{"&"}) refers = true;
+    } else if (IdentifierExpr *id_expr = dynamic_cast<IdentifierExpr*>(&element)) {
+      const Decl *decl = id_expr->getDecl();
+      if (decl && decl->getKind() != Decl::Kind::ParamDecl && decl->getKind() != Decl::Kind::ConstDecl
+          && isDeclaredIn(decl, scope)) {
+        refers = true;
+      }
+    }
+  });
+  return refers;
+}
+
+void TailCallAnalyzer::checkRecursiveCalls(TreeElement &element) {
+  walk(element, [this](TreeElement &child) {
+    FunctionCall *call = dynamic_cast<FunctionCall*>(&child);
+    if (!call || call->getDecl() != function_ || call->getTailCall() == FunctionCall::TailCall::Guaranteed) return;
+    std::stringstream ss;
+    ss << "recursive call to @tailcall function " << call->getFunctionName() << " is not in tail position";
+    throw CompilerException(call->location(), ss.str());
+  });
+}
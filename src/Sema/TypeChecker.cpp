@@ -12,7 +12,13 @@
 #include "AST/Expr.h"
 #include "AST/Decl.h"
 #include "AST/Type.h"
+#include "Sema/BuiltinDecl.h"
+#include "Sema/GenericInstantiator.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
 #include <typeinfo>
 
 void TypeChecker::checkExpr(Expr &expr) {
@@ -100,6 +106,12 @@ void TypeChecker::checkElementAccessor(AccessorExpr &expr) {
     expr.setType(ref_type->getReferencedType()->as<ListType>()->element_type());
   } else if (expr.identifier().isType<SliceType>()) {
     expr.setType(expr.identifier().type()->as<SliceType>()->element());
+  } else if (expr.identifier().isType<VectorType>()) {
+    VectorType *vector_type = expr.identifier().type()->as<VectorType>();
+    if (expr.hasStaticIndex() && expr.getMemberIndex() >= vector_type->size()) {
+      throw CompilerException(expr.location(), "lane index out of range for " + vector_type->toString());
+    }
+    expr.setType(vector_type->element_type());
   } else {
     std::stringstream ss;
     ss << "illegal attempt to access element of " << expr.identifier().type()->toString() << ". ";
@@ -128,25 +140,155 @@ void TypeChecker::checkAccessorExpr(AccessorExpr &expr) {
   }
 }
 
+// A slice is a (pointer, length) pair, so it can only be created implicitly
+// from a reference to an array whose length is known, e.g. `&[i64, 5]` is
+// assignable to `&[i64]`.
 bool TypeChecker::is_implicitly_assignable_to(Type *l, Type *r) {
   if (l->getCanonicalType() == r->getCanonicalType()) {
     return true;
   } else if (SliceType *slice_type = dynamic_cast<SliceType*>(l->getCanonicalType())) {
     if (ReferenceType *ref_type = dynamic_cast<ReferenceType*>(r->getCanonicalType())) {
-      if (ref_type->getReferencedType() == slice_type->element()) {
-        return true;
+      if (ListType *list_type = ref_type->getReferencedType()->getCanonicalType()->as<ListType>()) {
+        return list_type->element_type()->getCanonicalType() == slice_type->element()->getCanonicalType();
       }
     }
   }
   return false;
 }
 
+// Return true if the expression accesses a single lane of a vector
+static bool isVectorLane(const Expr &expr) {
+  if (const AccessorExpr *accessor = dynamic_cast<const AccessorExpr*>(&expr)) {
+    return accessor->identifier().getType()->getCanonicalType()->is<VectorType>();
+  } else return false;
+}
+
+// Return true if the struct is stored as a struct of arrays in arrays
+static bool isSoaStruct(Type *type) {
+  StructType *struct_type = type->getCanonicalType()->as<StructType>();
+  return struct_type && struct_type->getLayout().is_soa;
+}
+
+// Return true if the expression accesses an element of an array of @soa
+// structs, whose fields are not stored next to each other
+static bool isSoaElement(const Expr &expr) {
+  if (const AccessorExpr *accessor = dynamic_cast<const AccessorExpr*>(&expr)) {
+    Type *aggregate_type = accessor->identifier().getType()->getCanonicalType();
+    if (ReferenceType *ref_type = aggregate_type->as<ReferenceType>()) {
+      aggregate_type = ref_type->getReferencedType()->getCanonicalType();
+    }
+    ListType *list_type = aggregate_type->as<ListType>();
+    return list_type && isSoaStruct(list_type->element_type());
+  } else return false;
+}
+
+// Return true if the name is declared by the program in the context or any of
+// its parents. Builtins which are checked structurally may be shadowed by a
+// declaration with the same name.
+static bool isDeclared(DeclContext *context, StringRef name) {
+  for (; context; context = context->getParentContext()) {
+    if (context->getDeclMap().count(name)) return true;
+  }
+  return false;
+}
+
+// Return the type of the function declared as name in the innermost context
+// which declares name, or nullptr if that context declares several functions
+// of the name or the name is not a function.
+static const FunctionType* getUniqueFunctionType(DeclContext *context, StringRef name) {
+  for (; context; context = context->getParentContext()) {
+    auto candidates = context->getDeclMap().equal_range(name);
+    if (candidates.first == candidates.second) continue;
+    if (std::next(candidates.first) != candidates.second) return nullptr;
+    return dynamic_cast<const FunctionType*>(candidates.first->second->getType()->getCanonicalType());
+  }
+  return nullptr;
+}
+
+// Return the generic function declared as name in the innermost context which
+// declares name, or nullptr if name is not a generic function. A generic
+// function can not be overloaded, since the overload would be ambiguous for
+// some of its type arguments.
+static FuncDecl* getGenericFunction(DeclContext *context, StringRef name) {
+  for (; context; context = context->getParentContext()) {
+    auto candidates = context->getDeclMap().equal_range(name);
+    if (candidates.first == candidates.second) continue;
+    for (auto it = candidates.first; it != candidates.second; ++it) {
+      FuncDecl *func_decl = dynamic_cast<FuncDecl*>(it->second);
+      if (!func_decl || !func_decl->isGeneric()) continue;
+      if (std::next(candidates.first) != candidates.second) {
+        throw CompilerException(name.start, "the generic function " + name.str() + " can not be overloaded");
+      }
+      return func_decl;
+    }
+    return nullptr;
+  }
+  return nullptr;
+}
+
+// Return the declaration whose storage is written when assigning to expr, or
+// nullptr if the write goes through a reference. e.g. `a.b[0] = x` writes to
+// the storage of `a`, while `r.b = x` with `r: &T` writes through `r`.
+static const Decl* getAssignedDecl(const Expr &expr) {
+  if (const AccessorExpr *accessor = dynamic_cast<const AccessorExpr*>(&expr)) {
+    const Expr &aggregate = accessor->identifier();
+    if (aggregate.getType()->getCanonicalType()->is<ReferenceType>()) return nullptr;
+    if (aggregate.getType()->getCanonicalType()->is<SliceType>()) return nullptr;
+    return getAssignedDecl(aggregate);
+  } else if (const IdentifierExpr *id_expr = dynamic_cast<const IdentifierExpr*>(&expr)) {
+    return id_expr->getDecl();
+  } else return nullptr;
+}
+
+// Marks a let binding whose storage is referenced by expr, so that codegen
+// gives it storage of its own. The declaration is looked up in the enclosing
+// contexts, since identifiers only hold a const pointer to it.
+static void markReferenced(DeclContext *context, const Expr &expr) {
+  const Decl* decl = getAssignedDecl(expr);
+  if (!decl || !decl->is<const LetDecl>()) return;
+  for (; context; context = context->getParentContext()) {
+    auto candidates = context->getDeclMap().equal_range(decl->getName());
+    for (auto it = candidates.first; it != candidates.second; ++it) {
+      if (it->second == decl) {
+        static_cast<LetDecl*>(it->second)->setReferenced(true);
+        return;
+      }
+    }
+  }
+}
+
 void TypeChecker::checkAssignmentExpr(BinaryExpr &expr) {
 
+  // let bindings are immutable, which allows codegen to place constant
+  // initializers in read-only memory. Loop variables are immutable so that
+  // the trip count of a for loop is known when it is entered. Constants are
+  // computed at compile time.
+  const Decl* assigned_decl = getAssignedDecl(expr.getLeft());
+  if (assigned_decl && (assigned_decl->is<const LetDecl>() || assigned_decl->is<const LoopVarDecl>()
+      || assigned_decl->is<const ConstDecl>())) {
+    std::stringstream ss;
+    ss << "unable to assign to immutable binding '" << assigned_decl->getName() << "'";
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  // the lanes of a vector live in a register rather than in memory, so a
+  // new vector must be built with select or shuffle instead
+  if (isVectorLane(expr.getLeft())) {
+    throw CompilerException(expr.location(), "unable to assign to a lane of a vector. use select or shuffle to build a new vector");
+  }
+
   if (expr.getLeft().isLeftValue()) {
+    convertLiteral(expr.getRight(), expr.getLeft().getType()->getCanonicalType());
     Type* ltype = expr.getLeft().getType()->getCanonicalType();
     Type* rtype = expr.getRight().getType()->getCanonicalType();
-    expr.setType(expr.getRight().getType()->getCanonicalType());
+
+    // a compound assignment stores the result of its operator, which must be
+    // of the type of the assigned location. e.g. `a <<= 2` with `a: u32`
+    if (expr.isCompoundAssignment()) {
+      rtype = resolveBinaryOperator(expr.getCompoundOperator(), ltype, rtype);
+    }
+
+    expr.setType(rtype);
     if (ltype != rtype) {
       std::stringstream ss;
       ss <<  "mismatched type for assignment operands " << ltype->toString();
@@ -165,20 +307,43 @@ void TypeChecker::checkBinaryExpr(BinaryExpr &expr) {
   checkExpr(expr.getRight());
 
   // special members
-  if (expr.getOperator() == StringRef{"="}) {
+  if (expr.isAssignment()) {
     return checkAssignmentExpr(expr);
   }
 
+  // a literal operand takes the type of the other operand, e.g. in `x + 1`
+  // with `x: u8`
+  if (!convertLiteral(expr.getLeft(), expr.getRight().type()->getCanonicalType())) {
+    convertLiteral(expr.getRight(), expr.getLeft().type()->getCanonicalType());
+  }
+
+  expr.setType(resolveBinaryOperator(
+    expr.getOperator()
+  , expr.getLeft().type()->getCanonicalType()
+  , expr.getRight().type()->getCanonicalType()
+  ));
+}
+
+Type* TypeChecker::resolveBinaryOperator(StringRef op, Type *left_type, Type *right_type) {
+  // operators on two vectors of the same type apply to each pair of lanes, so
+  // they are resolved with the operator of the lane type. e.g. comparing two
+  // `vec[f64, 4]` results in a `vec[bool, 4]` mask.
+  VectorType *vector_type = left_type == right_type ? left_type->as<VectorType>() : nullptr;
+  if (vector_type) {
+    left_type = right_type = vector_type->element_type();
+  }
+
   FunctionSignature binary_op_signature {
-    expr.getOperator(), {
-      expr.getLeft().type()->getCanonicalType(),
-      expr.getRight().type()->getCanonicalType()
-    }
+    op, {left_type, right_type}
   };
 
   Decl *decl = currentContext->getDecl(binary_op_signature);
   FunctionType *func_type = static_cast<FunctionType*>(decl->canonical_type());
-  expr.setType(func_type->getReturnType()->getCanonicalType());
+  Type *result_type = func_type->getReturnType()->getCanonicalType();
+  if (vector_type) {
+    result_type = VectorType::getInstance(result_type, vector_type->size());
+  }
+  return result_type;
 }
 
 void TypeChecker::checkBoolExpr(BoolExpr &expr) {
@@ -208,11 +373,60 @@ void TypeChecker::checkDoubleExpr(DoubleExpr &expr) {
 
 
 void TypeChecker::checkFunctionCall(FunctionCall &expr) {
+  // the ordering of an atomic builtin is a name rather than an expression, so
+  // the builtin checks its own arguments
+  if (isAtomicBuiltin(expr.getFunctionName()) && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkAtomicBuiltin(expr);
+  }
+
   // must check the type of all sub-expressions first
   for(auto &arg: expr.getArguments()) {
     checkExpr(*arg);
   }
 
+  // 'len' is generic over the element type, so it can not be expressed as a
+  // single builtin declaration and is checked structurally instead.
+  if (expr.getFunctionName() == StringRef{"len"} && expr.getArguments().size() == 1
+      && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkLenCall(expr);
+  }
+
+  if (isVectorBuiltin(expr.getFunctionName()) && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkVectorBuiltin(expr);
+  }
+
+  if (isMapBuiltin(expr.getFunctionName()) && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkMapBuiltin(expr);
+  }
+
+  if (isAllocationBuiltin(expr.getFunctionName()) && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkAllocationBuiltin(expr);
+  }
+
+  if (Type::getBuiltinType(expr.getFunctionName()) && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkConversionCall(expr);
+  }
+
+  if (expr.getFunctionName() == StringRef{"prefetch"} && !isDeclared(currentContext, expr.getFunctionName())) {
+    return checkPrefetchCall(expr);
+  }
+
+  if (FuncDecl *generic = getGenericFunction(currentContext, expr.getFunctionName())) {
+    return checkGenericCall(expr, *generic);
+  }
+
+  if (BuiltinDecl::isIntrinsic(expr.getFunctionName())) {
+    return checkIntrinsicCall(expr);
+  }
+
+  // literal arguments take the parameter types of a function which is not
+  // overloaded
+  if (const FunctionType *func_type = getUniqueFunctionType(currentContext, expr.getFunctionName())) {
+    for (size_t i = 0; i < expr.getArguments().size() && i < func_type->getParamTypes().size(); i++) {
+      convertLiteral(*expr.getArguments()[i], func_type->getParam(i)->getCanonicalType());
+    }
+  }
+
   std::vector<Type*> param_types;
 
   for(auto &arg: expr.getArguments()) {
@@ -221,9 +435,592 @@ void TypeChecker::checkFunctionCall(FunctionCall &expr) {
 
   Decl *decl = currentContext->getDecl({expr.getFunctionName(), param_types});
   FunctionType *func_type = static_cast<FunctionType*>(decl->canonical_type());
+  expr.setDecl(decl);
+  expr.setType(func_type->getReturnType()->getCanonicalType());
+}
+
+// len(x) returns the number of elements of a slice, an array, or a reference
+// to an array, or the number of keys of a map. The length of an array is known
+// statically, while the length of a slice is stored alongside its data pointer.
+void TypeChecker::checkLenCall(FunctionCall &expr) {
+  Expr &arg = *expr.getArguments()[0];
+  if (arg.isType<SliceType>() || arg.isType<ListType>() || arg.isReferenceTo<ListType>() || arg.isType<MapType>()) {
+    expr.setType(IntegerType::getInstance());
+  } else {
+    std::stringstream ss;
+    ss << "len expects a slice, an array or a map but got " << arg.getType()->toString();
+    throw CompilerException(expr.location(), ss.str());
+  }
+}
+
+bool TypeChecker::isVectorBuiltin(StringRef name) {
+  static const std::array<const char*, 11> builtins{{
+    "splat", "shuffle", "select", "load", "store"
+  , "reduce_add", "reduce_mul", "reduce_min", "reduce_max", "reduce_and", "reduce_or"
+  }};
+  return std::any_of(builtins.begin(), builtins.end(), [&name](const char *builtin) {
+    return name == StringRef{builtin};
+  });
+}
+
+// returns the vector type of the argument, or throws if it is not a vector
+static VectorType* expectVector(const FunctionCall &call, const Expr &arg) {
+  if (VectorType *vector_type = arg.getType()->getCanonicalType()->as<VectorType>()) {
+    return vector_type;
+  }
+  std::stringstream ss;
+  ss << call.getFunctionName() << " expects a vector but got " << arg.getType()->toString();
+  throw CompilerException(call.location(), ss.str());
+}
+
+// returns the value of an integer literal argument, such as a lane count or a
+// shuffle mask index, which must be known at compile time
+static int expectLaneLiteral(const FunctionCall &call, const Expr &arg) {
+  if (const IntegerExpr *int_expr = dynamic_cast<const IntegerExpr*>(&arg)) {
+    if (int_expr->getInt() >= 0) return int_expr->getInt();
+  }
+  std::stringstream ss;
+  ss << call.getFunctionName() << " expects a non-negative integer literal";
+  throw CompilerException(arg.location(), ss.str());
+}
+
+// returns the element type of a sequence argument of load or store, which must
+// be stored in memory and have scalar elements other than bool
+static Type* expectScalarSequence(const FunctionCall &call, const Expr &arg, bool is_write) {
+  Type *type = arg.getType()->getCanonicalType();
+  Type *element_type = nullptr;
+  if (SliceType *slice_type = type->as<SliceType>()) {
+    element_type = slice_type->element();
+  } else if (arg.isReferenceTo<ListType>()) {
+    element_type = type->as<ReferenceType>()->getReferencedType()->getCanonicalType()->as<ListType>()->element_type();
+  } else if (!is_write && type->is<ListType>()) {
+    element_type = type->as<ListType>()->element_type();
+  }
+  element_type = element_type ? element_type->getCanonicalType() : nullptr;
+  if (!element_type || !(element_type->isIntegerType() || element_type->isDoubleType() || element_type->is<CharacterType>())) {
+    std::stringstream ss;
+    ss << call.getFunctionName() << " expects " << (is_write ? "a slice or a reference to an array" : "a slice or an array");
+    ss << " of integers, doubles or characters but got " << arg.getType()->toString();
+    throw CompilerException(call.location(), ss.str());
+  }
+  return element_type;
+}
+
+// The vector builtins are generic over the lane type and count, so they are
+// checked structurally like len.
+//
+//   splat(x, n)          a vector with n lanes which are all x
+//   shuffle(a, b, mask)  lanes of a and b selected by an array literal of indices
+//   shuffle(a, mask)     lanes of a selected by an array literal of indices
+//   select(m, a, b)      lanes of a where the mask m is true, otherwise of b
+//   reduce_<op>(v)       the lanes of v combined with +, *, min, max, & or |
+//   load(s, i, n)        the n elements of s starting at index i
+//   store(s, i, v)       writes the lanes of v to s starting at index i
+void TypeChecker::checkVectorBuiltin(FunctionCall &expr) {
+  const auto &args = expr.getArguments();
+  StringRef name = expr.getFunctionName();
+  auto expectArgCount = [&expr, &args, &name](size_t count) {
+    if (args.size() != count) {
+      std::stringstream ss;
+      ss << name << " expects " << count << " arguments but got " << args.size();
+      throw CompilerException(expr.location(), ss.str());
+    }
+  };
+
+  if (name == StringRef{"splat"}) {
+    expectArgCount(2);
+    Type *lane_type = args[0]->getType()->getCanonicalType();
+    int size = expectLaneLiteral(expr, *args[1]);
+    if (size == 0 || !(lane_type->isIntegerType() || lane_type->isDoubleType()
+    || lane_type->isBooleanType() || lane_type->is<CharacterType>())) {
+      throw CompilerException(expr.location(), "splat expects a scalar and a positive lane count");
+    }
+    expr.setType(VectorType::getInstance(lane_type, size));
+  } else if (name == StringRef{"shuffle"}) {
+    if (args.size() != 2 && args.size() != 3) expectArgCount(3);
+    VectorType *vector_type = expectVector(expr, *args[0]);
+    if (args.size() == 3 && args[1]->getType()->getCanonicalType() != vector_type) {
+      throw CompilerException(expr.location(), "shuffle expects two vectors of the same type");
+    }
+    const ListExpr *mask = dynamic_cast<const ListExpr*>(args.back().get());
+    if (!mask) {
+      throw CompilerException(expr.location(), "shuffle expects an array literal of lane indices");
+    }
+    int lane_count = vector_type->size() * (args.size() - 1);
+    for (auto &index: mask->elements()) {
+      if (expectLaneLiteral(expr, *index) >= lane_count) {
+        throw CompilerException(index->location(), "shuffle lane index out of range");
+      }
+    }
+    expr.setType(VectorType::getInstance(vector_type->element_type(), mask->elements().size()));
+  } else if (name == StringRef{"select"}) {
+    expectArgCount(3);
+    VectorType *mask_type = expectVector(expr, *args[0]);
+    VectorType *vector_type = expectVector(expr, *args[1]);
+    if (!mask_type->element_type()->isBooleanType() || mask_type->size() != vector_type->size()
+    || args[2]->getType()->getCanonicalType() != vector_type) {
+      throw CompilerException(expr.location(), "select expects a mask of bools and two vectors with the same number of lanes");
+    }
+    expr.setType(vector_type);
+  } else if (name == StringRef{"load"}) {
+    expectArgCount(3);
+    Type *element_type = expectScalarSequence(expr, *args[0], false);
+    if (!args[1]->getType()->getCanonicalType()->isIntegerType()) {
+      throw CompilerException(args[1]->location(), "load expects an integer index");
+    }
+    int size = expectLaneLiteral(expr, *args[2]);
+    if (size == 0) throw CompilerException(args[2]->location(), "load expects a positive lane count");
+    expr.setType(VectorType::getInstance(element_type, size));
+  } else if (name == StringRef{"store"}) {
+    expectArgCount(3);
+    Type *element_type = expectScalarSequence(expr, *args[0], true);
+    if (!args[1]->getType()->getCanonicalType()->isIntegerType()) {
+      throw CompilerException(args[1]->location(), "store expects an integer index");
+    }
+    VectorType *vector_type = expectVector(expr, *args[2]);
+    if (vector_type->element_type() != element_type) {
+      throw CompilerException(expr.location(), "store expects a vector with lanes of the element type");
+    }
+    expr.setType(vector_type);
+  } else {
+    // reductions
+    expectArgCount(1);
+    VectorType *vector_type = expectVector(expr, *args[0]);
+    Type *lane_type = vector_type->element_type();
+    bool is_bitwise = name == StringRef{"reduce_and"} || name == StringRef{"reduce_or"};
+    bool is_valid = is_bitwise
+      ? lane_type->isIntegerType() || lane_type->isBooleanType()
+      : lane_type->isIntegerType() || lane_type->isDoubleType();
+    if (!is_valid) {
+      std::stringstream ss;
+      ss << name << " is not defined for lanes of type " << lane_type->toString();
+      throw CompilerException(expr.location(), ss.str());
+    }
+    expr.setType(lane_type);
+  }
+}
+
+bool TypeChecker::isMapBuiltin(StringRef name) {
+  return name == StringRef{"insert"} || name == StringRef{"find"}
+    || name == StringRef{"contains"} || name == StringRef{"erase"};
+}
+
+// The map builtins are generic over the key and value types of the map, so
+// they are checked structurally like len.
+//
+//   insert(m, k, v)  sets the value of the key k to v
+//   find(m, k)       the value of k, which is zero if k is not in m
+//   contains(m, k)   whether k is in m
+//   erase(m, k)      removes k and returns whether it was in m
+void TypeChecker::checkMapBuiltin(FunctionCall &expr) {
+  const auto &args = expr.getArguments();
+  StringRef name = expr.getFunctionName();
+  size_t count = name == StringRef{"insert"} ? 3 : 2;
+  if (args.size() != count) {
+    std::stringstream ss;
+    ss << name << " expects " << count << " arguments but got " << args.size();
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  MapType *map_type = args[0]->getType()->getCanonicalType()->as<MapType>();
+  if (!map_type) {
+    std::stringstream ss;
+    ss << name << " expects a map but got " << args[0]->getType()->toString();
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  Type *key_type = map_type->getKeyType()->getCanonicalType();
+  convertLiteral(*args[1], key_type);
+  if (args[1]->getType()->getCanonicalType() != key_type) {
+    std::stringstream ss;
+    ss << name << " expects a key of type `" << key_type->toString() << "` but got `";
+    ss << args[1]->getType()->toString() << "`";
+    throw CompilerException(args[1]->location(), ss.str());
+  }
+
+  Type *value_type = map_type->getValueType()->getCanonicalType();
+  if (name == StringRef{"insert"}) {
+    convertLiteral(*args[2], value_type);
+    if (!is_implicitly_assignable_to(value_type, args[2]->getType())) {
+      std::stringstream ss;
+      ss << "insert expects a value of type `" << value_type->toString() << "` but got `";
+      ss << args[2]->getType()->toString() << "`";
+      throw CompilerException(args[2]->location(), ss.str());
+    }
+    expr.setType(TupleType::getInstance({}));
+  } else if (name == StringRef{"find"}) {
+    expr.setType(value_type);
+  } else {
+    expr.setType(BooleanType::getInstance());
+  }
+}
+
+bool TypeChecker::isAllocationBuiltin(StringRef name) {
+  return name == StringRef{"new"} || name == StringRef{"alloc"} || name == StringRef{"free"};
+}
+
+// The allocation builtins are generic over the allocated type, which is the
+// type of the initial value, so they are checked structurally like len.
+//
+//   new(v)       a reference to a copy of v on the heap
+//   alloc(v, n)  a slice of n copies of v on the heap
+//   free(x)      frees the memory of a reference or slice returned by new
+//                or alloc
+void TypeChecker::checkAllocationBuiltin(FunctionCall &expr) {
+  const auto &args = expr.getArguments();
+  StringRef name = expr.getFunctionName();
+  size_t count = name == StringRef{"alloc"} ? 2 : 1;
+  if (args.size() != count) {
+    std::stringstream ss;
+    ss << name << " expects " << count << " arguments but got " << args.size();
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  if (name == StringRef{"new"}) {
+    expr.setType(ReferenceType::getInstance(args[0]->getType()->getCanonicalType()));
+  } else if (name == StringRef{"alloc"}) {
+    convertLiteral(*args[1], IntegerType::getInstance());
+    if (!args[1]->getType()->getCanonicalType()->isIntegerType()) {
+      throw CompilerException(args[1]->location(), "alloc expects an integer count");
+    }
+    if (isSoaStruct(args[0]->getType())) {
+      throw CompilerException(expr.location(), "slices of @soa structs are not supported");
+    }
+    expr.setType(SliceType::getInstance(args[0]->getType()->getCanonicalType()));
+  } else {
+    if (!args[0]->isType<ReferenceType>() && !args[0]->isType<SliceType>()) {
+      std::stringstream ss;
+      ss << "free expects a reference or a slice but got " << args[0]->getType()->toString();
+      throw CompilerException(expr.location(), ss.str());
+    }
+    expr.setType(TupleType::getInstance({}));
+  }
+}
+
+bool TypeChecker::isAtomicBuiltin(StringRef name) {
+  return name == StringRef{"atomic_load"} || name == StringRef{"atomic_store"}
+    || name == StringRef{"atomic_swap"} || name == StringRef{"compare_swap"}
+    || name == StringRef{"fetch_add"} || name == StringRef{"fetch_sub"}
+    || name == StringRef{"fetch_and"} || name == StringRef{"fetch_or"} || name == StringRef{"fetch_xor"}
+    || name == StringRef{"fetch_min"} || name == StringRef{"fetch_max"} || name == StringRef{"fence"};
+}
+
+// The atomic builtins take a reference to an atomic, and are generic over the
+// type of its value. Each takes an optional ordering as its last argument,
+// which is seq_cst if it is left out.
+//
+//   atomic_load(r)             the value of r
+//   atomic_store(r, v)         sets r to v
+//   atomic_swap(r, v)          sets r to v and returns its previous value
+//   compare_swap(r, e, v)      sets r to v if it is e, and returns its
+//                              previous value
+//   fetch_add(r, v)            adds v to r and returns its previous value,
+//                              as do fetch_sub, _and, _or, _xor, _min, _max
+//   fence()                    orders the accesses before and after it
+void TypeChecker::checkAtomicBuiltin(FunctionCall &expr) {
+  const auto &args = expr.getArguments();
+  StringRef name = expr.getFunctionName();
+  size_t count = 2;
+  if (name == StringRef{"fence"}) count = 0;
+  else if (name == StringRef{"atomic_load"}) count = 1;
+  else if (name == StringRef{"compare_swap"}) count = 3;
+  if (args.size() != count && args.size() != count + 1) {
+    std::stringstream ss;
+    ss << name << " expects " << count << " arguments and an optional ordering but got " << args.size();
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  // the ordering is not a declaration, so it is left without one. It has the
+  // unit type, so that it can not be used as a value.
+  if (args.size() == count + 1) {
+    IdentifierExpr *order_expr = args.back()->as<IdentifierExpr>();
+    AtomicType::Order order;
+    if (!order_expr || !AtomicType::getOrder(order_expr->lexeme(), order)) {
+      std::stringstream ss;
+      ss << name << " expects an ordering, i.e. relaxed, acquire, release, acq_rel or seq_cst";
+      throw CompilerException(args.back()->location(), ss.str());
+    }
+    bool is_invalid = false;
+    if (name == StringRef{"atomic_load"}) {
+      is_invalid = order == AtomicType::Order::Release || order == AtomicType::Order::AcquireRelease;
+    } else if (name == StringRef{"atomic_store"}) {
+      is_invalid = order == AtomicType::Order::Acquire || order == AtomicType::Order::AcquireRelease;
+    } else if (name == StringRef{"fence"}) {
+      is_invalid = order == AtomicType::Order::Relaxed;
+    }
+    if (is_invalid) {
+      std::stringstream ss;
+      ss << name << " can not be " << order_expr->lexeme();
+      throw CompilerException(order_expr->location(), ss.str());
+    }
+    order_expr->setType(TupleType::getInstance({}));
+  }
+
+  if (name == StringRef{"fence"}) {
+    expr.setType(TupleType::getInstance({}));
+    return;
+  }
+
+  Expr &atomic = *args[0];
+  checkExpr(atomic);
+  ReferenceType *ref_type = atomic.getType()->getCanonicalType()->as<ReferenceType>();
+  AtomicType *atomic_type = ref_type ? ref_type->getReferencedType()->getCanonicalType()->as<AtomicType>() : nullptr;
+  if (!atomic_type) {
+    std::stringstream ss;
+    ss << name << " expects a reference to an atomic but got " << atomic.getType()->toString();
+    throw CompilerException(atomic.location(), ss.str());
+  }
+
+  Type *value_type = atomic_type->getValueType()->getCanonicalType();
+  for (size_t i = 1; i < count; i++) {
+    checkExpr(*args[i]);
+    convertLiteral(*args[i], value_type);
+    if (args[i]->getType()->getCanonicalType() != value_type) {
+      std::stringstream ss;
+      ss << name << " expects a value of type `" << value_type->toString() << "` but got `";
+      ss << args[i]->getType()->toString() << "`";
+      throw CompilerException(args[i]->location(), ss.str());
+    }
+  }
+
+  if (name == StringRef{"atomic_store"}) expr.setType(TupleType::getInstance({}));
+  else expr.setType(value_type);
+}
+
+// Return true if values of the type are integers or floating point numbers
+static bool isNumeric(const Type *type) {
+  return type->isIntegerType() || type->isDoubleType();
+}
+
+// Integer conversions truncate or extend according to the signedness of the
+// source, and floating point values are rounded towards zero when converted to
+// an integer.
+void TypeChecker::checkConversionCall(FunctionCall &expr) {
+  Type *target_type = Type::getBuiltinType(expr.getFunctionName());
+  if (expr.getArguments().size() != 1) {
+    std::stringstream ss;
+    ss << "conversion to " << target_type->toString() << " expects a single argument";
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  Expr &arg = *expr.getArguments()[0];
+  convertLiteral(arg, target_type);
+  if (!isNumeric(target_type) || !isNumeric(arg.getType())) {
+    std::stringstream ss;
+    ss << "unable to convert " << arg.getType()->toString() << " to " << target_type->toString();
+    ss << ". conversions are only defined between integer and floating point types";
+    throw CompilerException(expr.location(), ss.str());
+  }
+  expr.setType(target_type);
+}
+
+// prefetch(r) hints that the memory referenced by r is read soon. It does not
+// change the behaviour of the program.
+void TypeChecker::checkPrefetchCall(FunctionCall &expr) {
+  if (expr.getArguments().size() != 1 || !expr.getArguments()[0]->isType<ReferenceType>()) {
+    throw CompilerException(expr.location(), "prefetch expects a single reference");
+  }
+  expr.setType(TupleType::getInstance({}));
+}
+
+// returns true if the expression is a possibly negated number literal
+static bool isLiteral(Expr &expr) {
+  Expr *literal = &expr;
+  if (UnaryExpr *unary_expr = expr.as<UnaryExpr>()) {
+    if (unary_expr->getOperator() != StringRef{"-"}) return false;
+    literal = &unary_expr->getExpr();
+  }
+  return literal->is<IntegerExpr>() || literal->is<DoubleExpr>();
+}
+
+void TypeChecker::checkIntrinsicCall(FunctionCall &expr) {
+  auto &args = expr.getArguments();
+
+  // the intrinsics are overloaded for all types they apply to, so literal
+  // arguments take the type of the other arguments, e.g. in `min(x, 0)`
+  auto typed_arg = std::find_if(args.begin(), args.end(), [](const std::unique_ptr<Expr> &arg) {
+    return !isLiteral(*arg);
+  });
+  if (typed_arg != args.end()) {
+    Type *type = (*typed_arg)->getType()->getCanonicalType();
+    for (auto &arg: args) convertLiteral(*arg, type);
+  }
+
+  std::vector<Type*> param_types;
+  for (auto &arg: args) {
+    param_types.push_back(arg->getType()->getCanonicalType());
+  }
+
+  // intrinsics on vectors apply to each lane, except for the hints 'assume'
+  // and 'expect' which take a single condition
+  VectorType *vector_type = param_types.empty() ? nullptr : param_types[0]->as<VectorType>();
+  bool is_lane_wise = vector_type
+    && expr.getFunctionName() != StringRef{"assume"} && expr.getFunctionName() != StringRef{"expect"}
+    && std::all_of(param_types.begin(), param_types.end(), [&param_types](Type *type) {
+         return type == param_types[0];
+       });
+  if (is_lane_wise) {
+    std::fill(param_types.begin(), param_types.end(), vector_type->element_type());
+  }
+
+  Decl *decl = currentContext->getDecl({expr.getFunctionName(), param_types});
+  if (is_lane_wise && !decl->is<const BasicDecl>()) {
+    std::stringstream ss;
+    ss << expr.getFunctionName() << " does not apply to the lanes of " << vector_type->toString();
+    throw CompilerException(expr.location(), ss.str());
+  }
+  FunctionType *func_type = static_cast<FunctionType*>(decl->canonical_type());
+  Type *result_type = func_type->getReturnType()->getCanonicalType();
+  if (is_lane_wise) {
+    result_type = VectorType::getInstance(result_type, vector_type->size());
+  }
+  expr.setDecl(decl);
+  expr.setType(result_type);
+}
+
+void TypeChecker::checkGenericCall(FunctionCall &expr, FuncDecl &generic) {
+  auto &args = expr.getArguments();
+  auto &params = generic.getParams();
+  if (args.size() != params.size()) {
+    std::stringstream ss;
+    ss << generic.getName() << " expects " << params.size() << " arguments but got " << args.size();
+    throw CompilerException(expr.location(), ss.str());
+  }
+
+  std::map<std::string, Type*> bindings;
+  for (const Token &type_param: generic.getTypeParams()) {
+    bindings[type_param.lexeme().str()] = nullptr;
+  }
+
+  // literal arguments take the types inferred from the other arguments, e.g.
+  // in `larger(x, 0)`, and otherwise their default type
+  for (size_t i = 0; i < args.size(); i++) {
+    if (!isLiteral(*args[i])) inferTypeArgs(params[i]->getType(), args[i]->getType()->getCanonicalType(), bindings);
+  }
+  for (size_t i = 0; i < args.size(); i++) {
+    if (isLiteral(*args[i])) inferTypeArgs(params[i]->getType(), args[i]->getType()->getCanonicalType(), bindings);
+  }
+
+  std::vector<Type*> type_args;
+  for (const Token &type_param: generic.getTypeParams()) {
+    Type *type_arg = bindings[type_param.lexeme().str()];
+    if (!type_arg) {
+      std::stringstream ss;
+      ss << "unable to infer type parameter " << type_param.lexeme() << " of " << generic.getName();
+      throw CompilerException(expr.location(), ss.str());
+    }
+    type_args.push_back(type_arg);
+  }
+
+  FuncDecl &instance = GenericInstantiator{}.instantiate(generic, type_args);
+  FunctionType *func_type = static_cast<FunctionType*>(instance.canonical_type());
+  for (size_t i = 0; i < args.size(); i++) {
+    Type *param_type = func_type->getParam(i)->getCanonicalType();
+    convertLiteral(*args[i], param_type);
+    if (!is_implicitly_assignable_to(param_type, args[i]->getType())) {
+      std::stringstream ss;
+      ss << instance.getSymbolName() << " expects `" << param_type->toString() << "` as argument ";
+      ss << i + 1 << " but got `" << args[i]->getType()->toString() << "`";
+      throw CompilerException(args[i]->location(), ss.str());
+    }
+  }
+  expr.setDecl(&instance);
   expr.setType(func_type->getReturnType()->getCanonicalType());
 }
 
+void TypeChecker::inferTypeArgs(Type *param_type, Type *arg_type, std::map<std::string, Type*> &bindings) {
+  if (TypeIdentifier *type_id = param_type->as<TypeIdentifier>()) {
+    auto binding = bindings.find(type_id->name());
+    if (binding != bindings.end() && type_id->getTypeArgs().empty()) {
+      if (!binding->second) binding->second = arg_type;
+      return;
+    }
+
+    // the type arguments of a generic struct are those of its instance
+    const std::string &name = type_id->name();
+    StructDecl *struct_decl = dynamic_cast<StructDecl*>(
+      currentContext->getDecl(StringRef{name.data(), static_cast<int>(name.length())})
+    );
+    if (!struct_decl || !struct_decl->isGeneric()) return;
+    for (auto &instance: struct_decl->getInstances()) {
+      if (instance->getType() != arg_type) continue;
+      for (size_t i = 0; i < type_id->getTypeArgs().size() && i < instance->getTypeArgs().size(); i++) {
+        inferTypeArgs(type_id->getTypeArgs()[i], instance->getTypeArgs()[i], bindings);
+      }
+    }
+  } else if (ReferenceType *ref_type = param_type->as<ReferenceType>()) {
+    if (ReferenceType *arg_ref = arg_type->as<ReferenceType>()) {
+      inferTypeArgs(ref_type->getReferencedType(), arg_ref->getReferencedType()->getCanonicalType(), bindings);
+    }
+  } else if (PointerType *ptr_type = param_type->as<PointerType>()) {
+    if (PointerType *arg_ptr = arg_type->as<PointerType>()) {
+      inferTypeArgs(ptr_type->getReferencedType(), arg_ptr->getReferencedType()->getCanonicalType(), bindings);
+    }
+  } else if (SliceType *slice_type = param_type->as<SliceType>()) {
+    // slices are also passed as a reference to an array
+    if (SliceType *arg_slice = arg_type->as<SliceType>()) {
+      inferTypeArgs(slice_type->element(), arg_slice->element()->getCanonicalType(), bindings);
+    } else if (ReferenceType *arg_ref = arg_type->as<ReferenceType>()) {
+      if (ListType *list_type = arg_ref->getReferencedType()->getCanonicalType()->as<ListType>()) {
+        inferTypeArgs(slice_type->element(), list_type->element_type()->getCanonicalType(), bindings);
+      }
+    }
+  } else if (ListType *list_type = param_type->as<ListType>()) {
+    if (ListType *arg_list = arg_type->as<ListType>()) {
+      inferTypeArgs(list_type->element_type(), arg_list->element_type()->getCanonicalType(), bindings);
+    }
+  } else if (VectorType *vector_type = param_type->as<VectorType>()) {
+    if (VectorType *arg_vector = arg_type->as<VectorType>()) {
+      inferTypeArgs(vector_type->element_type(), arg_vector->element_type()->getCanonicalType(), bindings);
+    }
+  } else if (TupleType *tuple_type = param_type->as<TupleType>()) {
+    TupleType *arg_tuple = arg_type->as<TupleType>();
+    if (arg_tuple && arg_tuple->elements().size() == tuple_type->elements().size()) {
+      for (size_t i = 0; i < tuple_type->elements().size(); i++) {
+        inferTypeArgs(tuple_type->elements()[i], arg_tuple->elements()[i]->getCanonicalType(), bindings);
+      }
+    }
+  }
+}
+
+bool TypeChecker::convertLiteral(Expr &expr, Type *type) {
+  // a negated literal is converted as a whole, so that e.g. -128 fits an i8
+  Expr *literal = &expr;
+  bool is_negated = false;
+  if (UnaryExpr *unary_expr = expr.as<UnaryExpr>()) {
+    if (unary_expr->getOperator() != StringRef{"-"}) return false;
+    literal = &unary_expr->getExpr();
+    is_negated = true;
+  }
+  if (literal->getType() == type) return false;
+
+  if (IntegerExpr *int_expr = literal->as<IntegerExpr>()) {
+    IntegerType *int_type = type->as<IntegerType>();
+    if (!int_type) return false;
+
+    int64_t value = is_negated ? -int_expr->getInt() : int_expr->getInt();
+    int64_t min = 0;
+    int64_t max = INT64_MAX;
+    if (int_type->isSigned()) {
+      min = int_type->bits() == 64 ? INT64_MIN : -(int64_t{1} << (int_type->bits() - 1));
+      max = int_type->bits() == 64 ? INT64_MAX : (int64_t{1} << (int_type->bits() - 1)) - 1;
+    } else if (int_type->bits() < 64) {
+      max = (int64_t{1} << int_type->bits()) - 1;
+    }
+    if (value < min || value > max || (is_negated && !int_type->isSigned())) {
+      std::stringstream ss;
+      ss << "integer literal " << value << " does not fit in " << int_type->toString();
+      throw CompilerException(expr.location(), ss.str());
+    }
+  } else if (literal->is<DoubleExpr>()) {
+    if (!type->is<DoubleType>()) return false;
+  } else return false;
+
+  literal->setType(type);
+  expr.setType(type);
+  return true;
+}
+
 void TypeChecker::checkIdentifierExpr(IdentifierExpr &expr) {
   if (Decl *decl = currentContext->getDecl(expr.lexeme())) {
     if (Type *type = decl->getType()) {
@@ -263,7 +1060,15 @@ void TypeChecker::checkListExpr(ListExpr &expr) {
 void TypeChecker::checkReferenceExpr(UnaryExpr &expr) {
   checkExpr(expr.getExpr());
 
+  if (isVectorLane(expr.getExpr())) {
+    throw CompilerException(expr.getOperator().start, "illegal attempt to reference a lane of a vector");
+  }
+  if (isSoaElement(expr.getExpr())) {
+    throw CompilerException(expr.getOperator().start, "illegal attempt to reference an element of an array of @soa structs");
+  }
+
   if (expr.getExpr().isLeftValue()) {
+    markReferenced(currentContext, expr.getExpr());
     auto referenced_type = expr.getExpr().getType()->getCanonicalType();
     auto expr_type = ReferenceType::getInstance(referenced_type);
     expr.setType(expr_type);
@@ -317,9 +1122,17 @@ void TypeChecker::checkUnaryExpr(UnaryExpr &expr) {
 
   // a function signature is constructed to search the identifier table for
   // a matching function
+  // operators on a vector apply to each lane, so they are resolved with the
+  // operator of the lane type
+  Type *operand_type = expr.getExpr().getType()->getCanonicalType();
+  VectorType *vector_type = operand_type->as<VectorType>();
+  if (vector_type) {
+    operand_type = vector_type->element_type();
+  }
+
   FunctionSignature unary_op_signature{
     expr.getOperator()
-  , {expr.getExpr().getType()->getCanonicalType()}
+  , {operand_type}
   };
 
   // this call will throw an exception if a unique, unambiguous function
@@ -331,5 +1144,9 @@ void TypeChecker::checkUnaryExpr(UnaryExpr &expr) {
   // declaration type to a function type
   FunctionType* func_type = static_cast<FunctionType*>(decl->canonical_type());
 
-  expr.setType(func_type->getReturnType()->getCanonicalType());
+  Type *result_type = func_type->getReturnType()->getCanonicalType();
+  if (vector_type) {
+    result_type = VectorType::getInstance(result_type, vector_type->size());
+  }
+  expr.setType(result_type);
 }
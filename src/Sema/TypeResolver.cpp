@@ -3,6 +3,7 @@
 #include "AST/DeclContext.h"
 
 #include "Sema/TypeResolver.h"
+#include "Sema/GenericInstantiator.h"
 
 // this function checks the type-kind of the given type, and dispatches it to
 // the proper type resolution method. This function contains a switch
@@ -49,9 +50,15 @@ void TypeResolver::resolve(class Type &type) {
   case Type::Kind::ListType:
     resolve(static_cast<ListType&>(type));
     break;
+  case Type::Kind::VectorType:
+    resolve(static_cast<VectorType&>(type));
+    break;
   case Type::Kind::MapType:
     resolve(static_cast<MapType&>(type));
     break;
+  case Type::Kind::AtomicType:
+    resolve(static_cast<AtomicType&>(type));
+    break;
   }
 }
 
@@ -64,9 +71,26 @@ void TypeResolver::resolve(class TypeIdentifier& type) {
       break;
 
     // should a struct declaration simply be a special case of type alias ?
-    case Decl::Kind::StructDecl:
-      type.setCanonicalType(static_cast<StructDecl*>(type_decl)->getType()->getCanonicalType());
+    case Decl::Kind::StructDecl: {
+      StructDecl *struct_decl = static_cast<StructDecl*>(type_decl);
+      if (struct_decl->isGeneric() != !type.getTypeArgs().empty()) {
+        std::stringstream ss;
+        ss << "the struct " << type.name() << (struct_decl->isGeneric() ? " expects" : " does not take") << " type arguments";
+        throw CompilerException(nullptr, ss.str());
+      }
+      // a generic struct is named with its type arguments, and the named type
+      // is the instance of the struct for those arguments
+      if (struct_decl->isGeneric()) {
+        std::vector<Type*> type_args;
+        for (Type *arg: type.getTypeArgs()) {
+          resolve(*arg);
+          type_args.push_back(arg->getCanonicalType());
+        }
+        struct_decl = &GenericInstantiator{}.instantiate(*struct_decl, type_args);
+      }
+      type.setCanonicalType(struct_decl->getType()->getCanonicalType());
       break;
+    }
 
     default:
       std::stringstream ss;
@@ -94,6 +118,12 @@ void TypeResolver::resolve(class ReferenceType& type) {
 
 void TypeResolver::resolve(class SliceType& type) {
   resolve(*type.element());
+  // the fields of an array of @soa structs are stored apart, so its elements
+  // can not be addressed through a pointer
+  StructType* struct_type = type.element()->getCanonicalType()->as<StructType>();
+  if (struct_type && struct_type->getLayout().is_soa) {
+    throw CompilerException(nullptr, "slices of @soa struct " + type.element()->toString() + " are not supported");
+  }
   type.setCanonicalType(
     SliceType::getInstance(type.element()->getCanonicalType())
   );
@@ -105,6 +135,10 @@ void TypeResolver::resolve(class SliceType& type) {
 void TypeResolver::resolve(class StructType& type) {
   for (auto member_type: type.elements()) {
     resolve(*member_type);
+    // atomic instructions need their operand to be aligned
+    if (type.getLayout().is_packed && member_type->getCanonicalType()->is<AtomicType>()) {
+      throw CompilerException(nullptr, "@packed structs can not have atomic members");
+    }
   }
 }
 
@@ -126,9 +160,18 @@ void TypeResolver::resolve(class FunctionType& type) {
   resolve(*type.getReturnType());
   canonical_return = type.getReturnType()->getCanonicalType();
 
+  // copying an atomic would read it without an atomic instruction, so they
+  // are passed by reference
+  if (canonical_return->is<AtomicType>()) {
+    throw CompilerException(nullptr, "functions can not return atomics, but may return a reference to one");
+  }
+
   for (auto param_type: type.getParamTypes()) {
     resolve(*param_type);
     canonical_params.push_back(param_type->getCanonicalType());
+    if (param_type->getCanonicalType()->is<AtomicType>()) {
+      throw CompilerException(nullptr, "atomics can not be passed by value, but may be passed by reference");
+    }
   }
 
   type.setCanonicalType(
@@ -136,16 +179,68 @@ void TypeResolver::resolve(class FunctionType& type) {
   );
 }
 
+// the size of an array may be named by an integer constant, whose value is
+// computed when the constant is declared
 void TypeResolver::resolve(class ListType& type) {
   resolve(*type.element_type());
+  int size = type.size();
+  if (type.hasNamedSize()) {
+    const std::string &name = type.size_name();
+    const ConstDecl *size_decl = dynamic_cast<const ConstDecl*>(
+      context_.getDecl(StringRef{name.data(), static_cast<int>(name.length())})
+    );
+    const ConstantValue *value = size_decl ? size_decl->getValue() : nullptr;
+    if (!value || !value->getType()->is<IntegerType>()) {
+      throw CompilerException(nullptr, "the size of an array must be an integer literal or an integer constant, not " + name);
+    }
+    bool is_negative = value->getType()->as<IntegerType>()->isSigned() && value->getInt() < 0;
+    if (is_negative || value->getBits() > INT32_MAX) {
+      std::string size_str = is_negative ? std::to_string(value->getInt()) : std::to_string(value->getBits());
+      throw CompilerException(nullptr, "array size " + name + " is out of range: " + size_str);
+    }
+    size = static_cast<int>(value->getBits());
+  }
+  type.setCanonicalType(
+    ListType::getInstance(type.element_type()->getCanonicalType(), size)
+  );
+}
+
+// the lanes of a vector must be scalars, so that the vector can be held in a
+// single SIMD register or a small number of them
+void TypeResolver::resolve(class VectorType& type) {
+  resolve(*type.element_type());
+  Type* lane_type = type.element_type()->getCanonicalType();
+  switch (lane_type->getKind()) {
+  case Type::Kind::CharacterType:
+  case Type::Kind::IntegerType:
+  case Type::Kind::DoubleType:
+  case Type::Kind::BooleanType: break;
+  default:
+    throw CompilerException(nullptr, "vector lanes must be of scalar type, not " + lane_type->toString());
+  }
   type.setCanonicalType(
-    ListType::getInstance(type.element_type()->getCanonicalType(), type.size())
+    VectorType::getInstance(lane_type, type.size())
   );
 }
 
+void TypeResolver::resolve(class AtomicType& type) {
+  resolve(*type.getValueType());
+  // atomic instructions operate on whole bytes
+  Type* value_type = type.getValueType()->getCanonicalType();
+  if (!value_type->isIntegerType()) {
+    throw CompilerException(nullptr, "atomics must hold integers, not " + value_type->toString());
+  }
+  type.setCanonicalType(AtomicType::getInstance(value_type));
+}
+
 void TypeResolver::resolve(class MapType& type) {
   resolve(*type.getKeyType());
   resolve(*type.getValueType());
+  // the runtime map stores keys as 64 bit integers
+  Type* key_type = type.getKeyType()->getCanonicalType();
+  if (!(key_type->isIntegerType() || key_type->isBooleanType() || key_type->is<CharacterType>())) {
+    throw CompilerException(nullptr, "map keys must be integers, characters or booleans, not " + key_type->toString());
+  }
   type.setCanonicalType(
     MapType::getInstance(
       type.getKeyType()->getCanonicalType()
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include "AST/Type.h"
+
+TEST(AtomicType, AtomicType) {
+  const Type* t1 = AtomicType::getInstance(IntegerType::getInstance());
+  const Type* t2 = AtomicType::getInstance(IntegerType::getInstance());
+  const Type* t3 = AtomicType::getInstance(IntegerType::getInstance(32, false));
+  ASSERT_EQ(t1, t2);
+  ASSERT_NE(t1, t3);
+  ASSERT_FALSE(t1->isIntegerType());
+  ASSERT_EQ(t1->getKind(), Type::Kind::AtomicType);
+  ASSERT_EQ(t1->getCanonicalType(), t1);
+}
+
+TEST(AtomicType, toString) {
+  const Type* t1 = AtomicType::getInstance(IntegerType::getInstance(32, false));
+  ASSERT_EQ(t1->toString(), "atomic[u32]");
+}
+
+TEST(AtomicType, getOrder) {
+  AtomicType::Order order;
+  ASSERT_TRUE(AtomicType::getOrder(StringRef{"acq_rel"}, order));
+  ASSERT_EQ(order, AtomicType::Order::AcquireRelease);
+  ASSERT_TRUE(AtomicType::getOrder(StringRef{"relaxed"}, order));
+  ASSERT_EQ(order, AtomicType::Order::Relaxed);
+  ASSERT_FALSE(AtomicType::getOrder(StringRef{"consume"}, order));
+}
@@ -25,3 +25,14 @@ TEST(DoubleType, toString) {
   const Type* t1 = DoubleType::getInstance();
   ASSERT_EQ(t1->toString(), "f64");
 }
+
+TEST(DoubleType, sized) {
+  const DoubleType* t1 = DoubleType::getInstance(32);
+  ASSERT_EQ(t1, DoubleType::getInstance(32));
+  ASSERT_NE(static_cast<const Type*>(t1), DoubleType::getInstance());
+  ASSERT_EQ(DoubleType::getInstance(64), DoubleType::getInstance());
+  ASSERT_TRUE(t1->isDoubleType());
+  ASSERT_EQ(t1->bits(), 32);
+  ASSERT_EQ(t1->toString(), "f32");
+  ASSERT_EQ(Type::getBuiltinType("f32"), t1);
+}
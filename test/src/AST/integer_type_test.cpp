@@ -25,3 +25,24 @@ TEST(IntegerType, toString) {
   const Type* t1 = IntegerType::getInstance();
   ASSERT_EQ(t1->toString(), "i64");
 }
+
+TEST(IntegerType, sized) {
+  const IntegerType* t1 = IntegerType::getInstance(8, false);
+  const IntegerType* t2 = IntegerType::getInstance(8, false);
+  const IntegerType* t3 = IntegerType::getInstance(8, true);
+  ASSERT_EQ(t1, t2);
+  ASSERT_NE(t1, t3);
+  ASSERT_EQ(IntegerType::getInstance(64, true), IntegerType::getInstance());
+  ASSERT_EQ(IntegerType::getInstance(24, true), nullptr);
+  ASSERT_TRUE(t1->isIntegerType());
+  ASSERT_FALSE(t1->isSigned());
+  ASSERT_EQ(t1->bits(), 8);
+  ASSERT_EQ(t1->toString(), "u8");
+  ASSERT_EQ(IntegerType::getInstance(32, true)->toString(), "i32");
+}
+
+TEST(IntegerType, getBuiltinType) {
+  ASSERT_EQ(Type::getBuiltinType("i64"), IntegerType::getInstance());
+  ASSERT_EQ(Type::getBuiltinType("u16"), IntegerType::getInstance(16, false));
+  ASSERT_EQ(Type::getBuiltinType("i128"), nullptr);
+}
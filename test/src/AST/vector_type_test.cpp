@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include "AST/Type.h"
+
+TEST(VectorType, VectorType) {
+  const Type* t1 = VectorType::getInstance(DoubleType::getInstance(), 4);
+  const Type* t2 = VectorType::getInstance(DoubleType::getInstance(), 4);
+  const Type* t3 = VectorType::getInstance(DoubleType::getInstance(), 2);
+  const Type* t4 = ListType::getInstance(DoubleType::getInstance(), 4);
+  ASSERT_EQ(t1, t2);
+  ASSERT_NE(t1, t3);
+  ASSERT_NE(t1, t4);
+  ASSERT_FALSE(t1->isIntegerType());
+  ASSERT_FALSE(t1->isDoubleType());
+  ASSERT_FALSE(t1->isBooleanType());
+}
+
+TEST(VectorType, getKind) {
+  const Type* t1 = VectorType::getInstance(DoubleType::getInstance(), 4);
+  ASSERT_EQ(t1->getKind(), Type::Kind::VectorType);
+}
+
+TEST(VectorType, getCanonicalType) {
+  const Type* t1 = VectorType::getInstance(DoubleType::getInstance(), 4);
+  ASSERT_EQ(t1->getCanonicalType(), t1);
+}
+
+TEST(VectorType, toString) {
+  const Type* t1 = VectorType::getInstance(DoubleType::getInstance(), 4);
+  ASSERT_EQ(t1->toString(), "vec[f64, 4]");
+}
@@ -1,3 +1,5 @@
+#include <map>
+
 #include <gtest/gtest.h>
 #include "Basic/SourceCode.h"
 
@@ -15,6 +17,18 @@ TEST(StringRef, operator_equal) {
   ASSERT_NE(StringRef{"test1"}, StringRef{"test2"});
 }
 
+TEST(StringRef, operator_less) {
+  EXPECT_TRUE(StringRef{"i"} < StringRef{"i8"});
+  EXPECT_FALSE(StringRef{"i8"} < StringRef{"i"});
+  EXPECT_TRUE(StringRef{"abc"} < StringRef{"abd"});
+  EXPECT_FALSE(StringRef{"abd"} < StringRef{"abc"});
+  EXPECT_FALSE(StringRef{"test"} < StringRef{"test"});
+  // a prefix of a longer string is a different key
+  std::multimap<StringRef, int> map{{StringRef{"i"}, 0}};
+  EXPECT_EQ(map.count(StringRef{"i8"}), 0);
+  EXPECT_EQ(map.count(StringRef{"i"}), 1);
+}
+
 TEST(StringRef, operator_stream) {
   std::stringstream ss;
   ss << StringRef{"test"};
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "CodeGen/ABIInfo.h"
+
+static const char* sysv_layout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128";
+
+TEST(ABIInfo, scalars_are_direct) {
+  llvm::LLVMContext context;
+  llvm::Module module{"test", context};
+  module.setTargetTriple("x86_64-unknown-linux-gnu");
+  module.setDataLayout(sysv_layout);
+  ABIInfo abi_info{module};
+  ASSERT_EQ(abi_info.classify(llvm::Type::getInt64Ty(context)).kind, ABIArgInfo::Kind::Direct);
+  ASSERT_EQ(abi_info.classify(llvm::Type::getDoubleTy(context)).kind, ABIArgInfo::Kind::Direct);
+}
+
+TEST(ABIInfo, small_aggregates_are_coerced) {
+  llvm::LLVMContext context;
+  llvm::Module module{"test", context};
+  module.setTargetTriple("x86_64-unknown-linux-gnu");
+  module.setDataLayout(sysv_layout);
+  ABIInfo abi_info{module};
+
+  // { i64, double } is split into an integer and an SSE register
+  llvm::Type* mixed = llvm::StructType::get(context, {
+    llvm::Type::getInt64Ty(context), llvm::Type::getDoubleTy(context)
+  });
+  ABIArgInfo mixed_info = abi_info.classify(mixed);
+  ASSERT_EQ(mixed_info.kind, ABIArgInfo::Kind::Coerce);
+  ASSERT_EQ(mixed_info.pieces.size(), 2);
+  ASSERT_TRUE(mixed_info.pieces[0]->isIntegerTy(64));
+  ASSERT_TRUE(mixed_info.pieces[1]->isDoubleTy());
+
+  // [i8, 3] fits in a single integer register
+  ABIArgInfo array_info = abi_info.classify(llvm::ArrayType::get(llvm::Type::getInt8Ty(context), 3));
+  ASSERT_EQ(array_info.kind, ABIArgInfo::Kind::Coerce);
+  ASSERT_EQ(array_info.pieces.size(), 1);
+  ASSERT_TRUE(array_info.pieces[0]->isIntegerTy(24));
+}
+
+TEST(ABIInfo, large_aggregates_are_indirect) {
+  llvm::LLVMContext context;
+  llvm::Module module{"test", context};
+  module.setTargetTriple("x86_64-unknown-linux-gnu");
+  module.setDataLayout(sysv_layout);
+  ABIInfo abi_info{module};
+  llvm::Type* large = llvm::ArrayType::get(llvm::Type::getInt64Ty(context), 3);
+  ASSERT_EQ(abi_info.classify(large).kind, ABIArgInfo::Kind::Indirect);
+
+  // other targets pass all aggregates in memory
+  module.setTargetTriple("aarch64-unknown-linux-gnu");
+  llvm::Type* small = llvm::ArrayType::get(llvm::Type::getInt64Ty(context), 1);
+  ASSERT_EQ(abi_info.classify(small).kind, ABIArgInfo::Kind::Indirect);
+}
+
+TEST(ABIInfo, pointers_are_coerced_to_pointers) {
+  llvm::LLVMContext context;
+  llvm::Module module{"test", context};
+  module.setTargetTriple("x86_64-unknown-linux-gnu");
+  module.setDataLayout(sysv_layout);
+  ABIInfo abi_info{module};
+
+  // a slice { i64*, i64 } keeps its data pointer
+  llvm::Type* slice = llvm::StructType::get(context, {
+    llvm::PointerType::getUnqual(llvm::Type::getInt64Ty(context)), llvm::Type::getInt64Ty(context)
+  });
+  ABIArgInfo slice_info = abi_info.classify(slice);
+  ASSERT_EQ(slice_info.kind, ABIArgInfo::Kind::Coerce);
+  ASSERT_EQ(slice_info.pieces.size(), 2);
+  ASSERT_TRUE(slice_info.pieces[0]->isPointerTy());
+  ASSERT_TRUE(slice_info.pieces[1]->isIntegerTy(64));
+}
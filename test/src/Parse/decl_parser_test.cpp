@@ -28,3 +28,72 @@ TEST(DeclParser, parseLetDecl) {
   EXPECT_EQ(letDecl->getName(), StringRef{"b"});
   EXPECT_EQ(letDecl->getExpr().getKind(), Expr::Kind::DoubleExpr );
 }
+
+TEST(DeclParser, parseFuncAttributes) {
+
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    // diagnostics refer to the current file, which also keeps the lexemes alive
+    SourceManager::currentSource = src;
+    Parser parser = Parser{src};
+    return parser.parseFuncDecl();
+  };
+
+  std::unique_ptr<FuncDecl> funcDecl;
+
+  ASSERT_NO_THROW(funcDecl = parse("func f() -> i64 {\n  return 0\n}"));
+  EXPECT_FALSE(funcDecl->getFuncAttributes().is_inline);
+  EXPECT_FALSE(funcDecl->getFuncAttributes().is_cold);
+
+  ASSERT_NO_THROW(funcDecl = parse("inline @hot func f() -> i64 {\n  return 0\n}"));
+  EXPECT_TRUE(funcDecl->getFuncAttributes().is_inline);
+  EXPECT_TRUE(funcDecl->getFuncAttributes().is_hot);
+  EXPECT_EQ(funcDecl->getName(), StringRef{"f"});
+
+  ASSERT_NO_THROW(funcDecl = parse("@cold\n@noinline\nfunc f() -> i64 {\n  return 0\n}"));
+  EXPECT_TRUE(funcDecl->getFuncAttributes().is_cold);
+  EXPECT_TRUE(funcDecl->getFuncAttributes().is_noinline);
+
+  EXPECT_THROW(parse("@fast func f() -> i64 {\n  return 0\n}"), CompilerException);
+  EXPECT_THROW(parse("inline @noinline func f() -> i64 {\n  return 0\n}"), CompilerException);
+  EXPECT_THROW(parse("@hot @cold func f() -> i64 {\n  return 0\n}"), CompilerException);
+}
+
+TEST(DeclParser, parseStructAttributes) {
+
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    SourceManager::currentSource = src;
+    Parser parser = Parser{src};
+    return parser.parseDecl();
+  };
+
+  auto layout = [](const std::unique_ptr<Decl>& decl) {
+    return dynamic_cast<StructType*>(decl->getType())->getLayout();
+  };
+
+  std::unique_ptr<Decl> decl;
+
+  ASSERT_NO_THROW(decl = parse("struct S {\n  x: i64\n}"));
+  EXPECT_FALSE(layout(decl).is_packed);
+  EXPECT_EQ(layout(decl).align, 0u);
+
+  ASSERT_NO_THROW(decl = parse("@reorder @align(32)\nstruct S {\n  x: i64\n}"));
+  ASSERT_TRUE(dynamic_cast<StructDecl*>(decl.get()));
+  EXPECT_TRUE(layout(decl).is_reordered);
+  EXPECT_EQ(layout(decl).align, 32u);
+
+  ASSERT_NO_THROW(decl = parse("@packed\n@soa\nstruct S {\n  x: i64\n}"));
+  EXPECT_TRUE(layout(decl).is_packed);
+  EXPECT_TRUE(layout(decl).is_soa);
+
+  // function attributes are still parsed as such
+  ASSERT_NO_THROW(decl = parse("@hot func f() -> i64 {\n  return 0\n}"));
+  EXPECT_TRUE(dynamic_cast<FuncDecl*>(decl.get()));
+
+  EXPECT_THROW(parse("@align(12) struct S {\n  x: i64\n}"), CompilerException);
+  EXPECT_THROW(parse("@packed @align(8) struct S {\n  x: i64\n}"), CompilerException);
+  EXPECT_THROW(parse("@soa @tight struct S {\n  x: i64\n}"), CompilerException);
+}
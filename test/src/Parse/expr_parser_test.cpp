@@ -74,6 +74,29 @@ TEST(ExprParser, parseUnaryExpr) {
 
 }
 
+TEST(ExprParser, parseAccessorExpr) {
+
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    Parser parser = Parser{src};
+    return parser.parseAccessorExpr();
+  };
+
+  // accessors nest to the left, so the last accessor is the outermost
+  std::unique_ptr<Expr> expr;
+  ASSERT_NO_THROW(expr = parse("a[i].x"));
+  AccessorExpr *member = dynamic_cast<AccessorExpr*>(expr.get());
+  ASSERT_TRUE(member);
+  EXPECT_TRUE(member->index().is<IdentifierExpr>());
+  EXPECT_TRUE(member->identifier().is<AccessorExpr>());
+
+  ASSERT_NO_THROW(expr = parse("a.b.c"));
+  member = dynamic_cast<AccessorExpr*>(expr.get());
+  ASSERT_TRUE(member);
+  EXPECT_TRUE(member->identifier().is<AccessorExpr>());
+}
+
 TEST(ExprParser, parseBinaryExpr) {
 
   auto parse = [](std::string text) {
@@ -87,6 +110,28 @@ TEST(ExprParser, parseBinaryExpr) {
   EXPECT_NO_THROW(parse("4-abc"));
 }
 
+TEST(ExprParser, parseBitwiseExpr) {
+
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    Parser parser = Parser{src};
+    return parser.parseBinaryExpr(OperatorTable::size());
+  };
+
+  // shifts bind tightest, '&' like '*', and '|' and '^' like '+'
+  auto root_operator = [&](std::string text) {
+    auto expr = parse(text);
+    return dynamic_cast<BinaryExpr&>(*expr).getOperator().str();
+  };
+  EXPECT_EQ(root_operator("a | b & c"), "|");
+  EXPECT_EQ(root_operator("a & b | c"), "|");
+  EXPECT_EQ(root_operator("a + b << 2"), "+");
+  EXPECT_EQ(root_operator("a ^ b == c"), "==");
+  EXPECT_EQ(root_operator("a >>= 1"), ">>=");
+  EXPECT_NO_THROW(parse("~a & b"));
+}
+
 TEST(ExprParser, parseExprList) {
 
   auto parse = [](std::string text) {
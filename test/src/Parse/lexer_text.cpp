@@ -14,7 +14,7 @@ TEST(Lexer, Lexer) {
 
 TEST(Lexer, lexPunctuaction) {
   std::vector<std::string> possible_operators{
-    "[", "]", "(", ")", "{", "}", ":", ";", ",", "\\", "\n"
+    "[", "]", "(", ")", "{", "}", ":", ";", ",", "\\", "@", "\n"
   };
 
   std::stringstream no_space;
@@ -188,3 +188,17 @@ TEST(Lexer, lexIdentifier) {
   ASSERT_TRUE(space_lexer.next().is(Token::eof));
 
 }
+
+TEST(Lexer, lexRange) {
+  Lexer lexer = make_lexer("for i in 0..n");
+  EXPECT_TRUE(lexer.next().is(Token::kw_for));
+  EXPECT_TRUE(lexer.next().is(Token::identifier));
+  EXPECT_TRUE(lexer.next().is(Token::kw_in));
+
+  Token start = lexer.next();
+  EXPECT_TRUE(start.is(Token::integer_literal));
+  EXPECT_EQ(start.lexeme(), StringRef{"0"});
+  EXPECT_TRUE(lexer.next().is(Token::range));
+  EXPECT_TRUE(lexer.next().is(Token::identifier));
+  EXPECT_TRUE(lexer.next().is(Token::eof));
+}
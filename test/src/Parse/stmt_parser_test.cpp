@@ -60,3 +60,91 @@ TEST(StmtParser, parseReturnStmt) {
   EXPECT_NO_THROW(parse("return\n"));
   EXPECT_ANY_THROW(parse("return"));
 }
+
+TEST(StmtParser, parseForLoop) {
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    SourceManager::currentSource = src;
+    Parser parser = Parser{src};
+    return parser.parseForLoop();
+  };
+
+  std::unique_ptr<ForLoop> range_loop;
+  ASSERT_NO_THROW(range_loop = parse("for i in 0..len(s) {\nx = x + i\n}"));
+  EXPECT_TRUE(range_loop->isRange());
+  EXPECT_EQ(range_loop->getDeclaration()->getName(), StringRef{"i"});
+
+  std::unique_ptr<ForLoop> sequence_loop;
+  ASSERT_NO_THROW(sequence_loop = parse("for x in s {\n}"));
+  EXPECT_FALSE(sequence_loop->isRange());
+  EXPECT_NE(sequence_loop->getSequence(), nullptr);
+
+  EXPECT_ANY_THROW(parse("for 0..n {\n}"));
+  EXPECT_ANY_THROW(parse("for i 0..n {\n}"));
+
+  std::unique_ptr<ForLoop> parallel_loop;
+  ASSERT_NO_THROW(parallel_loop = parse("parallel for i in 0..n reduce(+: x, max: y) {\nx = x + i\n}"));
+  EXPECT_TRUE(parallel_loop->isParallel());
+  ASSERT_EQ(parallel_loop->getReductions().size(), 2u);
+  EXPECT_EQ(parallel_loop->getReductions()[0].op, Reduction::Operator::Add);
+  EXPECT_EQ(parallel_loop->getReductions()[1].op, Reduction::Operator::Max);
+  EXPECT_EQ(parallel_loop->getReductions()[1].variable->lexeme(), StringRef{"y"});
+  EXPECT_FALSE(range_loop->isParallel());
+
+  EXPECT_NO_THROW(parse("parallel for i in 0..n {\n}"));
+  EXPECT_ANY_THROW(parse("parallel for x in s {\n}"));
+  EXPECT_ANY_THROW(parse("parallel for i in 0..n reduce(-: x) {\n}"));
+}
+
+TEST(StmtParser, parseMatchStmt) {
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    SourceManager::currentSource = src;
+    Parser parser = Parser{src};
+    return parser.parseMatchStmt();
+  };
+
+  std::unique_ptr<MatchStmt> match_stmt;
+  ASSERT_NO_THROW(match_stmt = parse("match x {\ncase 0 {\ny = 1\n}\n\ncase 1, 2 then y = 2\nelse {\n}\n}"));
+  ASSERT_EQ(match_stmt->getCases().size(), 2u);
+  EXPECT_EQ(match_stmt->getCases()[0].values.size(), 1u);
+  EXPECT_EQ(match_stmt->getCases()[1].values.size(), 2u);
+  EXPECT_EQ(match_stmt->getCases()[1].block->getStmts().size(), 1u);
+  EXPECT_NE(match_stmt->getElse(), nullptr);
+
+  std::unique_ptr<MatchStmt> without_else;
+  ASSERT_NO_THROW(without_else = parse("match c {\ncase 'a' then return 1\n}"));
+  EXPECT_EQ(without_else->getElse(), nullptr);
+
+  EXPECT_NO_THROW(parse("match x {\n}"));
+  EXPECT_ANY_THROW(parse("match x {\ncase {\n}\n}"));
+  EXPECT_ANY_THROW(parse("match x {\nelse {\n}\ncase 0 {\n}\n}"));
+}
+
+TEST(StmtParser, parseAttributedStmt) {
+  auto parse = [](std::string text) {
+    std::stringstream ss{text};
+    std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+    SourceManager::currentSource = src;
+    Parser parser = Parser{src};
+    return parser.parseStmt();
+  };
+
+  std::unique_ptr<Stmt> arena;
+  ASSERT_NO_THROW(arena = parse("@arena {\nlet p: &i64 = new(5)\n}\n"));
+  ASSERT_NE(dynamic_cast<CompoundStmt*>(arena.get()), nullptr);
+  EXPECT_EQ(static_cast<CompoundStmt&>(*arena).getAllocator(), CompoundStmt::Allocator::Arena);
+
+  std::unique_ptr<Stmt> pool;
+  ASSERT_NO_THROW(pool = parse("@pool {\n}\n"));
+  EXPECT_EQ(static_cast<CompoundStmt&>(*pool).getAllocator(), CompoundStmt::Allocator::Pool);
+
+  // other attributes belong to a function declaration
+  std::unique_ptr<Stmt> func;
+  ASSERT_NO_THROW(func = parse("@hot\nfunc f() -> i64 {\nreturn 0\n}\n"));
+  EXPECT_NE(dynamic_cast<DeclStmt*>(func.get()), nullptr);
+
+  EXPECT_ANY_THROW(parse("@arena\n"));
+}
@@ -0,0 +1,41 @@
+#include "analyze.h"
+
+#include <sstream>
+#include <vector>
+
+#include "Basic/SourceCode.h"
+#include "Parse/Parser.h"
+#include "Sema/ScopeBuilder.h"
+
+// the sources of all units, which must outlive them
+static std::vector<std::shared_ptr<SourceFile>> sources;
+
+static std::unique_ptr<CompilationUnit> parse(std::string text) {
+  std::stringstream ss{text};
+  std::shared_ptr<SourceFile> src = std::make_shared<SourceFile>(ss);
+  sources.push_back(src);
+  // the parser backtracks by catching diagnostics, which need a current file
+  SourceManager::currentSource = src;
+  Parser parser = Parser{src};
+  return parser.parseCompilationUnit();
+}
+
+std::unique_ptr<CompilationUnit> analyze(std::string text) {
+  std::unique_ptr<CompilationUnit> unit = parse(text);
+  ScopeBuilder().buildCompilationUnitScope(*unit);
+  return unit;
+}
+
+std::unique_ptr<CompilationUnit> analyze(std::string text, DeclContext &program) {
+  std::unique_ptr<CompilationUnit> unit = parse(text);
+  ScopeBuilder().buildCompilationUnitScope(*unit, program);
+  return unit;
+}
+
+Decl* getDecl(CompilationUnit &unit, int index) {
+  return dynamic_cast<DeclStmt*>(unit.stmts()[index].get())->getDecl();
+}
+
+FuncDecl& getFunction(CompilationUnit &unit, int index) {
+  return *dynamic_cast<FuncDecl*>(getDecl(unit, index));
+}
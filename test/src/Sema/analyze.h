@@ -0,0 +1,25 @@
+#ifndef TEST_SEMA_ANALYZE_H
+#define TEST_SEMA_ANALYZE_H
+
+#include <memory>
+#include <string>
+
+#include "AST/Decl.h"
+#include "AST/DeclContext.h"
+#include "AST/Stmt.h"
+
+/// Parses the text as a compilation unit and builds its scope. The source of
+/// the unit is kept for the rest of the test run, since the tokens of the
+/// unit point into it.
+std::unique_ptr<CompilationUnit> analyze(std::string text);
+
+/// Analyzes the text as one of the compilation units of the program
+std::unique_ptr<CompilationUnit> analyze(std::string text, DeclContext &program);
+
+/// Returns the declaration of the index-th statement of the unit
+Decl* getDecl(CompilationUnit &unit, int index);
+
+/// Returns the function declared by the index-th statement of the unit
+FuncDecl& getFunction(CompilationUnit &unit, int index);
+
+#endif
@@ -0,0 +1,73 @@
+#include <functional>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AST/Decl.h"
+#include "AST/Expr.h"
+#include "AST/Stmt.h"
+
+#include "analyze.h"
+
+// Returns a function which counts i up to len(s) with the given increment,
+// and accesses s[i] in the loop
+static std::string countingLoop(std::string name, std::string increment) {
+  return
+    "func " + name + "(s: &[i64]) -> i64 {\n"
+    "  var total: i64 = 0\n"
+    "  var i: i64 = 0\n"
+    "  while i < len(s) {\n"
+    "    total = total + s[i]\n"
+    "    " + increment + "\n"
+    "  }\n"
+    "  return total\n"
+    "}\n";
+}
+
+// Returns whether the element access in the function is marked as in bounds
+static bool isAccessInBounds(CompilationUnit &unit, int index) {
+  bool in_bounds = false;
+  std::function<void(TreeElement&)> visit = [&](TreeElement &element) {
+    if (AccessorExpr *accessor = dynamic_cast<AccessorExpr*>(&element)) {
+      in_bounds = accessor->isInBounds();
+    }
+    for (TreeElement *child: element.getChildren()) {
+      if (child) visit(*child);
+    }
+  };
+  visit(*getDecl(unit, index));
+  return in_bounds;
+}
+
+TEST(BoundsCheckEliminator, eliminate) {
+  auto unit = analyze(
+    countingLoop("next", "i = i + 1")
+    + countingLoop("next_swapped", "i = 1 + i")
+    + countingLoop("next_compound", "i += 1")
+    + countingLoop("wrapping", "i = i + 9223372036854775807")
+    + countingLoop("step", "i = i + 2")
+    + countingLoop("compound_step", "i += 2")
+  );
+
+  EXPECT_TRUE(isAccessInBounds(*unit, 0));
+  EXPECT_TRUE(isAccessInBounds(*unit, 1));
+  EXPECT_TRUE(isAccessInBounds(*unit, 2));
+
+  // larger steps may wrap around to a negative index
+  EXPECT_FALSE(isAccessInBounds(*unit, 3));
+  EXPECT_FALSE(isAccessInBounds(*unit, 4));
+  EXPECT_FALSE(isAccessInBounds(*unit, 5));
+}
+
+TEST(BoundsCheckEliminator, shadowedLen) {
+  // a function declared as len may return anything, so it does not bound the
+  // index
+  auto unit = analyze(
+    "func len(s: &[i64]) -> i64 {\n"
+    "  return 9223372036854775807\n"
+    "}\n"
+    + countingLoop("shadowed", "i = i + 1")
+  );
+
+  EXPECT_FALSE(isAccessInBounds(*unit, 1));
+}
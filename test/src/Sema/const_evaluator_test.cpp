@@ -0,0 +1,66 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AST/Decl.h"
+#include "AST/Stmt.h"
+#include "Basic/CompilerException.h"
+
+#include "analyze.h"
+
+TEST(ConstEvaluator, evaluate) {
+  auto unit = analyze(
+    "func fib(n: i64) -> i64 {\n"
+    "  if n < 2 {\n"
+    "    return n\n"
+    "  }\n"
+    "  return fib(n - 1) + fib(n - 2)\n"
+    "}\n"
+    "func squares() -> [i64, 4] {\n"
+    "  var table: [i64, 4] = [0, 0, 0, 0]\n"
+    "  for i in 0..4 {\n"
+    "    table[i] = i * i\n"
+    "  }\n"
+    "  return table\n"
+    "}\n"
+    "const count: i64 = fib(10)\n"
+    "const table: [i64, 4] = squares()\n"
+    "const size: i64 = len(table)\n"
+    "const mask: u8 = ~u8(1) << 1\n"
+    "func last(a: [i64, size]) -> i64 {\n"
+    "  let i: i64 = size - 1\n"
+    "  return a[i]\n"
+    "}\n"
+  );
+
+  // functions declared before a constant may be called in its initializer
+  ConstDecl *count = dynamic_cast<ConstDecl*>(getDecl(*unit, 2));
+  ASSERT_NE(count->getValue(), nullptr);
+  EXPECT_EQ(count->getValue()->getInt(), 55);
+
+  ConstDecl *table = dynamic_cast<ConstDecl*>(getDecl(*unit, 3));
+  ASSERT_EQ(table->getValue()->elements().size(), 4);
+  EXPECT_EQ(table->getValue()->elements()[3].getInt(), 9);
+
+  // integers wrap around at the width of their type
+  ConstDecl *mask = dynamic_cast<ConstDecl*>(getDecl(*unit, 5));
+  EXPECT_EQ(mask->getValue()->getBits(), 252);
+
+  // array sizes named by a constant resolve to the value of the constant
+  FuncDecl *last = dynamic_cast<FuncDecl*>(getDecl(*unit, 6));
+  Type *param_type = last->getParams()[0]->getType()->getCanonicalType();
+  EXPECT_EQ(param_type, ListType::getInstance(IntegerType::getInstance(), 4));
+}
+
+TEST(ConstEvaluator, errors) {
+  EXPECT_THROW(analyze("const bad: i64 = 1 / (2 - 2)\n"), CompilerException);
+  EXPECT_THROW(analyze(
+    "func loop() -> i64 {\n"
+    "  while true {\n"
+    "  }\n"
+    "  return 0\n"
+    "}\n"
+    "const forever: i64 = loop()\n"
+  ), CompilerException);
+  EXPECT_THROW(analyze("func f(a: [i64, n]) -> i64 {\n  return 0\n}\n"), CompilerException);
+}
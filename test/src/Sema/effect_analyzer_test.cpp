@@ -0,0 +1,147 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AST/Decl.h"
+#include "AST/Stmt.h"
+
+#include "analyze.h"
+
+// all functions are analyzed as part of a single compilation unit, so that
+// later functions may call earlier ones
+TEST(EffectAnalyzer, analyze) {
+  auto unit = analyze(
+    "func square(x: i64) -> i64 {\n"
+    "  return x * x\n"
+    "}\n"
+    "func count(n: i64) -> i64 {\n"
+    "  var i: i64 = 0\n"
+    "  while i < n {\n"
+    "    i = i + 1\n"
+    "  }\n"
+    "  return i\n"
+    "}\n"
+    "func get(a: &[i64, 2]) -> i64 {\n"
+    "  return a[0]\n"
+    "}\n"
+    "func set(a: &[i64, 2], b: &[i64, 2]) -> i64 {\n"
+    "  a[0] = b[1]\n"
+    "  return 0\n"
+    "}\n"
+    "func leak(a: &[i64, 2]) -> i64 {\n"
+    "  return get(a)\n"
+    "}\n"
+    "func sum(s: &[i64]) -> i64 {\n"
+    "  var total: i64 = 0\n"
+    "  for x in s {\n"
+    "    total = total + x\n"
+    "  }\n"
+    "  return total\n"
+    "}\n"
+    "func scale(s: &[i64]) -> i64 {\n"
+    "  for i in 0..len(s) {\n"
+    "    s[i] = s[i] * 2\n"
+    "  }\n"
+    "  return 0\n"
+    "}\n"
+    "func dot(a: &[f64], b: &[f64]) -> f64 {\n"
+    "  let products: vec[f64, 4] = load(a, 0, 4) * load(b, 0, 4)\n"
+    "  return reduce_add(products)\n"
+    "}\n"
+    "func clamp(s: &[f64]) -> vec[f64, 4] {\n"
+    "  let v: vec[f64, 4] = load(s, 0, 4)\n"
+    "  let zero: vec[f64, 4] = splat(0.0, 4)\n"
+    "  return store(s, 0, select(v < zero, zero, v))\n"
+    "}\n"
+    "func total(s: &[i64]) -> i64 {\n"
+    "  var t: i64 = 0\n"
+    "  parallel for i in 0..len(s) reduce(+: t) {\n"
+    "    t = t + s[i]\n"
+    "  }\n"
+    "  return t\n"
+    "}\n"
+    "func bump(c: &atomic[i64]) -> i64 {\n"
+    "  return fetch_add(c, 1, relaxed)\n"
+    "}\n"
+  );
+
+  // arithmetic on values accesses no memory
+  FuncDecl &square = getFunction(*unit, 0);
+  EXPECT_FALSE(square.readsMemory());
+  EXPECT_FALSE(square.writesMemory());
+  EXPECT_TRUE(square.willReturn());
+
+  // loops might not terminate
+  FuncDecl &count = getFunction(*unit, 1);
+  EXPECT_FALSE(count.readsMemory());
+  EXPECT_FALSE(count.writesMemory());
+  EXPECT_FALSE(count.willReturn());
+
+  // a parameter which is only read is readonly, and nothing else can modify
+  // it during the call
+  FuncDecl &get = getFunction(*unit, 2);
+  EXPECT_TRUE(get.readsMemory());
+  EXPECT_FALSE(get.writesMemory());
+  EXPECT_TRUE(get.accessesArgMemoryOnly());
+  EXPECT_TRUE(get.getParams()[0]->isReadOnly());
+  EXPECT_TRUE(get.getParams()[0]->isNoAlias());
+
+  // two accessed parameters may alias each other
+  FuncDecl &set = getFunction(*unit, 3);
+  EXPECT_TRUE(set.writesMemory());
+  EXPECT_FALSE(set.getParams()[0]->isReadOnly());
+  EXPECT_FALSE(set.getParams()[0]->isNoAlias());
+  EXPECT_TRUE(set.getParams()[1]->isReadOnly());
+  EXPECT_FALSE(set.getParams()[1]->isNoAlias());
+
+  // a parameter passed to another function escapes
+  FuncDecl &leak = getFunction(*unit, 4);
+  EXPECT_TRUE(leak.readsMemory());
+  EXPECT_FALSE(leak.getParams()[0]->isReadOnly());
+  EXPECT_FALSE(leak.getParams()[0]->isNoAlias());
+
+  // for loops always terminate, and iterating a slice reads it
+  FuncDecl &sum = getFunction(*unit, 5);
+  EXPECT_TRUE(sum.readsMemory());
+  EXPECT_FALSE(sum.writesMemory());
+  EXPECT_TRUE(sum.willReturn());
+  EXPECT_TRUE(sum.getParams()[0]->isReadOnly());
+
+  // accesses indexed by a loop variable bounded by the length are unchecked
+  FuncDecl &scale = getFunction(*unit, 6);
+  EXPECT_TRUE(scale.writesMemory());
+  EXPECT_TRUE(scale.willReturn());
+  EXPECT_TRUE(scale.getParams()[0]->isNoAlias());
+
+  // vector loads read through their first argument, and their lanes are
+  // checked against its length
+  FuncDecl &dot = getFunction(*unit, 7);
+  EXPECT_TRUE(dot.readsMemory());
+  EXPECT_FALSE(dot.writesMemory());
+  EXPECT_FALSE(dot.willReturn());
+  EXPECT_TRUE(dot.getParams()[0]->isReadOnly());
+  EXPECT_TRUE(dot.getParams()[1]->isReadOnly());
+
+  // vector stores write through their first argument
+  FuncDecl &clamp = getFunction(*unit, 8);
+  EXPECT_TRUE(clamp.writesMemory());
+  EXPECT_TRUE(clamp.accessesArgMemoryOnly());
+  EXPECT_FALSE(clamp.getParams()[0]->isReadOnly());
+  EXPECT_TRUE(clamp.getParams()[0]->isNoAlias());
+
+  // the body of a parallel loop runs in the runtime, which is passed the
+  // parameters the body uses
+  FuncDecl &total = getFunction(*unit, 9);
+  EXPECT_TRUE(total.writesMemory());
+  EXPECT_FALSE(total.accessesArgMemoryOnly());
+  EXPECT_FALSE(total.getParams()[0]->isNoAlias());
+
+  // atomics are shared with other threads, whose writes an atomic access may
+  // make visible
+  FuncDecl &bump = getFunction(*unit, 10);
+  EXPECT_TRUE(bump.readsMemory());
+  EXPECT_TRUE(bump.writesMemory());
+  EXPECT_TRUE(bump.willReturn());
+  EXPECT_FALSE(bump.accessesArgMemoryOnly());
+  EXPECT_FALSE(bump.getParams()[0]->isNoAlias());
+}
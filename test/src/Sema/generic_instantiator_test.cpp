@@ -0,0 +1,101 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AST/Decl.h"
+#include "AST/Stmt.h"
+#include "Basic/CompilerException.h"
+
+#include "analyze.h"
+
+TEST(GenericInstantiator, functions) {
+  auto unit = analyze(
+    "func larger[T](a: T, b: T) -> T {\n"
+    "  if a > b {\n"
+    "    return a\n"
+    "  }\n"
+    "  return b\n"
+    "}\n"
+    "func first[T](s: [T]) -> T {\n"
+    "  return s[0]\n"
+    "}\n"
+    "func main() -> i64 {\n"
+    "  let x: i32 = 3\n"
+    "  let a: [f64, 2] = [1.0, 2.0]\n"
+    "  let y: f64 = larger(first(&a), 0.5)\n"
+    "  let z: i32 = larger(x, 4)\n"
+    "  return larger(1, 2) + larger(2, 3)\n"
+    "}\n"
+  );
+
+  // each list of type arguments is instantiated once, and literals take the
+  // type inferred from the other arguments
+  FuncDecl *larger = dynamic_cast<FuncDecl*>(getDecl(*unit, 0));
+  ASSERT_EQ(larger->getInstances().size(), 3);
+  EXPECT_EQ(larger->getInstances()[0]->getSymbolName(), "larger[f64]");
+  EXPECT_EQ(larger->getInstances()[1]->getSymbolName(), "larger[i32]");
+  EXPECT_EQ(larger->getInstances()[2]->getSymbolName(), "larger[i64]");
+
+  // a slice parameter binds the element type of a reference to an array
+  FuncDecl *first = dynamic_cast<FuncDecl*>(getDecl(*unit, 1));
+  ASSERT_EQ(first->getInstances().size(), 1);
+  Type *param_type = first->getInstances()[0]->getParams()[0]->getType()->getCanonicalType();
+  EXPECT_EQ(param_type, SliceType::getInstance(DoubleType::getInstance()));
+}
+
+TEST(GenericInstantiator, structs) {
+  auto unit = analyze(
+    "struct Pair[A, B] {\n"
+    "  first: A\n"
+    "  second: B\n"
+    "}\n"
+    "func swap[A, B](p: Pair[A, B]) -> Pair[B, A] {\n"
+    "  var q: Pair[B, A]\n"
+    "  q.first = p.second\n"
+    "  q.second = p.first\n"
+    "  return q\n"
+    "}\n"
+    "func main(p: Pair[i64, f64]) -> f64 {\n"
+    "  let q: Pair[f64, i64] = swap(p)\n"
+    "  return q.first\n"
+    "}\n"
+  );
+
+  // equally named instances are the same struct type
+  StructDecl *pair = dynamic_cast<StructDecl*>(getDecl(*unit, 0));
+  ASSERT_EQ(pair->getInstances().size(), 2);
+  FuncDecl *swap = dynamic_cast<FuncDecl*>(getDecl(*unit, 1));
+  ASSERT_EQ(swap->getInstances().size(), 1);
+  EXPECT_EQ(swap->getInstances()[0]->getSymbolName(), "swap[i64, f64]");
+}
+
+TEST(GenericInstantiator, errors) {
+  // type parameters which occur only in the return type can not be inferred
+  EXPECT_THROW(analyze(
+    "func zero[T]() -> T {\n"
+    "  return 0\n"
+    "}\n"
+    "func main() -> i64 {\n"
+    "  return zero()\n"
+    "}\n"
+  ), CompilerException);
+
+  // instances are checked like any other function
+  EXPECT_THROW(analyze(
+    "func negate[T](x: T) -> T {\n"
+    "  return -x\n"
+    "}\n"
+    "func main() -> bool {\n"
+    "  return negate(true)\n"
+    "}\n"
+  ), CompilerException);
+
+  EXPECT_THROW(analyze(
+    "struct Box[T] {\n"
+    "  value: T\n"
+    "}\n"
+    "func main(b: Box) -> i64 {\n"
+    "  return 0\n"
+    "}\n"
+  ), CompilerException);
+}
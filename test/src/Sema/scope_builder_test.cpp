@@ -0,0 +1,107 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AST/Decl.h"
+#include "AST/DeclContext.h"
+#include "AST/Expr.h"
+#include "AST/Stmt.h"
+#include "Basic/CompilerException.h"
+
+#include "analyze.h"
+
+TEST(ScopeBuilder, buildCompilationUnitScope) {
+  DeclContext program;
+  auto lib = analyze(
+    "extern func abs(i32) -> i32\n"
+    "func square(n: i64) -> i64 {\n"
+    "  return n * n\n"
+    "}\n",
+    program
+  );
+  auto app = analyze(
+    "extern func abs(i32) -> i32\n"
+    "func main() -> i64 {\n"
+    "  return square(3)\n"
+    "}\n",
+    program
+  );
+  ReturnStmt *ret = dynamic_cast<ReturnStmt*>(getFunction(*app, 1).getBlockStmt().getStmts().back().get());
+  FunctionCall *call = dynamic_cast<FunctionCall*>(ret->getExpr());
+  EXPECT_EQ(call->getDecl(), &getFunction(*lib, 1));
+  EXPECT_EQ(program.getDeclMap().count(StringRef{"abs"}), 1);
+
+  EXPECT_THROW(analyze(
+    "func square(n: i64) -> i64 {\n"
+    "  return n\n"
+    "}\n",
+    program
+  ), CompilerException);
+}
+
+TEST(ScopeBuilder, checkMapUses) {
+  DeclContext program;
+  // a map is lent to the builtins and to functions
+  EXPECT_NO_THROW(analyze(
+    "func fill(seen: [i64: bool], keys: &[i64]) -> i64 {\n"
+    "  for k in keys {\n"
+    "    insert(seen, k, true)\n"
+    "  }\n"
+    "  return len(seen)\n"
+    "}\n"
+    "func count(keys: &[i64]) -> i64 {\n"
+    "  var seen: [i64: bool]\n"
+    "  return fill(seen, keys)\n"
+    "}\n",
+    program
+  ));
+
+  // but is freed with its block, so it may not outlive it
+  EXPECT_THROW(analyze(
+    "func make() -> [i64: bool] {\n"
+    "  var made: [i64: bool]\n"
+    "  return made\n"
+    "}\n",
+    program
+  ), CompilerException);
+  EXPECT_THROW(analyze(
+    "func alias() -> i64 {\n"
+    "  var made: [i64: bool]\n"
+    "  var copy: [i64: bool]\n"
+    "  copy = made\n"
+    "  return 0\n"
+    "}\n",
+    program
+  ), CompilerException);
+}
+
+TEST(ScopeBuilder, checkParallelBody) {
+  DeclContext program;
+  // the body may allocate from an allocator block of its own
+  EXPECT_NO_THROW(analyze(
+    "func fill(s: &[i64]) -> i64 {\n"
+    "  parallel for i in 0..len(s) {\n"
+    "    @arena {\n"
+    "      let x: &i64 = new(i)\n"
+    "      free(x)\n"
+    "    }\n"
+    "  }\n"
+    "  return 0\n"
+    "}\n",
+    program
+  ));
+
+  // but not from the allocator of the thread which started the loop
+  EXPECT_THROW(analyze(
+    "func leak(s: &[i64]) -> i64 {\n"
+    "  @arena {\n"
+    "    parallel for i in 0..len(s) {\n"
+    "      let x: &i64 = new(i)\n"
+    "      free(x)\n"
+    "    }\n"
+    "  }\n"
+    "  return 0\n"
+    "}\n",
+    program
+  ), CompilerException);
+}
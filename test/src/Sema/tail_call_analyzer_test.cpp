@@ -0,0 +1,80 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AST/Decl.h"
+#include "AST/Expr.h"
+#include "AST/Stmt.h"
+
+#include "analyze.h"
+
+// returns the call returned by the last statement of the index-th function
+static FunctionCall& getReturnedCall(CompilationUnit &unit, int index) {
+  FuncDecl &func = getFunction(unit, index);
+  ReturnStmt *ret = dynamic_cast<ReturnStmt*>(func.getBlockStmt().getStmts().back().get());
+  return *dynamic_cast<FunctionCall*>(ret->getExpr());
+}
+
+TEST(TailCallAnalyzer, analyze) {
+  auto unit = analyze(
+    "func fact(n: i64, acc: i64) -> i64 {\n"
+    "  if n <= 1 {\n"
+    "    return acc\n"
+    "  }\n"
+    "  return fact(n - 1, acc * n)\n"
+    "}\n"
+    "func first(s: &[i64]) -> i64 {\n"
+    "  return s[0]\n"
+    "}\n"
+    "func forward(s: &[i64], n: i64) -> i64 {\n"
+    "  return first(s)\n"
+    "}\n"
+    "func local(n: i64) -> i64 {\n"
+    "  var a: [i64, 2] = [n, n]\n"
+    "  return first(&a)\n"
+    "}\n"
+    "func pooled(n: i64, acc: i64) -> i64 {\n"
+    "  @pool {\n"
+    "    return fact(n, acc)\n"
+    "  }\n"
+    "  return fact(n, acc)\n"
+    "}\n"
+    "func counted(n: i64, acc: i64) -> i64 {\n"
+    "  var counts: [i64: i64]\n"
+    "  return fact(n, acc)\n"
+    "}\n"
+  );
+  EXPECT_EQ(getReturnedCall(*unit, 0).getTailCall(), FunctionCall::TailCall::Guaranteed);
+  EXPECT_EQ(getReturnedCall(*unit, 2).getTailCall(), FunctionCall::TailCall::Tail);
+  EXPECT_EQ(getReturnedCall(*unit, 3).getTailCall(), FunctionCall::TailCall::None);
+  EXPECT_EQ(getReturnedCall(*unit, 4).getTailCall(), FunctionCall::TailCall::Guaranteed);
+  EXPECT_EQ(getReturnedCall(*unit, 5).getTailCall(), FunctionCall::TailCall::None);
+}
+
+TEST(TailCallAnalyzer, tailcallAttribute) {
+  EXPECT_NO_THROW(analyze(
+    "@tailcall\n"
+    "func count(n: i64, acc: i64) -> i64 {\n"
+    "  if n == 0 {\n"
+    "    return acc\n"
+    "  }\n"
+    "  return count(n - 1, acc + 1)\n"
+    "}\n"
+  ));
+  EXPECT_ANY_THROW(analyze(
+    "@tailcall\n"
+    "func sum(n: i64) -> i64 {\n"
+    "  if n == 0 {\n"
+    "    return 0\n"
+    "  }\n"
+    "  return n + sum(n - 1)\n"
+    "}\n"
+  ));
+  EXPECT_ANY_THROW(analyze(
+    "@tailcall\n"
+    "func walk(s: &[i64], n: i64) -> i64 {\n"
+    "  var a: [i64, 1] = [n]\n"
+    "  return walk(&a, n)\n"
+    "}\n"
+  ));
+}
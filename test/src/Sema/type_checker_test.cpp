@@ -4,8 +4,10 @@
 
 #include "AST/Type.h"
 #include "AST/Expr.h"
+#include "AST/Decl.h"
 #include "AST/DeclContext.h"
 #include "Sema/TypeChecker.h"
+#include "Sema/BuiltinDecl.h"
 
 TEST(TypeChecker, checkIntegerExpr) {
   Token int_token{Token::integer_literal, {"42"}};
@@ -71,3 +73,316 @@ TEST(TypeChecker, checkStringExpr) {
 
   ASSERT_EQ(string_expr->getType(), expected_type);
 }
+
+TEST(TypeChecker, is_implicitly_assignable_to) {
+  auto decl_context = std::make_unique<DeclContext>();
+  TypeChecker type_checker{decl_context.get()};
+
+  // a slice can only be created from a reference to an array, because the
+  // length of the array is needed to construct the slice
+  auto slice_type = SliceType::getInstance(IntegerType::getInstance());
+  auto array_type = ListType::getInstance(IntegerType::getInstance(), 5);
+  auto double_array_type = ListType::getInstance(DoubleType::getInstance(), 5);
+
+  EXPECT_TRUE(type_checker.is_implicitly_assignable_to(slice_type, slice_type));
+  EXPECT_TRUE(type_checker.is_implicitly_assignable_to(slice_type, ReferenceType::getInstance(array_type)));
+  EXPECT_FALSE(type_checker.is_implicitly_assignable_to(slice_type, ReferenceType::getInstance(double_array_type)));
+  EXPECT_FALSE(type_checker.is_implicitly_assignable_to(slice_type, ReferenceType::getInstance(IntegerType::getInstance())));
+  EXPECT_FALSE(type_checker.is_implicitly_assignable_to(slice_type, array_type));
+}
+
+TEST(TypeChecker, checkAssignmentExpr) {
+  auto decl_context = std::make_unique<DeclContext>();
+  TypeChecker type_checker{decl_context.get()};
+
+  auto integer_type = IntegerType::getInstance();
+  Token one_token{Token::integer_literal, {"1"}};
+  Token assign_token{Token::operator_id, {"="}};
+
+  auto let_decl = std::make_unique<LetDecl>(Token{Token::identifier, {"a"}}, integer_type, std::make_unique<IntegerExpr>(one_token));
+  auto var_decl = std::make_unique<VarDecl>(Token{Token::identifier, {"b"}}, integer_type, std::make_unique<IntegerExpr>(one_token));
+
+  auto assign_to = [&](const Decl* decl) {
+    auto id_expr = std::make_unique<IdentifierExpr>(Token{Token::identifier, {"x"}});
+    id_expr->setDecl(decl);
+    id_expr->setType(integer_type);
+    auto value = std::make_unique<IntegerExpr>(one_token);
+    value->setType(integer_type);
+    return std::make_unique<BinaryExpr>(std::move(id_expr), assign_token, std::move(value));
+  };
+
+  // let bindings are immutable, var bindings may be reassigned
+  auto assign_let = assign_to(let_decl.get());
+  EXPECT_ANY_THROW(type_checker.checkAssignmentExpr(*assign_let));
+  auto assign_var = assign_to(var_decl.get());
+  EXPECT_NO_THROW(type_checker.checkAssignmentExpr(*assign_var));
+}
+
+TEST(TypeChecker, checkReferenceExpr) {
+  auto decl_context = std::make_unique<DeclContext>();
+  TypeChecker type_checker{decl_context.get()};
+
+  auto integer_type = IntegerType::getInstance();
+  Token one_token{Token::integer_literal, {"1"}};
+  Token reference_token{Token::operator_id, {"&"}};
+
+  auto referenced = std::make_unique<LetDecl>(Token{Token::identifier, {"a"}}, integer_type, std::make_unique<IntegerExpr>(one_token));
+  auto unreferenced = std::make_unique<LetDecl>(Token{Token::identifier, {"b"}}, integer_type, std::make_unique<IntegerExpr>(one_token));
+  decl_context->addDecl(referenced.get());
+  decl_context->addDecl(unreferenced.get());
+
+  // a let binding whose location is taken needs storage of its own
+  auto reference = std::make_unique<UnaryExpr>(reference_token, std::make_unique<IdentifierExpr>(Token{Token::identifier, {"a"}}));
+  type_checker.checkReferenceExpr(*reference);
+  EXPECT_TRUE(referenced->isReferenced());
+  EXPECT_FALSE(unreferenced->isReferenced());
+}
+
+TEST(TypeChecker, convertLiteral) {
+  auto decl_context = std::make_unique<DeclContext>();
+  TypeChecker type_checker{decl_context.get()};
+
+  auto literal = [&](const char *value) {
+    auto int_expr = std::make_unique<IntegerExpr>(Token{Token::integer_literal, {value}});
+    type_checker.checkIntegerExpr(*int_expr);
+    return int_expr;
+  };
+  auto u8_type = IntegerType::getInstance(8, false);
+
+  // literals take the type they are used as if their value fits
+  auto fits = literal("255");
+  EXPECT_TRUE(type_checker.convertLiteral(*fits, u8_type));
+  EXPECT_EQ(fits->getType(), u8_type);
+
+  auto too_large = literal("256");
+  EXPECT_ANY_THROW(type_checker.convertLiteral(*too_large, u8_type));
+
+  // a literal is not converted to a type of another kind
+  auto not_double = literal("1");
+  EXPECT_FALSE(type_checker.convertLiteral(*not_double, DoubleType::getInstance(32)));
+  EXPECT_EQ(not_double->getType(), IntegerType::getInstance());
+}
+
+TEST(TypeChecker, checkConversionCall) {
+  // the body of `func get(x: i64) -> i8 { var i: i8 = 0 ... }`
+  auto function_context = std::make_unique<DeclContext>();
+  auto block_context = std::make_unique<DeclContext>();
+  block_context->setParentContext(function_context.get());
+  TypeChecker type_checker{block_context.get()};
+
+  auto i8_type = IntegerType::getInstance(8, true);
+  auto param = std::make_unique<ParamDecl>(Token{Token::identifier, {"x"}}, IntegerType::getInstance());
+  function_context->addDecl(param.get());
+  // names refer into the source, so `i` is followed by the rest of its line
+  const char *source = "i: i8 = 0";
+  auto local = std::make_unique<VarDecl>(Token{Token::identifier, {source, 1}}, i8_type, std::make_unique<IntegerExpr>(Token{Token::integer_literal, {"0"}}));
+  block_context->addDecl(local.get());
+
+  // a local whose name is a prefix of the type does not shadow the conversion
+  std::vector<std::unique_ptr<Expr>> args;
+  args.push_back(std::make_unique<IdentifierExpr>(Token{Token::identifier, {"x"}}));
+  FunctionCall conversion{std::make_unique<IdentifierExpr>(Token{Token::identifier, {"i8"}}), std::move(args)};
+  EXPECT_NO_THROW(type_checker.checkFunctionCall(conversion));
+  EXPECT_EQ(conversion.getType(), i8_type);
+}
+
+TEST(TypeChecker, checkCompoundAssignmentExpr) {
+  auto decl_context = std::make_unique<DeclContext>();
+  BuiltinDecl::addBitwiseOperators(decl_context.get());
+  TypeChecker type_checker{decl_context.get()};
+
+  auto u32_type = IntegerType::getInstance(32, false);
+  auto var_decl = std::make_unique<VarDecl>(Token{Token::identifier, {"a"}}, u32_type, nullptr);
+
+  auto assign = [&](const char *op, Type *value_type) {
+    auto id_expr = std::make_unique<IdentifierExpr>(Token{Token::identifier, {"a"}});
+    id_expr->setDecl(var_decl.get());
+    id_expr->setType(u32_type);
+    auto value = std::make_unique<IdentifierExpr>(Token{Token::identifier, {"b"}});
+    value->setType(value_type);
+    return std::make_unique<BinaryExpr>(std::move(id_expr), Token{Token::operator_id, {op}}, std::move(value));
+  };
+
+  // the operator of a compound assignment must be defined for the operands
+  auto shift = assign("<<=", u32_type);
+  EXPECT_NO_THROW(type_checker.checkAssignmentExpr(*shift));
+  EXPECT_EQ(shift->getType(), u32_type);
+
+  auto mixed = assign("^=", IntegerType::getInstance());
+  EXPECT_ANY_THROW(type_checker.checkAssignmentExpr(*mixed));
+
+  auto bitwise_double = assign("&=", DoubleType::getInstance());
+  EXPECT_ANY_THROW(type_checker.checkAssignmentExpr(*bitwise_double));
+}
+
+TEST(TypeChecker, checkIntrinsicCall) {
+  auto decl_context = std::make_unique<DeclContext>();
+  BuiltinDecl::addIntrinsics(decl_context.get());
+  TypeChecker type_checker{decl_context.get()};
+
+  auto argument = [](Type *type) {
+    auto id_expr = std::make_unique<IdentifierExpr>(Token{Token::identifier, {"x"}});
+    id_expr->setType(type);
+    return id_expr;
+  };
+  auto literal = [&](const char *value) {
+    auto int_expr = std::make_unique<IntegerExpr>(Token{Token::integer_literal, {value}});
+    type_checker.checkIntegerExpr(*int_expr);
+    return int_expr;
+  };
+  auto call = [](const char *name, std::vector<std::unique_ptr<Expr>> args) {
+    auto callee = std::make_unique<IdentifierExpr>(Token{Token::identifier, {name}});
+    return std::make_unique<FunctionCall>(std::move(callee), std::move(args));
+  };
+  auto u32_type = IntegerType::getInstance(32, false);
+  auto u8_type = IntegerType::getInstance(8, false);
+
+  std::vector<std::unique_ptr<Expr>> popcount_args;
+  popcount_args.push_back(argument(u32_type));
+  auto popcount = call("popcount", std::move(popcount_args));
+  type_checker.checkIntrinsicCall(*popcount);
+  EXPECT_EQ(popcount->getType(), u32_type);
+
+  // literal arguments take the type of the other arguments
+  std::vector<std::unique_ptr<Expr>> min_args;
+  min_args.push_back(argument(u8_type));
+  min_args.push_back(literal("1"));
+  auto min = call("min", std::move(min_args));
+  type_checker.checkIntrinsicCall(*min);
+  EXPECT_EQ(min->getType(), u8_type);
+
+  std::vector<std::unique_ptr<Expr>> bswap_args;
+  bswap_args.push_back(argument(u8_type));
+  auto bswap = call("bswap", std::move(bswap_args));
+  EXPECT_ANY_THROW(type_checker.checkIntrinsicCall(*bswap));
+
+  // intrinsics apply to each lane of a vector
+  auto vector_type = VectorType::getInstance(DoubleType::getInstance(32), 4);
+  std::vector<std::unique_ptr<Expr>> sqrt_args;
+  sqrt_args.push_back(argument(vector_type));
+  auto sqrt = call("sqrt", std::move(sqrt_args));
+  type_checker.checkIntrinsicCall(*sqrt);
+  EXPECT_EQ(sqrt->getType(), vector_type);
+
+  std::vector<std::unique_ptr<Expr>> likely_args;
+  likely_args.push_back(argument(BooleanType::getInstance()));
+  auto likely = call("likely", std::move(likely_args));
+  type_checker.checkIntrinsicCall(*likely);
+  EXPECT_EQ(likely->getType(), BooleanType::getInstance());
+
+  std::vector<std::unique_ptr<Expr>> unlikely_args;
+  unlikely_args.push_back(argument(u8_type));
+  auto unlikely = call("unlikely", std::move(unlikely_args));
+  EXPECT_ANY_THROW(type_checker.checkIntrinsicCall(*unlikely));
+}
+
+TEST(TypeChecker, checkLogicalExpr) {
+  auto decl_context = std::make_unique<DeclContext>();
+  BuiltinDecl::addLogicalOperators(decl_context.get());
+  TypeChecker type_checker{decl_context.get()};
+
+  auto boolean = [](bool value) {
+    return std::make_unique<BoolExpr>(
+      value ? Token{Token::kw_true, {"true"}} : Token{Token::kw_false, {"false"}}
+    );
+  };
+  BinaryExpr and_expr{boolean(true), Token{Token::operator_id, {"&&"}}, boolean(false)};
+  type_checker.checkBinaryExpr(and_expr);
+  EXPECT_EQ(and_expr.getType(), BooleanType::getInstance());
+
+  auto int_expr = std::make_unique<IntegerExpr>(Token{Token::integer_literal, {"1"}});
+  BinaryExpr or_expr{boolean(true), Token{Token::operator_id, {"||"}}, std::move(int_expr)};
+  EXPECT_ANY_THROW(type_checker.checkBinaryExpr(or_expr));
+}
+
+TEST(TypeChecker, checkMapBuiltin) {
+  auto decl_context = std::make_unique<DeclContext>();
+  TypeChecker type_checker{decl_context.get()};
+
+  auto argument = [](Type *type) {
+    auto id_expr = std::make_unique<IdentifierExpr>(Token{Token::identifier, {"x"}});
+    id_expr->setType(type);
+    return id_expr;
+  };
+  auto literal = [&](const char *value) {
+    auto int_expr = std::make_unique<IntegerExpr>(Token{Token::integer_literal, {value}});
+    type_checker.checkIntegerExpr(*int_expr);
+    return int_expr;
+  };
+  auto call = [](const char *name, std::vector<std::unique_ptr<Expr>> args) {
+    auto callee = std::make_unique<IdentifierExpr>(Token{Token::identifier, {name}});
+    return std::make_unique<FunctionCall>(std::move(callee), std::move(args));
+  };
+  auto u32_type = IntegerType::getInstance(32, false);
+  auto f64_type = DoubleType::getInstance();
+  auto map_type = MapType::getInstance(u32_type, f64_type);
+
+  // literal keys and values take the types of the map
+  std::vector<std::unique_ptr<Expr>> insert_args;
+  insert_args.push_back(argument(map_type));
+  insert_args.push_back(literal("7"));
+  insert_args.push_back(argument(f64_type));
+  auto insert = call("insert", std::move(insert_args));
+  type_checker.checkMapBuiltin(*insert);
+  EXPECT_EQ(insert->getType(), TupleType::getInstance({}));
+  EXPECT_EQ(insert->getArguments()[1]->getType(), u32_type);
+
+  std::vector<std::unique_ptr<Expr>> find_args;
+  find_args.push_back(argument(map_type));
+  find_args.push_back(argument(u32_type));
+  auto find = call("find", std::move(find_args));
+  type_checker.checkMapBuiltin(*find);
+  EXPECT_EQ(find->getType(), f64_type);
+
+  std::vector<std::unique_ptr<Expr>> erase_args;
+  erase_args.push_back(argument(map_type));
+  erase_args.push_back(argument(f64_type));
+  auto erase = call("erase", std::move(erase_args));
+  EXPECT_ANY_THROW(type_checker.checkMapBuiltin(*erase));
+
+  std::vector<std::unique_ptr<Expr>> not_a_map_args;
+  not_a_map_args.push_back(argument(u32_type));
+  not_a_map_args.push_back(argument(u32_type));
+  auto not_a_map = call("find", std::move(not_a_map_args));
+  EXPECT_ANY_THROW(type_checker.checkMapBuiltin(*not_a_map));
+}
+
+TEST(TypeChecker, checkAllocationBuiltin) {
+  auto decl_context = std::make_unique<DeclContext>();
+  TypeChecker type_checker{decl_context.get()};
+
+  auto argument = [](Type *type) {
+    auto id_expr = std::make_unique<IdentifierExpr>(Token{Token::identifier, {"x"}});
+    id_expr->setType(type);
+    return id_expr;
+  };
+  auto call = [](const char *name, std::vector<std::unique_ptr<Expr>> args) {
+    auto callee = std::make_unique<IdentifierExpr>(Token{Token::identifier, {name}});
+    return std::make_unique<FunctionCall>(std::move(callee), std::move(args));
+  };
+  auto u8_type = IntegerType::getInstance(8, false);
+
+  std::vector<std::unique_ptr<Expr>> new_args;
+  new_args.push_back(argument(u8_type));
+  auto new_call = call("new", std::move(new_args));
+  type_checker.checkAllocationBuiltin(*new_call);
+  EXPECT_EQ(new_call->getType(), ReferenceType::getInstance(u8_type));
+
+  std::vector<std::unique_ptr<Expr>> alloc_args;
+  alloc_args.push_back(argument(u8_type));
+  alloc_args.push_back(argument(IntegerType::getInstance(32, true)));
+  auto alloc = call("alloc", std::move(alloc_args));
+  type_checker.checkAllocationBuiltin(*alloc);
+  EXPECT_EQ(alloc->getType(), SliceType::getInstance(u8_type));
+
+  std::vector<std::unique_ptr<Expr>> free_args;
+  free_args.push_back(argument(SliceType::getInstance(u8_type)));
+  auto free_call = call("free", std::move(free_args));
+  type_checker.checkAllocationBuiltin(*free_call);
+  EXPECT_EQ(free_call->getType(), TupleType::getInstance({}));
+
+  std::vector<std::unique_ptr<Expr>> free_value_args;
+  free_value_args.push_back(argument(u8_type));
+  auto free_value = call("free", std::move(free_value_args));
+  EXPECT_ANY_THROW(type_checker.checkAllocationBuiltin(*free_value));
+}